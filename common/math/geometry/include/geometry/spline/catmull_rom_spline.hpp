@@ -66,12 +66,23 @@ private:
     const -> std::vector<geometry_msgs::msg::Point>;
   auto getSInSplineCurve(const size_t curve_index, const double s) const -> double;
   auto getCurveIndexAndS(const double s) const -> std::pair<size_t, double>;
+  auto get2DBoundingBox(const std::vector<geometry_msgs::msg::Point> & points) const
+    -> std::pair<geometry_msgs::msg::Point, geometry_msgs::msg::Point>;
+  auto overlapsWithCurveIn2D(
+    const size_t curve_index,
+    const std::pair<geometry_msgs::msg::Point, geometry_msgs::msg::Point> & bounding_box) const
+    -> bool;
   auto checkConnection() const -> bool;
   auto equals(const geometry_msgs::msg::Point & p0, const geometry_msgs::msg::Point & p1) const
     -> bool;
   std::vector<LineSegment> line_segments_;
   std::vector<HermiteCurve> curves_;
   std::vector<double> length_list_;
+  /// @note accumulated_lengths_[i] is the s value at the start point of curves_[i], it has
+  /// curves_.size() + 1 elements.
+  std::vector<double> accumulated_lengths_;
+  std::vector<std::pair<geometry_msgs::msg::Point, geometry_msgs::msg::Point>>
+    curve_bounding_boxes_;
   std::vector<double> maximum_2d_curvatures_;
   double total_length_;
 };
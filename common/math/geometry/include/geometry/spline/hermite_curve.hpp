@@ -23,6 +23,7 @@
 #include <geometry_msgs/msg/pose.hpp>
 #include <geometry_msgs/msg/vector3.hpp>
 #include <optional>
+#include <utility>
 #include <vector>
 
 namespace math
@@ -54,6 +55,7 @@ public:
   const geometry_msgs::msg::Vector3 getNormalVector(double s, bool denormalize_s = false) const;
   double get2DCurvature(double s, bool denormalize_s = false) const;
   double getMaximum2DCurvature() const;
+  std::pair<geometry_msgs::msg::Point, geometry_msgs::msg::Point> get2DBoundingBox() const;
   double getLength(size_t num_points) const;
   double getLength() const { return length_; }
   std::optional<double> getSValue(
@@ -12,8 +12,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <geometry/linear_algebra.hpp>
 #include <geometry/spline/catmull_rom_spline.hpp>
+#include <geometry/transform.hpp>
 #include <iostream>
 #include <limits>
 #include <optional>
@@ -233,10 +235,13 @@ CatmullRomSpline::CatmullRomSpline(const std::vector<geometry_msgs::msg::Point>
         for (const auto & curve : curves_) {
           length_list_.emplace_back(curve.getLength());
           maximum_2d_curvatures_.emplace_back(curve.getMaximum2DCurvature());
+          curve_bounding_boxes_.emplace_back(curve.get2DBoundingBox());
         }
         total_length_ = 0;
+        accumulated_lengths_.emplace_back(total_length_);
         for (const auto & length : length_list_) {
           total_length_ = total_length_ + length;
+          accumulated_lengths_.emplace_back(total_length_);
         }
         checkConnection();
       }(control_points);
@@ -253,31 +258,57 @@ auto CatmullRomSpline::getCurveIndexAndS(const double s) const -> std::pair<size
     return std::make_pair(
       curves_.size() - 1, s - (total_length_ - curves_[curves_.size() - 1].getLength()));
   }
-  double current_s = 0;
-  for (size_t i = 0; i < curves_.size(); i++) {
-    double prev_s = current_s;
-    current_s = current_s + length_list_[i];
-    if (prev_s <= s && s < current_s) {
-      return std::make_pair(i, s - prev_s);
-    }
+  /// @note Find the last curve which starts at or before s, curves with zero length are skipped.
+  if (const auto itr =
+        std::upper_bound(accumulated_lengths_.begin(), accumulated_lengths_.end(), s);
+      itr != accumulated_lengths_.begin() && itr != accumulated_lengths_.end()) {
+    const auto index = static_cast<size_t>(std::distance(accumulated_lengths_.begin(), itr) - 1);
+    return std::make_pair(index, s - accumulated_lengths_[index]);
   }
   THROW_SIMULATION_ERROR("failed to calculate curve index");  // LCOV_EXCL_LINE
 }
 
 auto CatmullRomSpline::getSInSplineCurve(const size_t curve_index, const double s) const -> double
 {
-  size_t n = curves_.size();
-  double ret = 0;
-  for (size_t i = 0; i < n; i++) {
-    if (i == curve_index) {
-      return ret + s;
-    } else {
-      ret = ret + curves_[i].getLength();
-    }
+  if (curve_index < curves_.size()) {
+    return accumulated_lengths_[curve_index] + s;
   }
   THROW_SEMANTIC_ERROR("curve index does not match");  // LCOV_EXCL_LINE
 }
 
+auto CatmullRomSpline::get2DBoundingBox(const std::vector<geometry_msgs::msg::Point> & points) const
+  -> std::pair<geometry_msgs::msg::Point, geometry_msgs::msg::Point>
+{
+  /// @note Margin for the rounding error of the curve bounding boxes, same tolerance as equals().
+  constexpr double margin = std::numeric_limits<float>::epsilon();
+  geometry_msgs::msg::Point min_point, max_point;
+  min_point.x = min_point.y = std::numeric_limits<double>::max();
+  max_point.x = max_point.y = std::numeric_limits<double>::lowest();
+  for (const auto & point : points) {
+    min_point.x = std::min(min_point.x, point.x - margin);
+    min_point.y = std::min(min_point.y, point.y - margin);
+    max_point.x = std::max(max_point.x, point.x + margin);
+    max_point.y = std::max(max_point.y, point.y + margin);
+  }
+  return std::make_pair(min_point, max_point);
+}
+
+/**
+ * @brief Check the bounding box of the curve overlaps with the given bounding box.
+ * If this function returns false, the curve never collides with the geometry inside the bounding
+ * box, so the expensive intersection calculation of the curve can be skipped.
+ */
+auto CatmullRomSpline::overlapsWithCurveIn2D(
+  const size_t curve_index,
+  const std::pair<geometry_msgs::msg::Point, geometry_msgs::msg::Point> & bounding_box) const
+  -> bool
+{
+  const auto & [curve_min, curve_max] = curve_bounding_boxes_[curve_index];
+  const auto & [min_point, max_point] = bounding_box;
+  return curve_min.x <= max_point.x && min_point.x <= curve_max.x && curve_min.y <= max_point.y &&
+         min_point.y <= curve_max.y;
+}
+
 /**
  * @brief Get collision point in 2D (x and y)
  * @param polygon points of polygons.
@@ -299,8 +330,12 @@ auto CatmullRomSpline::getCollisionPointIn2D(
   const auto get_collision_point_2d_with_curve =
     [this](const auto & polygon, const auto search_backward) -> std::optional<double> {
     size_t n = curves_.size();
+    const auto bounding_box = get2DBoundingBox(polygon);
     if (search_backward) {
       for (size_t i = 0; i < n; i++) {
+        if (!overlapsWithCurveIn2D(n - 1 - i, bounding_box)) {
+          continue;
+        }
         auto s = curves_[n - 1 - i].getCollisionPointIn2D(polygon, search_backward);
         if (s) {
           return getSInSplineCurve(n - 1 - i, s.value());
@@ -309,6 +344,9 @@ auto CatmullRomSpline::getCollisionPointIn2D(
       return std::optional<double>();
     } else {
       for (size_t i = 0; i < n; i++) {
+        if (!overlapsWithCurveIn2D(i, bounding_box)) {
+          continue;
+        }
         auto s = curves_[i].getCollisionPointIn2D(polygon, search_backward);
         if (s) {
           return std::optional<double>(getSInSplineCurve(i, s.value()));
@@ -378,8 +416,12 @@ auto CatmullRomSpline::getCollisionPointIn2D(
   const bool search_backward) const -> std::optional<double>
 {
   size_t n = curves_.size();
+  const auto bounding_box = get2DBoundingBox({point0, point1});
   if (search_backward) {
     for (size_t i = 0; i < n; i++) {
+      if (!overlapsWithCurveIn2D(n - 1 - i, bounding_box)) {
+        continue;
+      }
       auto s = curves_[n - 1 - i].getCollisionPointIn2D(point0, point1, search_backward);
       if (s) {
         return getSInSplineCurve(n - 1 - i, s.value());
@@ -388,6 +430,9 @@ auto CatmullRomSpline::getCollisionPointIn2D(
     return std::nullopt;
   } else {
     for (size_t i = 0; i < n; i++) {
+      if (!overlapsWithCurveIn2D(i, bounding_box)) {
+        continue;
+      }
       auto s = curves_[i].getCollisionPointIn2D(point0, point1, search_backward);
       if (s) {
         return getSInSplineCurve(i, s.value());
@@ -428,14 +473,19 @@ auto CatmullRomSpline::getSValue(
       }
       return line_segments_[0].getSValue(pose, threshold_distance, true);
     default:
-      double s = 0;
+      /// @note Same perpendicular line as HermiteCurve::getSValue, only curves near the line are
+      /// tested.
+      geometry_msgs::msg::Point p0, p1;
+      p0.y = threshold_distance;
+      p1.y = -threshold_distance;
+      const auto bounding_box = get2DBoundingBox(math::geometry::transformPoints(pose, {p0, p1}));
       for (size_t i = 0; i < curves_.size(); i++) {
-        auto s_value = curves_[i].getSValue(pose, threshold_distance, true);
-        if (s_value) {
-          s = s + s_value.value();
-          return s;
+        if (!overlapsWithCurveIn2D(i, bounding_box)) {
+          continue;
+        }
+        if (auto s_value = curves_[i].getSValue(pose, threshold_distance, true)) {
+          return accumulated_lengths_[i] + s_value.value();
         }
-        s = s + curves_[i].getLength();
       }
       return std::nullopt;
   }
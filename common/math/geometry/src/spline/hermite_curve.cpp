@@ -309,6 +309,42 @@ double HermiteCurve::getMaximum2DCurvature() const
   return values.second;
 }
 
+/**
+ * @brief get axis aligned bounding box of the hermite curve in s = [0, 1].
+ * Extrema of each axis are at the start/end points or at the roots of the derivative.
+ * @return std::pair<geometry_msgs::msg::Point, geometry_msgs::msg::Point> minimum and maximum
+ * corners of the box.
+ */
+std::pair<geometry_msgs::msg::Point, geometry_msgs::msg::Point>
+HermiteCurve::get2DBoundingBox() const
+{
+  const auto get_range = [this](double a, double b, double c, double d) {
+    std::vector<double> values = {solver_.cubic(a, b, c, d, 0), solver_.cubic(a, b, c, d, 1)};
+    try {
+      for (const auto s : solver_.solveQuadraticEquation(3 * a, 2 * b, c, 0, 1)) {
+        values.push_back(solver_.cubic(a, b, c, d, s));
+      }
+    }
+    /**
+     * @note PolynomialSolver throws common::SimulationError when the derivative is zero for any s,
+     * so the curve is constant along this axis and the start/end points are enough.
+     */
+    catch (const common::SimulationError &) {
+    }
+    return std::make_pair(
+      *std::min_element(values.begin(), values.end()),
+      *std::max_element(values.begin(), values.end()));
+  };
+  const auto x_range = get_range(ax_, bx_, cx_, dx_);
+  const auto y_range = get_range(ay_, by_, cy_, dy_);
+  geometry_msgs::msg::Point min_point, max_point;
+  min_point.x = x_range.first;
+  min_point.y = y_range.first;
+  max_point.x = x_range.second;
+  max_point.y = y_range.second;
+  return std::make_pair(min_point, max_point);
+}
+
 /**
  * @brief get length of the hermite curve. Calculate distance of two points on hermite curve and accumulate it's distance
  * @param num_points
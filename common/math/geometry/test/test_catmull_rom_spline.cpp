@@ -265,6 +265,32 @@ TEST(CatmullRomSpline, GetSValue)
   EXPECT_FALSE(spline.getSValue(p, 3));
 }
 
+TEST(CatmullRomSpline, GetSValueAlongCurve)
+{
+  geometry_msgs::msg::Point p0;
+  geometry_msgs::msg::Point p1;
+  p1.x = 1;
+  p1.y = 3;
+  geometry_msgs::msg::Point p2;
+  p2.x = 2;
+  p2.y = 5;
+  geometry_msgs::msg::Point p3;
+  p3.x = 4;
+  p3.y = 6;
+  geometry_msgs::msg::Point p4;
+  p4.x = 4;
+  p4.y = 10;
+  auto points = {p0, p1, p2, p3, p4};
+  auto spline = math::geometry::CatmullRomSpline(points);
+  for (double s = 0.05; s < spline.getLength(); s = s + 0.5) {
+    const auto result = spline.getSValue(spline.getPose(s), 1.0);
+    EXPECT_TRUE(result);
+    if (result) {
+      EXPECT_NEAR(result.value(), s, 0.05);
+    }
+  }
+}
+
 TEST(CatmullRomSpline, GetSValue2)
 {
   geometry_msgs::msg::Point p0;
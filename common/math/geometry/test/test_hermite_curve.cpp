@@ -76,6 +76,24 @@ TEST(HermiteCurveTest, CheckCollisionToLine)
   }
 }
 
+TEST(HermiteCurveTest, Get2DBoundingBox)
+{
+  geometry_msgs::msg::Pose start_pose, goal_pose;
+  geometry_msgs::msg::Vector3 start_vec, goal_vec;
+  goal_pose.position.x = 1;
+  start_vec.x = 1;
+  start_vec.y = 1;
+  goal_vec.x = 1;
+  goal_vec.y = -1;
+  /// @note x(s) = s, y(s) = -s^2 + s, so the maximum value of y is 0.25 at s = 0.5.
+  math::geometry::HermiteCurve curve(start_pose, goal_pose, start_vec, goal_vec);
+  const auto [min_point, max_point] = curve.get2DBoundingBox();
+  EXPECT_DOUBLE_EQ(min_point.x, 0);
+  EXPECT_DOUBLE_EQ(min_point.y, 0);
+  EXPECT_DOUBLE_EQ(max_point.x, 1);
+  EXPECT_DOUBLE_EQ(max_point.y, 0.25);
+}
+
 TEST(HermiteCurveTest, getNewtonMethodStepSize) {}
 
 TEST(HermiteCurveTest, CheckNormalVector)
@@ -54,6 +54,9 @@ public:
   auto getDistanceToStopLine(
     const lanelet::Ids & route_lanelets,
     const std::vector<geometry_msgs::msg::Point> & waypoints) const -> std::optional<double>;
+  auto getDistanceToStopLine(
+    const lanelet::Ids & route_lanelets,
+    const math::geometry::CatmullRomSplineInterface & spline) const -> std::optional<double>;
   auto getDistanceToTrafficLightStopLine(
     const lanelet::Ids & route_lanelets,
     const math::geometry::CatmullRomSplineInterface & spline) const -> std::optional<double>;
@@ -137,6 +140,11 @@ private:
     -> std::vector<traffic_simulator::CanonicalizedEntityStatus>;
   auto getConflictingEntityStatusOnLane(const lanelet::Ids & route_lanelets) const
     -> std::vector<traffic_simulator::CanonicalizedEntityStatus>;
+  auto isConflictingCrosswalk(const lanelet::Ids & route_lanelets, lanelet::Id) const -> bool;
+  auto isConflictingLane(const lanelet::Ids & route_lanelets, lanelet::Id) const -> bool;
+  /// @note Whether the entity is matched to one of the route lanelets, where the stop line index
+  /// can be searched from.
+  auto isOnRoute(const lanelet::Ids & route_lanelets) const -> bool;
 };
 }  // namespace entity_behavior
 
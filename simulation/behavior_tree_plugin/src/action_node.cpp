@@ -183,6 +183,14 @@ auto ActionNode::getRightOfWayEntities() const
   return ret;
 }
 
+auto ActionNode::isOnRoute(const lanelet::Ids & route_lanelets) const -> bool
+{
+  return entity_status->laneMatchingSucceed() and
+         std::find(
+           route_lanelets.begin(), route_lanelets.end(),
+           entity_status->getLaneletPose().lanelet_id) != route_lanelets.end();
+}
+
 auto ActionNode::getDistanceToTrafficLightStopLine(
   const lanelet::Ids & route_lanelets,
   const math::geometry::CatmullRomSplineInterface & spline) const -> std::optional<double>
@@ -199,7 +207,12 @@ auto ActionNode::getDistanceToTrafficLightStopLine(
     if (auto && traffic_light = traffic_light_manager->getTrafficLight(id);
         traffic_light.contains(Color::red, Status::solid_on, Shape::circle) or
         traffic_light.contains(Color::yellow, Status::solid_on, Shape::circle)) {
-      const auto collision_point = hdmap_utils->getDistanceToTrafficLightStopLine(spline, id);
+      /// @note The spline starts at the lanelet pose of the entity when its lane matching succeeds.
+      const auto collision_point =
+        isOnRoute(route_lanelets)
+          ? hdmap_utils->getDistanceToTrafficLightStopLine(
+              route_lanelets, entity_status->getLaneletPose(), spline.getLength(), id)
+          : hdmap_utils->getDistanceToTrafficLightStopLine(spline, id);
       if (collision_point) {
         collision_points.insert(collision_point.value());
       }
@@ -218,6 +231,18 @@ auto ActionNode::getDistanceToStopLine(
   return hdmap_utils->getDistanceToStopLine(route_lanelets, waypoints);
 }
 
+auto ActionNode::getDistanceToStopLine(
+  const lanelet::Ids & route_lanelets,
+  const math::geometry::CatmullRomSplineInterface & spline) const -> std::optional<double>
+{
+  /// @note The spline starts at the lanelet pose of the entity when its lane matching succeeds.
+  if (isOnRoute(route_lanelets)) {
+    return hdmap_utils->getDistanceToStopLine(
+      route_lanelets, entity_status->getLaneletPose(), spline.getLength());
+  }
+  return hdmap_utils->getDistanceToStopLine(route_lanelets, spline);
+}
+
 auto ActionNode::getDistanceToFrontEntity(
   const math::geometry::CatmullRomSplineInterface & spline) const -> std::optional<double>
 {
@@ -340,13 +365,10 @@ auto ActionNode::getConflictingEntityStatusOnCrossWalk(const lanelet::Ids & rout
   -> std::vector<traffic_simulator::CanonicalizedEntityStatus>
 {
   std::vector<traffic_simulator::CanonicalizedEntityStatus> conflicting_entity_status;
-  auto conflicting_crosswalks = hdmap_utils->getConflictingCrosswalkIds(route_lanelets);
   for (const auto & status : other_entity_status) {
     if (
       status.second.laneMatchingSucceed() &&
-      std::count(
-        conflicting_crosswalks.begin(), conflicting_crosswalks.end(),
-        status.second.getLaneletPose().lanelet_id) >= 1) {
+      isConflictingCrosswalk(route_lanelets, status.second.getLaneletPose().lanelet_id)) {
       conflicting_entity_status.emplace_back(status.second);
     }
   }
@@ -357,12 +379,10 @@ auto ActionNode::getConflictingEntityStatusOnLane(const lanelet::Ids & route_lan
   -> std::vector<traffic_simulator::CanonicalizedEntityStatus>
 {
   std::vector<traffic_simulator::CanonicalizedEntityStatus> conflicting_entity_status;
-  auto conflicting_lanes = hdmap_utils->getConflictingLaneIds(route_lanelets);
   for (const auto & status : other_entity_status) {
     if (
-      status.second.laneMatchingSucceed() && std::count(
-                                               conflicting_lanes.begin(), conflicting_lanes.end(),
-                                               status.second.getLaneletPose().lanelet_id) >= 1) {
+      status.second.laneMatchingSucceed() &&
+      isConflictingLane(route_lanelets, status.second.getLaneletPose().lanelet_id)) {
       conflicting_entity_status.emplace_back(status.second);
     }
   }
@@ -371,26 +391,35 @@ auto ActionNode::getConflictingEntityStatusOnLane(const lanelet::Ids & route_lan
 
 auto ActionNode::foundConflictingEntity(const lanelet::Ids & following_lanelets) const -> bool
 {
-  auto conflicting_crosswalks = hdmap_utils->getConflictingCrosswalkIds(following_lanelets);
-  auto conflicting_lanes = hdmap_utils->getConflictingLaneIds(following_lanelets);
   for (const auto & status : other_entity_status) {
     if (
       status.second.laneMatchingSucceed() &&
-      std::count(
-        conflicting_crosswalks.begin(), conflicting_crosswalks.end(),
-        status.second.getLaneletPose().lanelet_id) >= 1) {
-      return true;
-    }
-    if (
-      status.second.laneMatchingSucceed() && std::count(
-                                               conflicting_lanes.begin(), conflicting_lanes.end(),
-                                               status.second.getLaneletPose().lanelet_id) >= 1) {
+      (isConflictingCrosswalk(following_lanelets, status.second.getLaneletPose().lanelet_id) ||
+       isConflictingLane(following_lanelets, status.second.getLaneletPose().lanelet_id))) {
       return true;
     }
   }
   return false;
 }
 
+auto ActionNode::isConflictingCrosswalk(const lanelet::Ids & route_lanelets, lanelet::Id lanelet_id)
+  const -> bool
+{
+  return std::any_of(route_lanelets.begin(), route_lanelets.end(), [&](const auto route_lanelet) {
+    const auto ids = hdmap_utils->getConflictingCrosswalkIds(route_lanelet);
+    return std::find(ids.begin(), ids.end(), lanelet_id) != ids.end();
+  });
+}
+
+auto ActionNode::isConflictingLane(const lanelet::Ids & route_lanelets, lanelet::Id lanelet_id)
+  const -> bool
+{
+  return std::any_of(route_lanelets.begin(), route_lanelets.end(), [&](const auto route_lanelet) {
+    const auto ids = hdmap_utils->getConflictingLaneIds(route_lanelet);
+    return std::find(ids.begin(), ids.end(), lanelet_id) != ids.end();
+  });
+}
+
 auto ActionNode::calculateUpdatedEntityStatus(
   double target_speed, const traffic_simulator_msgs::msg::DynamicConstraints & constraints) const
   -> traffic_simulator::CanonicalizedEntityStatus
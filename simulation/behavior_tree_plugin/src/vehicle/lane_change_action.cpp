@@ -121,8 +121,7 @@ BT::NodeStatus LaneChangeAction::tick()
           1.0 is a forward_distance_threshold (If the goal x position in the cartesian coordinate was under 1.0, the goal was rejected.)
           */
           traj_with_goal = hdmap_utils->getLaneChangeTrajectory(
-            hdmap_utils->toMapPose(lanelet_pose).pose, lane_change_parameters_.value(), 10.0, 20.0,
-            1.0);
+            lanelet_pose, lane_change_parameters_.value(), 10.0, 20.0, 1.0);
           along_pose = hdmap_utils->getAlongLaneletPose(
             lanelet_pose, traffic_simulator::lane_change::Parameter::default_lanechange_distance);
           break;
@@ -23,6 +23,7 @@
 #include <sensor_msgs/msg/point_cloud2.hpp>
 #include <simple_sensor_simulator/sensor_simulation/lidar/raycaster.hpp>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace simple_sensor_simulator
@@ -59,17 +60,24 @@ class LidarSensor : public LidarSensorBase
 {
   const typename rclcpp::Publisher<T>::SharedPtr publisher_ptr_;
 
-  std::queue<std::pair<sensor_msgs::msg::PointCloud2, double>> queue_pointcloud_;
+  std::queue<std::pair<T, double>> queue_pointcloud_;
 
-  auto raycast(const std::vector<traffic_simulator_msgs::EntityStatus> &, const rclcpp::Time &)
-    -> T;
+  /// @note Published messages, whose buffers are filled again by the next raycasts.
+  std::vector<T> spare_pointclouds_;
+
+  auto raycast(
+    const std::vector<traffic_simulator_msgs::EntityStatus> &, const rclcpp::Time &, T & pointcloud)
+    -> void;
 
 public:
   explicit LidarSensor(
     const double current_simulation_time,
     const simulation_api_schema::LidarConfiguration & configuration,
-    const typename rclcpp::Publisher<T>::SharedPtr & publisher_ptr)
-  : LidarSensorBase(current_simulation_time, configuration), publisher_ptr_(publisher_ptr)
+    const typename rclcpp::Publisher<T>::SharedPtr & publisher_ptr,
+    const std::shared_ptr<const StaticScene> & static_scene = nullptr)
+  : LidarSensorBase(current_simulation_time, configuration),
+    publisher_ptr_(publisher_ptr),
+    raycaster_(static_scene)
   {
     raycaster_.setDirection(configuration);
   }
@@ -83,8 +91,13 @@ public:
       current_simulation_time - previous_simulation_time_ - configuration_.scan_duration() >=
       -0.002) {
       previous_simulation_time_ = current_simulation_time;
-      queue_pointcloud_.push(
-        std::make_pair(raycast(status, current_ros_time), current_simulation_time));
+      T pointcloud;
+      if (not spare_pointclouds_.empty()) {
+        pointcloud = std::move(spare_pointclouds_.back());
+        spare_pointclouds_.pop_back();
+      }
+      raycast(status, current_ros_time, pointcloud);
+      queue_pointcloud_.emplace(std::move(pointcloud), current_simulation_time);
     } else {
       detected_objects_.clear();
     }
@@ -93,9 +106,9 @@ public:
       not queue_pointcloud_.empty() and
       current_simulation_time - queue_pointcloud_.front().second >=
         configuration_.lidar_sensor_delay()) {
-      const auto pointcloud = queue_pointcloud_.front().first;
+      publisher_ptr_->publish(queue_pointcloud_.front().first);
+      spare_pointclouds_.push_back(std::move(queue_pointcloud_.front().first));
       queue_pointcloud_.pop();
-      publisher_ptr_->publish(pointcloud);
     }
   }
 
@@ -106,8 +119,8 @@ private:
 
 template <>
 auto LidarSensor<sensor_msgs::msg::PointCloud2>::raycast(
-  const std::vector<traffic_simulator_msgs::EntityStatus> &, const rclcpp::Time &)
-  -> sensor_msgs::msg::PointCloud2;
+  const std::vector<traffic_simulator_msgs::EntityStatus> &, const rclcpp::Time &,
+  sensor_msgs::msg::PointCloud2 &) -> void;
 }  // namespace simple_sensor_simulator
 
 #endif  // SIMPLE_SENSOR_SIMULATOR__SENSOR_SIMULATION__LIDAR__LIDAR_SENSOR_HPP_
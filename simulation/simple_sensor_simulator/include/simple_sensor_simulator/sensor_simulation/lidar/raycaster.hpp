@@ -16,9 +16,11 @@
 #define SIMPLE_SENSOR_SIMULATOR__SENSOR_SIMULATION__LIDAR__RAYCASTER_HPP_
 
 #include <embree3/rtcore.h>
-#include <pcl_conversions/pcl_conversions.h>
 #include <quaternion_operation/quaternion_operation.h>
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <geometry_msgs/msg/pose.hpp>
 #include <geometry_msgs/msg/vector3.hpp>
 #include <memory>
@@ -27,17 +29,42 @@
 #include <simple_sensor_simulator/sensor_simulation/primitives/box.hpp>
 #include <simple_sensor_simulator/sensor_simulation/primitives/primitive.hpp>
 #include <string>
+#include <traffic_simulator/helper/worker_pool.hpp>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace simple_sensor_simulator
 {
+/**
+ * @brief Geometry which never moves, such as the road surface, built once into a BVH of its own.
+ * The raycasters of all the lidars share it, so they trace their rays on its device.
+ */
+class StaticScene
+{
+public:
+  explicit StaticScene(
+    const std::vector<std::shared_ptr<const primitives::Primitive>> & primitives);
+  ~StaticScene();
+  StaticScene(const StaticScene &) = delete;
+  StaticScene & operator=(const StaticScene &) = delete;
+  RTCDevice getDevice() const { return device_; }
+  RTCScene getScene() const { return scene_; }
+
+private:
+  RTCDevice device_;
+  RTCScene scene_;
+};
+
 class Raycaster
 {
 public:
   Raycaster();
   explicit Raycaster(std::string embree_config);
+  /**
+   * @brief The rays also hit static_scene, which is never detected as an object.
+   */
+  explicit Raycaster(std::shared_ptr<const StaticScene> static_scene);
   ~Raycaster();
   template <typename T, typename... Ts>
   void addPrimitive(std::string name, Ts &&... xs)
@@ -51,12 +78,29 @@ public:
   const sensor_msgs::msg::PointCloud2 raycast(
     const std::string & frame_id, const rclcpp::Time & stamp,
     const geometry_msgs::msg::Pose & origin, double max_distance = 300, double min_distance = 0);
+  /**
+   * @brief Fill pointcloud with the hits, as x, y and z float32 fields and a zero intensity. Its
+   * data keeps its capacity, so a message given again each frame is not reallocated.
+   */
+  void raycast(
+    sensor_msgs::msg::PointCloud2 & pointcloud, const std::string & frame_id,
+    const rclcpp::Time & stamp, const geometry_msgs::msg::Pose & origin,
+    double max_distance = 300, double min_distance = 0);
   const std::vector<std::string> & getDetectedObject() const;
   void setDirection(
     const simulation_api_schema::LidarConfiguration & configuration,
     double horizontal_angle_start = 0, double horizontal_angle_end = 2 * M_PI);
 
 private:
+  /// @note An entity kept in scene_ from frame to frame, as an instance of a scene of its own.
+  struct Instance
+  {
+    std::unique_ptr<primitives::Primitive> primitive;
+    RTCScene scene;
+    unsigned int geometry_id;
+    std::array<float, 12> transform;
+  };
+  void updateScene();
   std::vector<geometry_msgs::msg::Quaternion> getDirections(
     const std::vector<double> & vertical_angles, double horizontal_angle_start,
     double horizontal_angle_end, double horizontal_resolution);
@@ -66,56 +110,27 @@ private:
   double previous_horizontal_resolution_;
   std::vector<double> previous_vertical_angles_;
   std::unordered_map<std::string, std::unique_ptr<primitives::Primitive>> primitive_ptrs_;
+  std::unordered_map<std::string, Instance> instances_;
   RTCDevice device_;
   RTCScene scene_;
+  std::shared_ptr<const StaticScene> static_scene_;
   std::random_device seed_gen_;
   std::default_random_engine engine_;
   std::vector<std::string> detected_objects_;
   std::unordered_map<unsigned int, std::string> geometry_ids_;
   std::vector<Eigen::Matrix3d> rotation_matrices_;
 
-  static void intersect(
-    int thread_id, int thread_count, RTCScene scene,
-    pcl::PointCloud<pcl::PointXYZI>::Ptr thread_cloud, RTCIntersectContext context,
-    geometry_msgs::msg::Pose origin,
-    std::reference_wrapper<std::set<unsigned int>> ref_thread_detected_ids, double max_distance,
-    double min_distance,
-    std::reference_wrapper<const std::vector<Eigen::Matrix3d>> ref_rotation_matrices)
-  {
-    auto & rotation_matrices = ref_rotation_matrices.get();
-    auto & thread_detected_ids = ref_thread_detected_ids.get();
-    const auto orientation_matrix = quaternion_operation::getRotationMatrix(origin.orientation);
-    for (unsigned int i = thread_id; i < rotation_matrices.size(); i += thread_count) {
-      RTCRayHit rayhit = {};
-      rayhit.ray.org_x = origin.position.x;
-      rayhit.ray.org_y = origin.position.y;
-      rayhit.ray.org_z = origin.position.z;
-      // make raycast interact with all objects
-      rayhit.ray.mask = 0b11111111'11111111'11111111'11111111;
-      rayhit.ray.tfar = max_distance;
-      rayhit.ray.tnear = min_distance;
-      rayhit.ray.flags = false;
-
-      const auto rotation_mat = orientation_matrix * rotation_matrices.at(i);
-      rayhit.ray.dir_x = rotation_mat(0);
-      rayhit.ray.dir_y = rotation_mat(1);
-      rayhit.ray.dir_z = rotation_mat(2);
-      rayhit.hit.geomID = RTC_INVALID_GEOMETRY_ID;
-      rtcIntersect1(scene, &context, &rayhit);
-
-      if (rayhit.hit.geomID != RTC_INVALID_GEOMETRY_ID) {
-        double distance = rayhit.ray.tfar;
-        pcl::PointXYZI p;
-        {
-          p.x = rotation_matrices.at(i)(0) * distance;
-          p.y = rotation_matrices.at(i)(1) * distance;
-          p.z = rotation_matrices.at(i)(2) * distance;
-        }
-        thread_cloud->emplace_back(p);
-        thread_detected_ids.insert(rayhit.hit.geomID);
-      }
-    }
-  }
+  /// @note Rays traced together by rtcIntersect16, which are adjacent channels of a lidar.
+  static constexpr std::size_t packet_size = 16;
+  void intersect(
+    std::size_t packet_index, RTCIntersectContext context, const geometry_msgs::msg::Pose & origin,
+    const Eigen::Matrix3d & orientation_matrix, double max_distance, double min_distance,
+    std::uint8_t * points);
+  traffic_simulator::helper::WorkerPool worker_pool_;
+  /// @note Detected geometry id of each ray, written by the packet which traced it.
+  std::vector<unsigned int> hit_geometry_ids_;
+  /// @note Flat bitset of the geometry ids hit in the last raycast.
+  std::vector<bool> detected_ids_;
 };
 }  // namespace simple_sensor_simulator
 
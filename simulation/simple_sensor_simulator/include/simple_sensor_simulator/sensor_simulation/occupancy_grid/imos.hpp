@@ -0,0 +1,50 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SIMPLE_SENSOR_SIMULATOR__SENSOR_SIMULATION__OCCUPANCY_GRID__IMOS_HPP_
+#define SIMPLE_SENSOR_SIMULATOR__SENSOR_SIMULATION__OCCUPANCY_GRID__IMOS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+// Row kernels of the imos method used by OccupancyGridBuilder::build, see
+// https://imoz.jp/algorithms/imos_method.html (Japanese)
+// The kernels use AVX2 or SSE2 if the compiler targets them, see imosInstructionSet.
+namespace simple_sensor_simulator
+{
+/**
+ * @brief Replace values[i] with values[0] + ... + values[i], for each i in [0, size).
+ */
+auto prefixSum(int16_t * values, size_t size) -> void;
+
+auto prefixSumScalar(int16_t * values, size_t size) -> void;
+
+/**
+ * @brief Take the prefix sums of a row of the occupied and of the invisible grids, and set the
+ * values of the row: occupied_cost where occupied, otherwise invisible_cost where invisible,
+ * otherwise 0.
+ */
+auto buildRow(
+  int16_t * occupied, int16_t * invisible, int8_t * values, size_t size, int8_t occupied_cost,
+  int8_t invisible_cost) -> void;
+
+auto buildRowScalar(
+  int16_t * occupied, int16_t * invisible, int8_t * values, size_t size, int8_t occupied_cost,
+  int8_t invisible_cost) -> void;
+
+/// @note The instruction set used by the kernels: "AVX2", "SSE2" or "scalar".
+auto imosInstructionSet() -> const char *;
+}  // namespace simple_sensor_simulator
+
+#endif  // SIMPLE_SENSOR_SIMULATOR__SENSOR_SIMULATION__OCCUPANCY_GRID__IMOS_HPP_
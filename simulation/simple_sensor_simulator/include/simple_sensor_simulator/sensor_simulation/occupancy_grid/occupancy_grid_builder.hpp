@@ -19,6 +19,7 @@
 #include <geometry_msgs/msg/point.hpp>
 #include <geometry_msgs/msg/pose.hpp>
 #include <simple_sensor_simulator/sensor_simulation/primitives/box.hpp>
+#include <traffic_simulator/helper/worker_pool.hpp>
 #include <vector>
 
 namespace simple_sensor_simulator
@@ -37,9 +38,13 @@ class OccupancyGridBuilder
   using PolygonType = std::vector<PointType>;
 
 public:
+  /**
+   * @param thread_count Number of threads building the rows of the grid in parallel, see
+   * traffic_simulator::helper::WorkerPool
+   */
   OccupancyGridBuilder(
     double resolution, size_t height, size_t width, int8_t occupied_cost = 100,
-    int8_t invisible_cost = 50);
+    int8_t invisible_cost = 50, size_t thread_count = 1);
 
   const double resolution;
   const size_t height;
@@ -104,6 +109,11 @@ private:
    */
   std::vector<int32_t> min_cols_, max_cols_;
 
+  /**
+   * @brief Threads building the rows of the grid
+   */
+  traffic_simulator::helper::WorkerPool worker_pool_;
+
   /**
    * @brief Mark grid area of convex hull
    * @param grid Grid to be marked
@@ -17,6 +17,7 @@
 
 #include <simulation_api_schema.pb.h>
 
+#include <algorithm>
 #include <memory>
 #include <nav_msgs/msg/occupancy_grid.hpp>
 #include <rclcpp/rclcpp.hpp>
@@ -96,7 +97,9 @@ public:
     const typename rclcpp::Publisher<T>::SharedPtr & publisher_ptr)
   : OccupancyGridSensorBase(current_simulation_time, configuration),
     publisher_ptr_(publisher_ptr),
-    builder_(configuration.resolution(), configuration.height(), configuration.width())
+    builder_(
+      configuration.resolution(), configuration.height(), configuration.width(), 100, 50,
+      std::max(configuration.thread_count(), 1u))
   {
   }
 
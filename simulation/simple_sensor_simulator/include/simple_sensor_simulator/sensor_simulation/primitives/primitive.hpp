@@ -18,6 +18,7 @@
 #include <embree3/rtcore.h>
 
 #include <algorithm>
+#include <array>
 #include <geometry/polygon/polygon.hpp>
 #include <geometry_msgs/msg/pose.hpp>
 #include <optional>
@@ -54,7 +55,12 @@ public:
   virtual ~Primitive() = default;
   const std::string type;
   const geometry_msgs::msg::Pose pose;
-  unsigned int addToScene(RTCDevice device, RTCScene scene);
+  unsigned int addToScene(RTCDevice device, RTCScene scene) const;
+  /// @note The primitive in its own frame, to be instanced with getTransform.
+  RTCScene addToNewScene(RTCDevice device) const;
+  /// @note The pose as a column major 3x4 matrix, see RTC_FORMAT_FLOAT3X4_COLUMN_MAJOR.
+  std::array<float, 12> getTransform() const;
+  bool hasSameShape(const Primitive & other) const;
   std::vector<Vertex> getVertex() const;
   std::vector<Triangle> getTriangles() const;
   std::vector<geometry_msgs::msg::Point> get2DConvexHull() const;
@@ -74,6 +80,7 @@ protected:
   std::vector<Triangle> triangles_;
 
 private:
+  RTCGeometry createGeometry(RTCDevice device, const std::vector<Vertex> & vertices) const;
   Vertex transform(const Vertex & v) const;
   Vertex transform(const Vertex & v, const geometry_msgs::msg::Pose & sensor_pose) const;
 };
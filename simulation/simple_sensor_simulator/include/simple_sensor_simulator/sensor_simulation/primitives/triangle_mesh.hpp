@@ -0,0 +1,49 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SIMPLE_SENSOR_SIMULATOR__SENSOR_SIMULATION__PRIMITIVES__TRIANGLE_MESH_HPP_
+#define SIMPLE_SENSOR_SIMULATOR__SENSOR_SIMULATION__PRIMITIVES__TRIANGLE_MESH_HPP_
+
+#include <lanelet2_core/LaneletMap.h>
+
+#include <simple_sensor_simulator/sensor_simulation/primitives/primitive.hpp>
+#include <string>
+#include <vector>
+
+namespace simple_sensor_simulator
+{
+namespace primitives
+{
+/// @note Any triangulated surface, such as the static geometry of the map.
+class TriangleMesh : public Primitive
+{
+public:
+  explicit TriangleMesh(
+    std::vector<Vertex> vertices, std::vector<Triangle> triangles,
+    const geometry_msgs::msg::Pose & pose = geometry_msgs::msg::Pose());
+  ~TriangleMesh() = default;
+};
+
+/**
+ * @brief The lanelets triangulated as the road surface, and the road borders and curbstones
+ * extruded upwards by curb_height as walls, in the map frame.
+ */
+TriangleMesh makeRoadMesh(const lanelet::LaneletMap & map, double curb_height = 0.15);
+
+/// @note Read the vertices and the faces of a Wavefront OBJ file, in the map frame.
+TriangleMesh loadMesh(const std::string & path);
+}  // namespace primitives
+}  // namespace simple_sensor_simulator
+
+#endif  // SIMPLE_SENSOR_SIMULATOR__SENSOR_SIMULATION__PRIMITIVES__TRIANGLE_MESH_HPP_
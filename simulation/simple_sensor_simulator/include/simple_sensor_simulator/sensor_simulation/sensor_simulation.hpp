@@ -37,13 +37,15 @@ class SensorSimulation
 public:
   auto attachLidarSensor(
     const double current_simulation_time,
-    const simulation_api_schema::LidarConfiguration & configuration, rclcpp::Node & node) -> void
+    const simulation_api_schema::LidarConfiguration & configuration, rclcpp::Node & node,
+    const std::shared_ptr<const StaticScene> & static_scene = nullptr) -> void
   {
     if (configuration.architecture_type().find("awf/universe") != std::string::npos) {
       lidar_sensors_.push_back(std::make_unique<LidarSensor<sensor_msgs::msg::PointCloud2>>(
         current_simulation_time, configuration,
         node.create_publisher<sensor_msgs::msg::PointCloud2>(
-          "/perception/obstacle_segmentation/pointcloud", 1)));
+          "/perception/obstacle_segmentation/pointcloud", 1),
+        static_scene));
     } else {
       std::stringstream ss;
       ss << "Unexpected architecture_type " << std::quoted(configuration.architecture_type())
@@ -26,6 +26,7 @@
 #include <rclcpp/rclcpp.hpp>
 #include <simple_sensor_simulator/sensor_simulation/lidar/lidar_sensor.hpp>
 #include <simple_sensor_simulator/sensor_simulation/lidar/raycaster.hpp>
+#include <simple_sensor_simulator/sensor_simulation/primitives/triangle_mesh.hpp>
 #include <simple_sensor_simulator/sensor_simulation/sensor_simulation.hpp>
 #include <simple_sensor_simulator/vehicle_simulation/ego_entity_simulation.hpp>
 #include <simulation_interface/zmq_multi_server.hpp>
@@ -136,6 +137,7 @@ private:
     -> simulation_api_schema::AttachPseudoTrafficLightDetectorResponse;
 
   int getSocketPort();
+  simulation_interface::TransportProtocol getTransportProtocol();
   std::vector<traffic_simulator_msgs::VehicleParameters> ego_vehicles_;
   std::vector<traffic_simulator_msgs::VehicleParameters> vehicles_;
   std::vector<traffic_simulator_msgs::PedestrianParameters> pedestrians_;
@@ -147,11 +149,15 @@ private:
   rclcpp::Time current_ros_time_;
   bool initialized_;
   std::map<std::string, simulation_api_schema::EntityStatus> entity_status_;
+  /// @note Names indexed by the id of EntityStatus, for EntityStatusDelta.
+  std::vector<std::string> entity_names_;
   simulation_api_schema::UpdateTrafficLightsRequest traffic_signals_states_;
   traffic_simulator_msgs::BoundingBox getBoundingBox(const std::string & name);
   zeromq::MultiServer server_;
   geographic_msgs::msg::GeoPoint getOrigin();
   std::shared_ptr<hdmap_utils::HdMapUtils> hdmap_utils_;
+  /// @note Map geometry hit by the rays of every lidar, built once per map.
+  std::shared_ptr<const StaticScene> lidar_static_scene_;
   std::shared_ptr<vehicle_simulation::EgoEntitySimulation> ego_entity_simulation_;
 
   bool isEgo(const std::string & name);
@@ -27,7 +27,7 @@ namespace simple_sensor_simulator
 template <>
 auto LidarSensor<sensor_msgs::msg::PointCloud2>::raycast(
   const std::vector<traffic_simulator_msgs::EntityStatus> & entities,
-  const rclcpp::Time & current_ros_time) -> sensor_msgs::msg::PointCloud2
+  const rclcpp::Time & current_ros_time, sensor_msgs::msg::PointCloud2 & pointcloud) -> void
 {
   std::optional<geometry_msgs::msg::Pose> ego_pose;
 
@@ -57,13 +57,8 @@ auto LidarSensor<sensor_msgs::msg::PointCloud2>::raycast(
   }
 
   if (ego_pose) {
-    std::vector<double> vertical_angles;
-    for (const auto vertical_angle : configuration_.vertical_angles()) {
-      vertical_angles.push_back(vertical_angle);
-    }
-    const auto pointcloud = raycaster_.raycast("base_link", current_ros_time, ego_pose.value());
+    raycaster_.raycast(pointcloud, "base_link", current_ros_time, ego_pose.value());
     detected_objects_ = raycaster_.getDetectedObject();
-    return pointcloud;
   } else {
     throw simple_sensor_simulator::SimulationRuntimeError("failed to find ego vehicle");
   }
@@ -15,34 +15,90 @@
 #include <quaternion_operation/quaternion_operation.h>
 
 #include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <simple_sensor_simulator/sensor_simulation/lidar/lidar_sensor.hpp>
 #include <simple_sensor_simulator/sensor_simulation/lidar/raycaster.hpp>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace simple_sensor_simulator
 {
-Raycaster::Raycaster()
+StaticScene::StaticScene(
+  const std::vector<std::shared_ptr<const primitives::Primitive>> & primitives)
+: device_(rtcNewDevice(nullptr)), scene_(rtcNewScene(device_))
+{
+  // built once, so take the time to build a good BVH
+  rtcSetSceneBuildQuality(scene_, RTC_BUILD_QUALITY_HIGH);
+  for (const auto & primitive : primitives) {
+    primitive->addToScene(device_, scene_);
+  }
+  rtcCommitScene(scene_);
+}
+
+StaticScene::~StaticScene()
+{
+  rtcReleaseScene(scene_);
+  rtcReleaseDevice(device_);
+}
+
+Raycaster::Raycaster() : Raycaster(std::shared_ptr<const StaticScene>()) {}
+
+Raycaster::Raycaster(std::shared_ptr<const StaticScene> static_scene)
 : primitive_ptrs_(0),
-  device_(rtcNewDevice(nullptr)),
+  // an instance can only refer to a scene of the same device
+  device_(static_scene ? static_scene->getDevice() : rtcNewDevice(nullptr)),
   scene_(rtcNewScene(device_)),
-  engine_(seed_gen_())
+  static_scene_(std::move(static_scene)),
+  engine_(seed_gen_()),
+  // as many threads as physical cores (which is usually /2 virtual threads), since in heavy loads
+  // virtual threads (hyper-threading) add little to the overall performance
+  worker_pool_(std::max(std::thread::hardware_concurrency() / 2, 1u))
 {
+  // the instances move every frame, so rebuild the top level BVH fast rather than well
+  rtcSetSceneFlags(scene_, RTC_SCENE_FLAG_DYNAMIC);
+  rtcSetSceneBuildQuality(scene_, RTC_BUILD_QUALITY_LOW);
+  if (static_scene_) {
+    // released by the destructor, like a device of its own
+    rtcRetainDevice(device_);
+    RTCGeometry geometry = rtcNewGeometry(device_, RTC_GEOMETRY_TYPE_INSTANCE);
+    rtcSetGeometryInstancedScene(geometry, static_scene_->getScene());
+    constexpr std::array<float, 12> identity = {1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0};
+    rtcSetGeometryTransform(geometry, 0, RTC_FORMAT_FLOAT3X4_COLUMN_MAJOR, identity.data());
+    // enable raycasting
+    rtcSetGeometryMask(geometry, 0b11111111'11111111'11111111'11111111);
+    rtcCommitGeometry(geometry);
+    // not in geometry_ids_, so not reported by getDetectedObject
+    rtcAttachGeometry(scene_, geometry);
+    rtcReleaseGeometry(geometry);
+  }
 }
 
 Raycaster::Raycaster(std::string embree_config)
 : primitive_ptrs_(0),
   device_(rtcNewDevice(embree_config.c_str())),
   scene_(rtcNewScene(device_)),
-  engine_(seed_gen_())
+  engine_(seed_gen_()),
+  // as many threads as physical cores (which is usually /2 virtual threads), since in heavy loads
+  // virtual threads (hyper-threading) add little to the overall performance
+  worker_pool_(std::max(std::thread::hardware_concurrency() / 2, 1u))
 {
+  // the instances move every frame, so rebuild the top level BVH fast rather than well
+  rtcSetSceneFlags(scene_, RTC_SCENE_FLAG_DYNAMIC);
+  rtcSetSceneBuildQuality(scene_, RTC_BUILD_QUALITY_LOW);
 }
 
 Raycaster::~Raycaster()
 {
+  for (const auto & [name, instance] : instances_) {
+    rtcReleaseScene(instance.scene);
+  }
   rtcReleaseScene(scene_);
   rtcReleaseDevice(device_);
 }
@@ -98,55 +154,197 @@ std::vector<geometry_msgs::msg::Quaternion> Raycaster::getDirections(
 
 const std::vector<std::string> & Raycaster::getDetectedObject() const { return detected_objects_; }
 
+/**
+ * @brief Move the primitives added since the last frame into scene_. An entity added again with the
+ * same shape only has the transform of its instance updated, so its geometry and BVH are kept.
+ * The entities which were not added again are removed.
+ */
+void Raycaster::updateScene()
+{
+  for (auto iter = instances_.begin(); iter != instances_.end();) {
+    if (const auto primitive = primitive_ptrs_.find(iter->first);
+        primitive == primitive_ptrs_.end() or
+        not primitive->second->hasSameShape(*iter->second.primitive)) {
+      rtcDetachGeometry(scene_, iter->second.geometry_id);
+      rtcReleaseScene(iter->second.scene);
+      geometry_ids_.erase(iter->second.geometry_id);
+      iter = instances_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+
+  for (auto & [name, primitive] : primitive_ptrs_) {
+    const auto transform = primitive->getTransform();
+    if (auto iter = instances_.find(name); iter != instances_.end()) {
+      if (iter->second.transform != transform) {
+        RTCGeometry geometry = rtcGetGeometry(scene_, iter->second.geometry_id);
+        rtcSetGeometryTransform(geometry, 0, RTC_FORMAT_FLOAT3X4_COLUMN_MAJOR, transform.data());
+        rtcCommitGeometry(geometry);
+        iter->second.transform = transform;
+      }
+      iter->second.primitive = std::move(primitive);
+    } else {
+      Instance instance;
+      instance.scene = primitive->addToNewScene(device_);
+      RTCGeometry geometry = rtcNewGeometry(device_, RTC_GEOMETRY_TYPE_INSTANCE);
+      rtcSetGeometryInstancedScene(geometry, instance.scene);
+      rtcSetGeometryTransform(geometry, 0, RTC_FORMAT_FLOAT3X4_COLUMN_MAJOR, transform.data());
+      // enable raycasting
+      rtcSetGeometryMask(geometry, 0b11111111'11111111'11111111'11111111);
+      rtcCommitGeometry(geometry);
+      instance.geometry_id = rtcAttachGeometry(scene_, geometry);
+      rtcReleaseGeometry(geometry);
+      instance.transform = transform;
+      instance.primitive = std::move(primitive);
+      geometry_ids_.emplace(instance.geometry_id, name);
+      instances_.emplace(name, std::move(instance));
+    }
+  }
+
+  primitive_ptrs_.clear();
+  rtcCommitScene(scene_);
+}
+
+namespace
+{
+/// @note x, y, z and intensity as float32, see Raycaster::raycast.
+constexpr std::uint32_t point_step = 4 * sizeof(float);
+
+auto makePointField(const std::string & name, std::uint32_t offset) -> sensor_msgs::msg::PointField
+{
+  sensor_msgs::msg::PointField field;
+  field.name = name;
+  field.offset = offset;
+  field.datatype = sensor_msgs::msg::PointField::FLOAT32;
+  field.count = 1;
+  return field;
+}
+}  // namespace
+
+/**
+ * @brief Trace the rays [packet_index * packet_size, (packet_index + 1) * packet_size) as one
+ * packet, and write their hits into hit_geometry_ids_ and their points into the slots of points.
+ */
+void Raycaster::intersect(
+  std::size_t packet_index, RTCIntersectContext context, const geometry_msgs::msg::Pose & origin,
+  const Eigen::Matrix3d & orientation_matrix, double max_distance, double min_distance,
+  std::uint8_t * points)
+{
+  const auto begin = packet_index * packet_size;
+  const auto size = std::min(packet_size, rotation_matrices_.size() - begin);
+  alignas(64) std::array<int, packet_size> valid;
+  RTCRayHit16 rayhit;
+  for (std::size_t j = 0; j < packet_size; ++j) {
+    // the rays after the last one only fill the packet
+    valid[j] = j < size ? -1 : 0;
+    const Eigen::Vector3d direction =
+      orientation_matrix * rotation_matrices_[begin + std::min(j, size - 1)].col(0);
+    rayhit.ray.org_x[j] = origin.position.x;
+    rayhit.ray.org_y[j] = origin.position.y;
+    rayhit.ray.org_z[j] = origin.position.z;
+    rayhit.ray.dir_x[j] = direction(0);
+    rayhit.ray.dir_y[j] = direction(1);
+    rayhit.ray.dir_z[j] = direction(2);
+    rayhit.ray.tnear[j] = min_distance;
+    rayhit.ray.tfar[j] = max_distance;
+    rayhit.ray.time[j] = 0;
+    // make raycast interact with all objects
+    rayhit.ray.mask[j] = 0b11111111'11111111'11111111'11111111;
+    rayhit.ray.id[j] = j;
+    rayhit.ray.flags[j] = 0;
+    rayhit.hit.geomID[j] = RTC_INVALID_GEOMETRY_ID;
+    rayhit.hit.instID[0][j] = RTC_INVALID_GEOMETRY_ID;
+  }
+  rtcIntersect16(valid.data(), scene_, &context, &rayhit);
+
+  for (std::size_t j = 0; j < size; ++j) {
+    const auto i = begin + j;
+    // for a hit of an instance, geomID is the id of the geometry in the instanced scene
+    hit_geometry_ids_[i] = rayhit.hit.instID[0][j] != RTC_INVALID_GEOMETRY_ID
+                             ? rayhit.hit.instID[0][j]
+                             : rayhit.hit.geomID[j];
+    if (hit_geometry_ids_[i] != RTC_INVALID_GEOMETRY_ID) {
+      const float distance = rayhit.ray.tfar[j];
+      const std::array<float, 4> point = {
+        static_cast<float>(rotation_matrices_[i](0) * distance),
+        static_cast<float>(rotation_matrices_[i](1) * distance),
+        static_cast<float>(rotation_matrices_[i](2) * distance), 0.0f};
+      std::memcpy(points + i * point_step, point.data(), point_step);
+    }
+  }
+}
+
 const sensor_msgs::msg::PointCloud2 Raycaster::raycast(
   const std::string & frame_id, const rclcpp::Time & stamp, const geometry_msgs::msg::Pose & origin,
   double max_distance, double min_distance)
 {
-  detected_objects_ = {};
-  pcl::PointCloud<pcl::PointXYZI>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZI>());
-  for (auto & pair : primitive_ptrs_) {
-    auto id = pair.second->addToScene(device_, scene_);
-    geometry_ids_.insert({id, pair.first});
-  }
+  sensor_msgs::msg::PointCloud2 pointcloud;
+  raycast(pointcloud, frame_id, stamp, origin, max_distance, min_distance);
+  return pointcloud;
+}
 
-  // Run as many threads as physical cores (which is usually /2 virtual threads)
-  // In heavy loads virtual threads (hyper-threading) add little to the overall performance
-  // This also minimizes cost of creating a thread (roughly 10us on Intel/Linux)
-  int thread_count = std::thread::hardware_concurrency() / 2;
-  // Per thread data structures:
-  std::vector<std::thread> threads(thread_count);
-  std::vector<std::set<unsigned int>> thread_detected_ids(thread_count);
-  std::vector<pcl::PointCloud<pcl::PointXYZI>::Ptr> thread_cloud(thread_count);
+void Raycaster::raycast(
+  sensor_msgs::msg::PointCloud2 & pointcloud, const std::string & frame_id,
+  const rclcpp::Time & stamp, const geometry_msgs::msg::Pose & origin, double max_distance,
+  double min_distance)
+{
+  detected_objects_.clear();
+  updateScene();
 
-  rtcCommitScene(scene_);
   RTCIntersectContext context;
-  for (unsigned int i = 0; i < threads.size(); ++i) {
-    thread_cloud[i] = pcl::PointCloud<pcl::PointXYZI>::Ptr(new pcl::PointCloud<pcl::PointXYZI>());
-    threads[i] = std::thread(
-      intersect, i, thread_count, scene_, thread_cloud[i], context, origin,
-      std::ref(thread_detected_ids[i]), max_distance, min_distance, std::ref(rotation_matrices_));
-  }
-  for (unsigned int i = 0; i < threads.size(); ++i) {
-    threads[i].join();
-    (*cloud) += *(thread_cloud[i]);
+  rtcInitIntersectContext(&context);
+  // the rays of a packet are adjacent channels, so they mostly traverse the same nodes
+  context.flags = RTC_INTERSECT_CONTEXT_FLAG_COHERENT;
+  const auto orientation_matrix = quaternion_operation::getRotationMatrix(origin.orientation);
+  hit_geometry_ids_.resize(rotation_matrices_.size());
+  // one slot per ray, compacted below
+  pointcloud.data.resize(rotation_matrices_.size() * point_step);
+  // each thread of the pool traces a contiguous range of packets
+  worker_pool_.parallelFor(
+    (rotation_matrices_.size() + packet_size - 1) / packet_size, [&](std::size_t packet_index) {
+      intersect(
+        packet_index, context, origin, orientation_matrix, max_distance, min_distance,
+        pointcloud.data.data());
+    });
+
+  std::size_t point_count = 0;
+  std::fill(detected_ids_.begin(), detected_ids_.end(), false);
+  for (std::size_t i = 0; i < rotation_matrices_.size(); ++i) {
+    if (const auto id = hit_geometry_ids_[i]; id != RTC_INVALID_GEOMETRY_ID) {
+      if (point_count != i) {
+        std::memcpy(
+          pointcloud.data.data() + point_count * point_step,
+          pointcloud.data.data() + i * point_step, point_step);
+      }
+      ++point_count;
+      if (detected_ids_.size() <= id) {
+        detected_ids_.resize(id + 1);
+      }
+      detected_ids_[id] = true;
+    }
   }
-  for (auto && detected_ids_in_thread : thread_detected_ids) {
-    for (const auto & id : detected_ids_in_thread) {
-      detected_objects_.emplace_back(geometry_ids_[id]);
+  pointcloud.data.resize(point_count * point_step);
+  for (unsigned int id = 0; id < detected_ids_.size(); ++id) {
+    if (detected_ids_[id]) {
+      if (const auto name = geometry_ids_.find(id); name != geometry_ids_.end()) {
+        detected_objects_.emplace_back(name->second);
+      }
     }
   }
 
-  for (const auto & id : geometry_ids_) {
-    rtcDetachGeometry(scene_, id.first);
+  if (pointcloud.fields.size() != 4) {
+    pointcloud.fields = {
+      makePointField("x", 0), makePointField("y", sizeof(float)),
+      makePointField("z", 2 * sizeof(float)), makePointField("intensity", 3 * sizeof(float))};
   }
-
-  geometry_ids_.clear();
-  primitive_ptrs_.clear();
-
-  sensor_msgs::msg::PointCloud2 pointcloud_msg;
-  pcl::toROSMsg(*cloud, pointcloud_msg);
-  pointcloud_msg.header.frame_id = frame_id;
-  pointcloud_msg.header.stamp = stamp;
-  return pointcloud_msg;
+  pointcloud.header.frame_id = frame_id;
+  pointcloud.header.stamp = stamp;
+  pointcloud.height = 1;
+  pointcloud.width = point_count;
+  pointcloud.is_bigendian = false;
+  pointcloud.point_step = point_step;
+  pointcloud.row_step = point_count * point_step;
+  pointcloud.is_dense = true;
 }
 }  // namespace simple_sensor_simulator
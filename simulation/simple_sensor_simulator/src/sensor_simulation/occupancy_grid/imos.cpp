@@ -0,0 +1,206 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <simple_sensor_simulator/sensor_simulation/occupancy_grid/imos.hpp>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace simple_sensor_simulator
+{
+namespace
+{
+#if defined(__SSE2__)
+/// @note The prefix sum of the 8 values of x, by adding x shifted by 1, 2 and 4 values.
+inline auto prefixSum8(__m128i x) -> __m128i
+{
+  x = _mm_add_epi16(x, _mm_slli_si128(x, 2));
+  x = _mm_add_epi16(x, _mm_slli_si128(x, 4));
+  return _mm_add_epi16(x, _mm_slli_si128(x, 8));
+}
+
+/// @note The last of the 8 values of x, in all of them.
+inline auto broadcastLast8(__m128i x) -> __m128i
+{
+  return _mm_shuffle_epi32(_mm_shufflehi_epi16(x, 0xFF), 0xFF);
+}
+
+/// @note The cost of each of the 8 cells, as 16 bit values.
+inline auto cost8(
+  __m128i occupied, __m128i invisible, __m128i occupied_cost, __m128i invisible_cost) -> __m128i
+{
+  const auto zero = _mm_setzero_si128();
+  const auto not_occupied = _mm_cmpeq_epi16(occupied, zero);
+  const auto not_invisible = _mm_cmpeq_epi16(invisible, zero);
+  return _mm_or_si128(
+    _mm_andnot_si128(not_occupied, occupied_cost),
+    _mm_and_si128(not_occupied, _mm_andnot_si128(not_invisible, invisible_cost)));
+}
+#endif
+
+#if defined(__AVX2__)
+/// @note The byte shifts of AVX2 stay within each 128 bit lane, so the sum of the lower lane is
+/// added to the upper lane afterwards.
+inline auto prefixSum16(__m256i x) -> __m256i
+{
+  x = _mm256_add_epi16(x, _mm256_slli_si256(x, 2));
+  x = _mm256_add_epi16(x, _mm256_slli_si256(x, 4));
+  x = _mm256_add_epi16(x, _mm256_slli_si256(x, 8));
+  const auto lane_sums = _mm256_shuffle_epi32(_mm256_shufflehi_epi16(x, 0xFF), 0xFF);
+  return _mm256_add_epi16(x, _mm256_permute2x128_si256(lane_sums, lane_sums, 0x08));
+}
+
+/// @note The last of the 16 values of x, in all of them.
+inline auto broadcastLast16(__m256i x) -> __m256i
+{
+  const auto lane_sums = _mm256_shuffle_epi32(_mm256_shufflehi_epi16(x, 0xFF), 0xFF);
+  return _mm256_permute2x128_si256(lane_sums, lane_sums, 0x11);
+}
+
+/// @note The cost of each of the 16 cells, as 16 bit values.
+inline auto cost16(
+  __m256i occupied, __m256i invisible, __m256i occupied_cost, __m256i invisible_cost) -> __m256i
+{
+  const auto zero = _mm256_setzero_si256();
+  const auto not_occupied = _mm256_cmpeq_epi16(occupied, zero);
+  const auto not_invisible = _mm256_cmpeq_epi16(invisible, zero);
+  return _mm256_or_si256(
+    _mm256_andnot_si256(not_occupied, occupied_cost),
+    _mm256_and_si256(not_occupied, _mm256_andnot_si256(not_invisible, invisible_cost)));
+}
+#endif
+}  // namespace
+
+auto prefixSumScalar(int16_t * values, size_t size) -> void
+{
+  for (size_t i = 1; i < size; ++i) {
+    values[i] += values[i - 1];
+  }
+}
+
+auto prefixSum(int16_t * values, size_t size) -> void
+{
+  size_t i = 0;
+#if defined(__AVX2__)
+  {
+    auto carry = _mm256_setzero_si256();
+    for (; i + 16 <= size; i += 16) {
+      const auto pointer = reinterpret_cast<__m256i *>(values + i);
+      const auto x = _mm256_add_epi16(prefixSum16(_mm256_loadu_si256(pointer)), carry);
+      _mm256_storeu_si256(pointer, x);
+      carry = broadcastLast16(x);
+    }
+  }
+#endif
+#if defined(__SSE2__)
+  {
+    auto carry = _mm_set1_epi16(i == 0 ? 0 : values[i - 1]);
+    for (; i + 8 <= size; i += 8) {
+      const auto pointer = reinterpret_cast<__m128i *>(values + i);
+      const auto x = _mm_add_epi16(prefixSum8(_mm_loadu_si128(pointer)), carry);
+      _mm_storeu_si128(pointer, x);
+      carry = broadcastLast8(x);
+    }
+  }
+#endif
+  // the values after the last full vector
+  for (i = i == 0 ? 1 : i; i < size; ++i) {
+    values[i] += values[i - 1];
+  }
+}
+
+auto buildRowScalar(
+  int16_t * occupied, int16_t * invisible, int8_t * values, size_t size, int8_t occupied_cost,
+  int8_t invisible_cost) -> void
+{
+  prefixSumScalar(occupied, size);
+  prefixSumScalar(invisible, size);
+  for (size_t i = 0; i < size; ++i) {
+    values[i] = occupied[i] ? occupied_cost : invisible[i] ? invisible_cost : 0;
+  }
+}
+
+auto buildRow(
+  int16_t * occupied, int16_t * invisible, int8_t * values, size_t size, int8_t occupied_cost,
+  int8_t invisible_cost) -> void
+{
+  // both grids are summed and converted in one pass, vector by vector
+  size_t i = 0;
+#if defined(__AVX2__)
+  {
+    const auto occupied_cost_16 = _mm256_set1_epi16(occupied_cost);
+    const auto invisible_cost_16 = _mm256_set1_epi16(invisible_cost);
+    auto occupied_carry = _mm256_setzero_si256();
+    auto invisible_carry = _mm256_setzero_si256();
+    for (; i + 16 <= size; i += 16) {
+      const auto occupied_pointer = reinterpret_cast<__m256i *>(occupied + i);
+      const auto invisible_pointer = reinterpret_cast<__m256i *>(invisible + i);
+      const auto o =
+        _mm256_add_epi16(prefixSum16(_mm256_loadu_si256(occupied_pointer)), occupied_carry);
+      const auto v =
+        _mm256_add_epi16(prefixSum16(_mm256_loadu_si256(invisible_pointer)), invisible_carry);
+      _mm256_storeu_si256(occupied_pointer, o);
+      _mm256_storeu_si256(invisible_pointer, v);
+      occupied_carry = broadcastLast16(o);
+      invisible_carry = broadcastLast16(v);
+      // packing works within each 128 bit lane, so gather the lower 64 bits of both lanes
+      const auto costs = cost16(o, v, occupied_cost_16, invisible_cost_16);
+      const auto packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(costs, costs), 0b1000);
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(values + i), _mm256_castsi256_si128(packed));
+    }
+  }
+#endif
+#if defined(__SSE2__)
+  {
+    const auto occupied_cost_16 = _mm_set1_epi16(occupied_cost);
+    const auto invisible_cost_16 = _mm_set1_epi16(invisible_cost);
+    auto occupied_carry = _mm_set1_epi16(i == 0 ? 0 : occupied[i - 1]);
+    auto invisible_carry = _mm_set1_epi16(i == 0 ? 0 : invisible[i - 1]);
+    for (; i + 8 <= size; i += 8) {
+      const auto occupied_pointer = reinterpret_cast<__m128i *>(occupied + i);
+      const auto invisible_pointer = reinterpret_cast<__m128i *>(invisible + i);
+      const auto o = _mm_add_epi16(prefixSum8(_mm_loadu_si128(occupied_pointer)), occupied_carry);
+      const auto v =
+        _mm_add_epi16(prefixSum8(_mm_loadu_si128(invisible_pointer)), invisible_carry);
+      _mm_storeu_si128(occupied_pointer, o);
+      _mm_storeu_si128(invisible_pointer, v);
+      occupied_carry = broadcastLast8(o);
+      invisible_carry = broadcastLast8(v);
+      const auto costs = cost8(o, v, occupied_cost_16, invisible_cost_16);
+      _mm_storel_epi64(reinterpret_cast<__m128i *>(values + i), _mm_packs_epi16(costs, costs));
+    }
+  }
+#endif
+  // the cells after the last full vector
+  for (; i < size; ++i) {
+    if (i > 0) {
+      occupied[i] += occupied[i - 1];
+      invisible[i] += invisible[i - 1];
+    }
+    values[i] = occupied[i] ? occupied_cost : invisible[i] ? invisible_cost : 0;
+  }
+}
+
+auto imosInstructionSet() -> const char *
+{
+#if defined(__AVX2__)
+  return "AVX2";
+#elif defined(__SSE2__)
+  return "SSE2";
+#else
+  return "scalar";
+#endif
+}
+}  // namespace simple_sensor_simulator
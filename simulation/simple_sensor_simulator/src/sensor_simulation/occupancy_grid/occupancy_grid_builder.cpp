@@ -17,12 +17,14 @@
 #include <boost/geometry.hpp>
 #include <rclcpp/rclcpp.hpp>
 #include <simple_sensor_simulator/sensor_simulation/occupancy_grid/grid_traversal.hpp>
+#include <simple_sensor_simulator/sensor_simulation/occupancy_grid/imos.hpp>
 #include <simple_sensor_simulator/sensor_simulation/occupancy_grid/occupancy_grid_builder.hpp>
 
 namespace simple_sensor_simulator
 {
 OccupancyGridBuilder::OccupancyGridBuilder(
-  double resolution, size_t height, size_t width, int8_t occupied_cost, int8_t invisible_cost)
+  double resolution, size_t height, size_t width, int8_t occupied_cost, int8_t invisible_cost,
+  size_t thread_count)
 : resolution(resolution),
   height(height),
   width(width),
@@ -35,7 +37,9 @@ OccupancyGridBuilder::OccupancyGridBuilder(
   values_(height * width),
 
   min_cols_(height),
-  max_cols_(height)
+  max_cols_(height),
+
+  worker_pool_(thread_count)
 {
 }
 
@@ -278,25 +282,13 @@ auto OccupancyGridBuilder::build() -> void
 {
   // https://imoz.jp/algorithms/imos_method.html (Japanese)
 
-  // We can make prefix sum calculation faster by unrolling for loop and
-  // tweaking compiler options, but, as far as I run this code locally,
-  // it takes about 200us for 400x400 grids and I think it is sufficient,
-  // so I leave this naive implementation.
-  for (size_t row = 0; row < height; ++row) {
-    for (size_t col = 0; col + 1 < width; ++col) {
-      invisible_grid_[row * width + col + 1] += invisible_grid_[row * width + col];
-    }
-  }
-
-  for (size_t row = 0; row < height; ++row) {
-    for (size_t col = 0; col + 1 < width; ++col) {
-      occupied_grid_[row * width + col + 1] += occupied_grid_[row * width + col];
-    }
-  }
-
-  for (size_t i = 0; i < height * width; ++i) {
-    values_[i] = occupied_grid_[i] ? occupied_cost : invisible_grid_[i] ? invisible_cost : 0;
-  }
+  // Each row is independent, so the rows are split between the threads, and each row is summed
+  // and converted to grid values while it is in the cache.
+  worker_pool_.parallelFor(height, [this](size_t row) {
+    buildRow(
+      occupied_grid_.data() + row * width, invisible_grid_.data() + row * width,
+      values_.data() + row * width, width, occupied_cost, invisible_cost);
+  });
 }
 
 auto OccupancyGridBuilder::get() const -> const OccupancyGridType & { return values_; }
@@ -114,15 +114,13 @@ std::vector<geometry_msgs::msg::Point> Primitive::get2DConvexHull() const
   return math::geometry::get2DConvexHull(toPoints(transform()));
 }
 
-unsigned int Primitive::addToScene(RTCDevice device, RTCScene scene)
+RTCGeometry Primitive::createGeometry(RTCDevice device, const std::vector<Vertex> & vertices) const
 {
   RTCGeometry mesh = rtcNewGeometry(device, RTC_GEOMETRY_TYPE_TRIANGLE);
-  const auto transformed_vertices = transform();
-  Vertex * vertices = static_cast<Vertex *>(rtcSetNewGeometryBuffer(
-    mesh, RTC_BUFFER_TYPE_VERTEX, 0, RTC_FORMAT_FLOAT3, sizeof(Vertex),
-    transformed_vertices.size()));
-  for (size_t i = 0; i < transformed_vertices.size(); i++) {
-    vertices[i] = transformed_vertices[i];
+  Vertex * vertex_buffer = static_cast<Vertex *>(rtcSetNewGeometryBuffer(
+    mesh, RTC_BUFFER_TYPE_VERTEX, 0, RTC_FORMAT_FLOAT3, sizeof(Vertex), vertices.size()));
+  for (size_t i = 0; i < vertices.size(); i++) {
+    vertex_buffer[i] = vertices[i];
   }
   Triangle * triangles = static_cast<Triangle *>(rtcSetNewGeometryBuffer(
     mesh, RTC_BUFFER_TYPE_INDEX, 0, RTC_FORMAT_UINT3, sizeof(Triangle), triangles_.size()));
@@ -132,11 +130,59 @@ unsigned int Primitive::addToScene(RTCDevice device, RTCScene scene)
   // enable raycasting
   rtcSetGeometryMask(mesh, 0b11111111'11111111'11111111'11111111);
   rtcCommitGeometry(mesh);
+  return mesh;
+}
+
+unsigned int Primitive::addToScene(RTCDevice device, RTCScene scene) const
+{
+  RTCGeometry mesh = createGeometry(device, transform());
   unsigned int geometry_id = rtcAttachGeometry(scene, mesh);
   rtcReleaseGeometry(mesh);
   return geometry_id;
 }
 
+RTCScene Primitive::addToNewScene(RTCDevice device) const
+{
+  RTCScene scene = rtcNewScene(device);
+  RTCGeometry mesh = createGeometry(device, vertices_);
+  rtcAttachGeometry(scene, mesh);
+  rtcReleaseGeometry(mesh);
+  rtcCommitScene(scene);
+  return scene;
+}
+
+std::array<float, 12> Primitive::getTransform() const
+{
+  const auto rotation = quaternion_operation::getRotationMatrix(pose.orientation);
+  std::array<float, 12> transform;
+  for (int column = 0; column < 3; ++column) {
+    for (int row = 0; row < 3; ++row) {
+      transform[column * 3 + row] = rotation(row, column);
+    }
+  }
+  transform[9] = pose.position.x;
+  transform[10] = pose.position.y;
+  transform[11] = pose.position.z;
+  return transform;
+}
+
+bool Primitive::hasSameShape(const Primitive & other) const
+{
+  auto equals = [](const Vertex & v0, const Vertex & v1) {
+    return v0.x == v1.x and v0.y == v1.y and v0.z == v1.z;
+  };
+  auto triangle_equals = [](const Triangle & t0, const Triangle & t1) {
+    return t0.v0 == t1.v0 and t0.v1 == t1.v1 and t0.v2 == t1.v2;
+  };
+  return type == other.type and
+         std::equal(
+           vertices_.begin(), vertices_.end(), other.vertices_.begin(), other.vertices_.end(),
+           equals) and
+         std::equal(
+           triangles_.begin(), triangles_.end(), other.triangles_.begin(), other.triangles_.end(),
+           triangle_equals);
+}
+
 std::optional<double> Primitive::getMax(const math::geometry::Axis & axis) const
 {
   if (vertices_.empty()) {
@@ -0,0 +1,180 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <simple_sensor_simulator/exception.hpp>
+#include <simple_sensor_simulator/sensor_simulation/primitives/triangle_mesh.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace simple_sensor_simulator
+{
+namespace primitives
+{
+TriangleMesh::TriangleMesh(
+  std::vector<Vertex> vertices, std::vector<Triangle> triangles,
+  const geometry_msgs::msg::Pose & pose)
+: Primitive("TriangleMesh", pose)
+{
+  vertices_ = std::move(vertices);
+  triangles_ = std::move(triangles);
+}
+
+namespace
+{
+Vertex toVertex(const lanelet::ConstPoint3d & point)
+{
+  Vertex v;
+  v.x = point.x();
+  v.y = point.y();
+  v.z = point.z();
+  return v;
+}
+
+/// @note Zip the two bounds of a lanelet into a strip, taking the shorter diagonal at each step.
+void addStrip(
+  const lanelet::ConstLineString3d & left, const lanelet::ConstLineString3d & right,
+  std::vector<Vertex> & vertices, std::vector<Triangle> & triangles)
+{
+  if (left.empty() or right.empty() or left.size() + right.size() < 3) {
+    return;
+  }
+  const auto left_begin = static_cast<unsigned int>(vertices.size());
+  for (const auto & point : left) {
+    vertices.push_back(toVertex(point));
+  }
+  const auto right_begin = static_cast<unsigned int>(vertices.size());
+  for (const auto & point : right) {
+    vertices.push_back(toVertex(point));
+  }
+  const auto left_size = static_cast<unsigned int>(left.size());
+  const auto right_size = static_cast<unsigned int>(right.size());
+  auto squared_distance = [&](unsigned int i, unsigned int j) {
+    const auto & l = vertices[left_begin + i];
+    const auto & r = vertices[right_begin + j];
+    return (l.x - r.x) * (l.x - r.x) + (l.y - r.y) * (l.y - r.y) + (l.z - r.z) * (l.z - r.z);
+  };
+  unsigned int i = 0;
+  unsigned int j = 0;
+  while (i + 1 < left_size or j + 1 < right_size) {
+    if (
+      j + 1 == right_size or
+      (i + 1 < left_size and squared_distance(i + 1, j) < squared_distance(i, j + 1))) {
+      triangles.push_back(Triangle{left_begin + i, right_begin + j, left_begin + i + 1});
+      ++i;
+    } else {
+      triangles.push_back(Triangle{left_begin + i, right_begin + j, right_begin + j + 1});
+      ++j;
+    }
+  }
+}
+
+void addWall(
+  const lanelet::ConstLineString3d & line_string, double height, std::vector<Vertex> & vertices,
+  std::vector<Triangle> & triangles)
+{
+  if (line_string.size() < 2) {
+    return;
+  }
+  const auto begin = static_cast<unsigned int>(vertices.size());
+  for (const auto & point : line_string) {
+    auto v = toVertex(point);
+    vertices.push_back(v);
+    v.z += height;
+    vertices.push_back(v);
+  }
+  for (unsigned int k = 0; k + 1 < line_string.size(); ++k) {
+    const auto bottom = begin + 2 * k;
+    triangles.push_back(Triangle{bottom, bottom + 2, bottom + 1});
+    triangles.push_back(Triangle{bottom + 1, bottom + 2, bottom + 3});
+  }
+}
+}  // namespace
+
+TriangleMesh makeRoadMesh(const lanelet::LaneletMap & map, double curb_height)
+{
+  std::vector<Vertex> vertices;
+  std::vector<Triangle> triangles;
+  for (const auto & llt : map.laneletLayer) {
+    addStrip(llt.leftBound(), llt.rightBound(), vertices, triangles);
+  }
+  for (const auto & line_string : map.lineStringLayer) {
+    if (const std::string type = line_string.attributeOr(lanelet::AttributeName::Type, "");
+        type == lanelet::AttributeValueString::RoadBorder or
+        type == lanelet::AttributeValueString::Curbstone) {
+      addWall(line_string, curb_height, vertices, triangles);
+    }
+  }
+  return TriangleMesh(std::move(vertices), std::move(triangles));
+}
+
+TriangleMesh loadMesh(const std::string & path)
+{
+  std::ifstream file(path);
+  if (not file) {
+    throw SimulationRuntimeError(("failed to open the mesh file " + path).c_str());
+  }
+  std::vector<Vertex> vertices;
+  std::vector<Triangle> triangles;
+  std::string line;
+  for (std::size_t line_number = 1; std::getline(file, line); ++line_number) {
+    std::istringstream stream(line);
+    std::string keyword;
+    stream >> keyword;
+    if (keyword == "v") {
+      Vertex v;
+      stream >> v.x >> v.y >> v.z;
+      vertices.push_back(v);
+    } else if (keyword == "f") {
+      std::vector<unsigned int> face;
+      std::string corner;
+      while (stream >> corner) {
+        // the corners are v, v/vt, v/vt/vn or v//vn, counted from 1 or, if negative, from the end
+        const auto invalid_corner = [&]() {
+          return SimulationRuntimeError(
+            ("invalid face corner \"" + corner + "\" at " + path + ":" +
+             std::to_string(line_number))
+              .c_str());
+        };
+        long index;
+        try {
+          index = std::stol(corner.substr(0, corner.find('/')));
+        } catch (const std::invalid_argument &) {
+          throw invalid_corner();
+        } catch (const std::out_of_range &) {
+          throw invalid_corner();
+        }
+        face.push_back(
+          static_cast<unsigned int>(index < 0 ? vertices.size() + index : index - 1));
+      }
+      // polygons are triangulated as fans
+      for (std::size_t k = 1; k + 1 < face.size(); ++k) {
+        triangles.push_back(Triangle{face[0], face[k], face[k + 1]});
+      }
+    }
+  }
+  for (const auto & triangle : triangles) {
+    if (std::max({triangle.v0, triangle.v1, triangle.v2}) >= vertices.size()) {
+      throw SimulationRuntimeError(("invalid vertex index in the mesh file " + path).c_str());
+    }
+  }
+  return TriangleMesh(std::move(vertices), std::move(triangles));
+}
+}  // namespace primitives
+}  // namespace simple_sensor_simulator
@@ -15,6 +15,7 @@
 #include <quaternion_operation/quaternion_operation.h>
 
 #include <algorithm>
+#include <chrono>
 #include <geometry_msgs/msg/pose_stamped.hpp>
 #include <limits>
 #include <memory>
@@ -32,7 +33,7 @@ namespace simple_sensor_simulator
 ScenarioSimulator::ScenarioSimulator(const rclcpp::NodeOptions & options)
 : Node("simple_sensor_simulator", options),
   server_(
-    simulation_interface::protocol, simulation_interface::HostName::ANY, getSocketPort(),
+    getTransportProtocol(), simulation_interface::HostName::ANY, getSocketPort(),
     [this](auto &&... xs) { return initialize(std::forward<decltype(xs)>(xs)...); },
     [this](auto &&... xs) { return updateFrame(std::forward<decltype(xs)>(xs)...); },
     [this](auto &&... xs) { return spawnVehicleEntity(std::forward<decltype(xs)>(xs)...); },
@@ -76,6 +77,15 @@ int ScenarioSimulator::getSocketPort()
   return get_parameter("port").as_int();
 }
 
+simulation_interface::TransportProtocol ScenarioSimulator::getTransportProtocol()
+{
+  if (!has_parameter("transport_protocol")) {
+    declare_parameter<std::string>("transport_protocol", "tcp");
+  }
+  return simulation_interface::stringToTransportProtocol(
+    get_parameter("transport_protocol").as_string());
+}
+
 auto ScenarioSimulator::initialize(const simulation_api_schema::InitializeRequest & req)
   -> simulation_api_schema::InitializeResponse
 {
@@ -87,7 +97,47 @@ auto ScenarioSimulator::initialize(const simulation_api_schema::InitializeReques
   builtin_interfaces::msg::Time t;
   simulation_interface::toMsg(req.initialize_ros_time(), t);
   current_ros_time_ = t;
-  hdmap_utils_ = std::make_shared<hdmap_utils::HdMapUtils>(req.lanelet2_map_path(), getOrigin());
+  if (!has_parameter("share_map")) {
+    declare_parameter("share_map", false);
+  }
+  if (!has_parameter("map_cache_directory")) {
+    declare_parameter<std::string>("map_cache_directory", "");
+  }
+  /// @note Attach to the map precompiled by another process on this host instead of parsing it.
+  hdmap_utils_ =
+    get_parameter("share_map").as_bool()
+      ? hdmap_utils::HdMapUtils::shared(req.lanelet2_map_path(), getOrigin())
+      : std::make_shared<hdmap_utils::HdMapUtils>(
+          req.lanelet2_map_path(), getOrigin(),
+          get_parameter("map_cache_directory").as_string());
+  if (!has_parameter("lidar_map_geometry")) {
+    declare_parameter("lidar_map_geometry", false);
+  }
+  if (!has_parameter("lidar_mesh_path")) {
+    declare_parameter<std::string>("lidar_mesh_path", "");
+  }
+  /// @note Ground and curbs for the lidar returns, built once here since the map does not change.
+  const auto begin = std::chrono::steady_clock::now();
+  std::vector<std::shared_ptr<const primitives::Primitive>> lidar_static_primitives;
+  if (get_parameter("lidar_map_geometry").as_bool()) {
+    lidar_static_primitives.push_back(std::make_shared<primitives::TriangleMesh>(
+      primitives::makeRoadMesh(*hdmap_utils_->getLaneletMap())));
+  }
+  if (const auto path = get_parameter("lidar_mesh_path").as_string(); not path.empty()) {
+    lidar_static_primitives.push_back(
+      std::make_shared<primitives::TriangleMesh>(primitives::loadMesh(path)));
+  }
+  lidar_static_scene_ = nullptr;
+  if (not lidar_static_primitives.empty()) {
+    lidar_static_scene_ = std::make_shared<StaticScene>(lidar_static_primitives);
+    std::size_t triangle_count = 0;
+    for (const auto & primitive : lidar_static_primitives) {
+      triangle_count += primitive->getTriangles().size();
+    }
+    RCLCPP_INFO(
+      get_logger(), "Built %zu triangles of static lidar geometry in %.1f ms", triangle_count,
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count());
+  }
   auto res = simulation_api_schema::InitializeResponse();
   res.mutable_result()->set_success(true);
   res.mutable_result()->set_description("succeed to initialize simulation");
@@ -96,6 +146,7 @@ auto ScenarioSimulator::initialize(const simulation_api_schema::InitializeReques
   pedestrians_.clear();
   misc_objects_.clear();
   entity_status_.clear();
+  entity_names_.clear();
   return res;
 }
 
@@ -144,26 +195,68 @@ auto ScenarioSimulator::updateEntityStatus(
     updated_status->mutable_action_status()->CopyFrom(status.action_status());
     updated_status->mutable_pose()->CopyFrom(status.pose());
   };
+  /// @note Only the ego is changed by the simulator, so it is the only delta in the response.
+  auto copyStatusToDeltaResponse =
+    [&](const simulation_api_schema::EntityStatus & status, std::uint32_t id) {
+      auto delta = res.add_status_delta();
+      delta->set_id(id);
+      delta->mutable_action_status()->CopyFrom(status.action_status());
+      delta->mutable_pose()->CopyFrom(status.pose());
+    };
+  auto updateEgo = [&](const std::string & name) -> const simulation_api_schema::EntityStatus & {
+    assert(ego_entity_simulation_ && "Ego is spawned but ego_entity_simulation_ is nullptr!");
+    ego_entity_simulation_->update(
+      current_scenario_time_ + step_time_, step_time_, req.npc_logic_started());
+    auto & ego_status = entity_status_.at(name);
+    simulation_interface::toProto(ego_entity_simulation_->getStatus(), ego_status);
+    return ego_status;
+  };
 
   for (const auto & status : req.status()) {
     try {
+      if (status.id() != 0) {
+        if (entity_names_.size() <= status.id()) {
+          entity_names_.resize(status.id() + 1);
+        }
+        entity_names_[status.id()] = status.name();
+      }
       if (isEgo(status.name())) {
-        assert(ego_entity_simulation_ && "Ego is spawned but ego_entity_simulation_ is nullptr!");
-        ego_entity_simulation_->update(
-          current_scenario_time_ + step_time_, step_time_, req.npc_logic_started());
-        simulation_api_schema::EntityStatus ego_status;
-        simulation_interface::toProto(ego_entity_simulation_->getStatus(), ego_status);
-        entity_status_.at(status.name()) = ego_status;
-        copyStatusToResponse(ego_status);
+        const auto & ego_status = updateEgo(status.name());
+        if (status.id() != 0) {
+          copyStatusToDeltaResponse(ego_status, status.id());
+        } else {
+          copyStatusToResponse(ego_status);
+        }
       } else {
         entity_status_.at(status.name()) = status;
-        copyStatusToResponse(status);
+        if (status.id() == 0) {
+          copyStatusToResponse(status);
+        }
       }
     } catch (const std::out_of_range & e) {
       THROW_SEMANTIC_ERROR("Entity ", std::quoted(status.name()), " does not exist");
     }
   }
 
+  for (const auto & delta : req.status_delta()) {
+    if (entity_names_.size() <= delta.id() or entity_names_[delta.id()].empty()) {
+      THROW_SEMANTIC_ERROR("Entity of id ", delta.id(), " does not exist");
+    }
+    const auto & name = entity_names_[delta.id()];
+    if (isEgo(name)) {
+      copyStatusToDeltaResponse(updateEgo(name), delta.id());
+    } else {
+      auto & status = entity_status_.at(name);
+      status.set_time(delta.time());
+      if (delta.has_action_status()) {
+        *status.mutable_action_status() = delta.action_status();
+      }
+      if (delta.has_pose()) {
+        *status.mutable_pose() = delta.pose();
+      }
+    }
+  }
+
   res.mutable_result()->set_success(true);
   res.mutable_result()->set_description("");
   return res;
@@ -265,6 +358,7 @@ auto ScenarioSimulator::despawnEntity(const simulation_api_schema::DespawnEntity
                                       remove_despawn_requested_entity_from(misc_objects_);
   if (any_entity_was_removed) {
     entity_status_.erase(req.name());
+    std::replace(entity_names_.begin(), entity_names_.end(), req.name(), std::string());
   }
   auto res = simulation_api_schema::DespawnEntityResponse();
   res.mutable_result()->set_success(any_entity_was_removed);
@@ -285,7 +379,8 @@ auto ScenarioSimulator::attachLidarSensor(
   const simulation_api_schema::AttachLidarSensorRequest & req)
   -> simulation_api_schema::AttachLidarSensorResponse
 {
-  sensor_sim_.attachLidarSensor(current_simulation_time_, req.configuration(), *this);
+  sensor_sim_.attachLidarSensor(
+    current_simulation_time_, req.configuration(), *this, lidar_static_scene_);
   auto res = simulation_api_schema::AttachLidarSensorResponse();
   res.mutable_result()->set_success(true);
   return res;
@@ -305,7 +400,21 @@ auto ScenarioSimulator::updateTrafficLights(
   const simulation_api_schema::UpdateTrafficLightsRequest & req)
   -> simulation_api_schema::UpdateTrafficLightsResponse
 {
-  traffic_signals_states_ = req;
+  if (req.only_changed()) {
+    auto & states = *traffic_signals_states_.mutable_states();
+    for (const auto & changed : req.states()) {
+      if (auto iter = std::find_if(
+            std::begin(states), std::end(states),
+            [&](const auto & state) { return state.id() == changed.id(); });
+          iter != std::end(states)) {
+        *iter = changed;
+      } else {
+        *states.Add() = changed;
+      }
+    }
+  } else {
+    traffic_signals_states_ = req;
+  }
   auto res = simulation_api_schema::UpdateTrafficLightsResponse();
   res.mutable_result()->set_success(true);
   return res;
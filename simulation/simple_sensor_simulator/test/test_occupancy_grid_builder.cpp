@@ -0,0 +1,163 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <simple_sensor_simulator/sensor_simulation/occupancy_grid/imos.hpp>
+#include <simple_sensor_simulator/sensor_simulation/occupancy_grid/occupancy_grid_builder.hpp>
+#include <thread>
+#include <vector>
+
+using simple_sensor_simulator::OccupancyGridBuilder;
+
+auto makePose(double x, double y, double yaw = 0.0) -> geometry_msgs::msg::Pose
+{
+  geometry_msgs::msg::Pose pose;
+  pose.position.x = x;
+  pose.position.y = y;
+  pose.orientation.z = std::sin(yaw / 2);
+  pose.orientation.w = std::cos(yaw / 2);
+  return pose;
+}
+
+/// @note NPCs on circles around the sensor.
+auto addEntities(OccupancyGridBuilder & builder, std::size_t count) -> void
+{
+  for (std::size_t i = 0; i < count; ++i) {
+    const auto radius = 8.0 + 4.0 * static_cast<double>(i % 8);
+    const auto angle = 2.0 * M_PI * static_cast<double>(i) / count;
+    builder.add(simple_sensor_simulator::primitives::Box(
+      4.0, 2.0, 1.5, makePose(radius * std::cos(angle), radius * std::sin(angle), angle)));
+  }
+}
+
+TEST(OccupancyGridBuilder, PrefixSum)
+{
+  std::mt19937 engine(0);
+  std::uniform_int_distribution<int16_t> distribution(-3, 3);
+  for (std::size_t size = 0; size < 100; ++size) {
+    std::vector<int16_t> values(size);
+    std::generate(values.begin(), values.end(), [&]() { return distribution(engine); });
+    auto expected = values;
+    simple_sensor_simulator::prefixSumScalar(expected.data(), expected.size());
+    simple_sensor_simulator::prefixSum(values.data(), values.size());
+    EXPECT_EQ(values, expected) << "size " << size;
+  }
+}
+
+TEST(OccupancyGridBuilder, BuildRow)
+{
+  std::mt19937 engine(0);
+  std::uniform_int_distribution<int16_t> distribution(-1, 1);
+  for (std::size_t size = 0; size < 100; ++size) {
+    std::vector<int16_t> occupied(size), invisible(size);
+    std::generate(occupied.begin(), occupied.end(), [&]() { return distribution(engine); });
+    std::generate(invisible.begin(), invisible.end(), [&]() { return distribution(engine); });
+    auto expected_occupied = occupied;
+    auto expected_invisible = invisible;
+    std::vector<int8_t> values(size), expected_values(size);
+    simple_sensor_simulator::buildRowScalar(
+      expected_occupied.data(), expected_invisible.data(), expected_values.data(), size, 100, 50);
+    simple_sensor_simulator::buildRow(
+      occupied.data(), invisible.data(), values.data(), size, 100, 50);
+    EXPECT_EQ(occupied, expected_occupied) << "size " << size;
+    EXPECT_EQ(invisible, expected_invisible) << "size " << size;
+    EXPECT_EQ(values, expected_values) << "size " << size;
+  }
+}
+
+TEST(OccupancyGridBuilder, Build)
+{
+  OccupancyGridBuilder builder(0.1, 400, 400);
+  builder.reset(makePose(0.0, 0.0));
+  builder.add(simple_sensor_simulator::primitives::Box(4.0, 2.0, 1.5, makePose(10.0, 0.0)));
+  builder.build();
+  /// @note The box covers the columns 280 to 320 of the rows 190 to 210.
+  const auto & grid = builder.get();
+  EXPECT_EQ(grid[200 * 400 + 250], 0);
+  EXPECT_EQ(grid[200 * 400 + 300], 100);
+  EXPECT_EQ(grid[200 * 400 + 380], 50);
+  EXPECT_EQ(grid[100 * 400 + 300], 0);
+}
+
+TEST(OccupancyGridBuilder, ParallelBuild)
+{
+  OccupancyGridBuilder builder(0.1, 1000, 1000);
+  OccupancyGridBuilder parallel_builder(0.1, 1000, 1000, 100, 50, 4);
+  for (auto * b : {&builder, &parallel_builder}) {
+    b->reset(makePose(0.0, 0.0));
+    addEntities(*b, 50);
+    b->build();
+  }
+  EXPECT_EQ(builder.get(), parallel_builder.get());
+}
+
+/// @brief Time per frame of adding 50 entities, of building the grid, and of each row kernel.
+TEST(OccupancyGridBuilder, DISABLED_FrameTime)
+{
+  constexpr int frame_count = 20;
+  std::vector<std::size_t> thread_counts = {1};
+  if (const auto physical_cores = std::thread::hardware_concurrency() / 2; physical_cores > 1) {
+    thread_counts.push_back(physical_cores);
+  }
+  auto milliseconds = [](auto begin) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin)
+      .count();
+  };
+  std::cout << "kernels: " << simple_sensor_simulator::imosInstructionSet() << std::endl;
+  for (const std::size_t size : {400, 1000, 2000}) {
+    std::vector<int16_t> occupied(size * size), invisible(size * size);
+    std::vector<int8_t> values(size * size);
+    for (const auto build_row :
+         {simple_sensor_simulator::buildRowScalar, simple_sensor_simulator::buildRow}) {
+      const auto begin = std::chrono::steady_clock::now();
+      for (int frame = 0; frame < frame_count; ++frame) {
+        for (std::size_t row = 0; row < size; ++row) {
+          build_row(
+            occupied.data() + row * size, invisible.data() + row * size,
+            values.data() + row * size, size, 100, 50);
+        }
+      }
+      std::cout << size << "x" << size << ", "
+                << (build_row == simple_sensor_simulator::buildRow ? "vectorized" : "scalar")
+                << " kernel: " << milliseconds(begin) / frame_count << " ms per frame"
+                << std::endl;
+    }
+    for (const double resolution : {0.1, 0.5}) {
+      for (const auto thread_count : thread_counts) {
+        OccupancyGridBuilder builder(resolution, size, size, 100, 50, thread_count);
+        double add_time = 0.0;
+        double build_time = 0.0;
+        for (int frame = 0; frame < frame_count; ++frame) {
+          const auto begin = std::chrono::steady_clock::now();
+          builder.reset(makePose(0.0, 0.0));
+          addEntities(builder, 50);
+          add_time += milliseconds(begin);
+          const auto build_begin = std::chrono::steady_clock::now();
+          builder.build();
+          build_time += milliseconds(build_begin);
+        }
+        std::cout << size << "x" << size << ", " << resolution << " m, " << thread_count
+                  << " threads: " << add_time / frame_count << " ms to add, "
+                  << build_time / frame_count << " ms to build per frame" << std::endl;
+      }
+    }
+  }
+}
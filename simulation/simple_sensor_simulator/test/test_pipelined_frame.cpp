@@ -0,0 +1,219 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <rclcpp/rclcpp.hpp>
+#include <simple_sensor_simulator/sensor_simulation/sensor_simulation.hpp>
+#include <simulation_interface/zmq_multi_client.hpp>
+#include <simulation_interface/zmq_multi_server.hpp>
+#include <string>
+#include <traffic_simulator/helper/helper.hpp>
+#include <vector>
+
+constexpr unsigned int port = 5564;
+
+constexpr double step_time = 0.05;
+
+/// @note Time the entities take to update in a frame, standing in for the traffic simulator.
+constexpr auto entity_update_duration = std::chrono::milliseconds(10);
+
+/**
+ * @brief Simulator updating a lidar and an occupancy grid sensor attached to the ego with the
+ * entity status it is sent, shut down with rclcpp after the last test, since MultiServer polls
+ * until rclcpp::ok() is false.
+ */
+class Server : public testing::Environment
+{
+public:
+  auto SetUp() -> void override
+  {
+    namespace schema = simulation_api_schema;
+    node_ = std::make_shared<rclcpp::Node>("test_pipelined_frame");
+
+    sensor_simulation_.attachLidarSensor(
+      0.0,
+      traffic_simulator::helper::constructLidarConfiguration(
+        traffic_simulator::helper::LidarType::VLP16, "ego", "awf/universe"),
+      *node_);
+
+    schema::OccupancyGridSensorConfiguration occupancy_grid_configuration;
+    occupancy_grid_configuration.set_entity("ego");
+    occupancy_grid_configuration.set_architecture_type("awf/universe");
+    occupancy_grid_configuration.set_update_duration(step_time);
+    occupancy_grid_configuration.set_resolution(0.5);
+    occupancy_grid_configuration.set_width(200);
+    occupancy_grid_configuration.set_height(200);
+    occupancy_grid_configuration.set_range(300.0);
+    sensor_simulation_.attachOccupancyGridSensor(0.0, occupancy_grid_configuration, *node_);
+
+    auto fail = [](auto response) {
+      response.mutable_result()->set_success(false);
+      return response;
+    };
+    server_ = std::make_unique<zeromq::MultiServer>(
+      simulation_interface::protocol, simulation_interface::HostName::ANY, port,
+      [=](const auto &) { return fail(schema::InitializeResponse()); },
+      [this](const schema::UpdateFrameRequest & request) {
+        sensor_simulation_.updateSensorFrame(
+          request.current_simulation_time(), node_->now(), entity_status_,
+          schema::UpdateTrafficLightsRequest());
+        schema::UpdateFrameResponse response;
+        response.mutable_result()->set_success(true);
+        return response;
+      },
+      [=](const auto &) { return fail(schema::SpawnVehicleEntityResponse()); },
+      [=](const auto &) { return fail(schema::SpawnPedestrianEntityResponse()); },
+      [=](const auto &) { return fail(schema::SpawnMiscObjectEntityResponse()); },
+      [=](const auto &) { return fail(schema::DespawnEntityResponse()); },
+      [this](const schema::UpdateEntityStatusRequest & request) {
+        entity_status_.clear();
+        for (const auto & status : request.status()) {
+          traffic_simulator_msgs::EntityStatus entity_status;
+          *entity_status.mutable_name() = status.name();
+          *entity_status.mutable_type() = status.type();
+          *entity_status.mutable_pose() = status.pose();
+          *entity_status.mutable_bounding_box()->mutable_dimensions() = dimensions();
+          entity_status_.push_back(entity_status);
+        }
+        schema::UpdateEntityStatusResponse response;
+        response.mutable_result()->set_success(true);
+        return response;
+      },
+      [=](const auto &) { return fail(schema::AttachLidarSensorResponse()); },
+      [=](const auto &) { return fail(schema::AttachDetectionSensorResponse()); },
+      [=](const auto &) { return fail(schema::AttachOccupancyGridSensorResponse()); },
+      [=](const auto &) { return fail(schema::UpdateTrafficLightsResponse()); },
+      [=](const auto &) { return fail(schema::FollowPolylineTrajectoryResponse()); },
+      [=](const auto &) { return fail(schema::AttachPseudoTrafficLightDetectorResponse()); });
+  }
+
+  auto TearDown() -> void override
+  {
+    rclcpp::shutdown();
+    server_.reset();
+  }
+
+  static auto dimensions() -> geometry_msgs::Vector3
+  {
+    geometry_msgs::Vector3 dimensions;
+    dimensions.set_x(4.0);
+    dimensions.set_y(2.0);
+    dimensions.set_z(1.5);
+    return dimensions;
+  }
+
+private:
+  std::shared_ptr<rclcpp::Node> node_;
+
+  simple_sensor_simulator::SensorSimulation sensor_simulation_;
+
+  std::vector<traffic_simulator_msgs::EntityStatus> entity_status_;
+
+  std::unique_ptr<zeromq::MultiServer> server_;
+};
+
+/// @note The ego at the origin and NPCs on circles around it, moving along them with the time.
+auto makeEntityStatusRequest(double time, std::size_t npc_count)
+  -> simulation_api_schema::UpdateEntityStatusRequest
+{
+  simulation_api_schema::UpdateEntityStatusRequest request;
+  request.set_npc_logic_started(true);
+  auto ego = request.add_status();
+  ego->set_name("ego");
+  ego->mutable_type()->set_type(traffic_simulator_msgs::EntityType::EGO);
+  ego->mutable_pose()->mutable_orientation()->set_w(1.0);
+  for (std::size_t i = 0; i < npc_count; ++i) {
+    const auto radius = 10.0 + 5.0 * static_cast<double>(i % 6);
+    const auto angle = 2.0 * M_PI * static_cast<double>(i) / npc_count + 0.1 * time;
+    auto npc = request.add_status();
+    npc->set_name("npc" + std::to_string(i));
+    npc->mutable_type()->set_type(traffic_simulator_msgs::EntityType::VEHICLE);
+    npc->mutable_pose()->mutable_position()->set_x(radius * std::cos(angle));
+    npc->mutable_pose()->mutable_position()->set_y(radius * std::sin(angle));
+    npc->mutable_pose()->mutable_orientation()->set_w(1.0);
+  }
+  return request;
+}
+
+auto makeUpdateFrameRequest(double time) -> simulation_api_schema::UpdateFrameRequest
+{
+  simulation_api_schema::UpdateFrameRequest request;
+  request.set_current_simulation_time(time);
+  request.set_current_scenario_time(time);
+  return request;
+}
+
+auto updateEntities() -> void
+{
+  const auto end = std::chrono::steady_clock::now() + entity_update_duration;
+  while (std::chrono::steady_clock::now() < end) {
+  }
+}
+
+/// @brief Time per frame of API::updateFrame waiting for the sensors and pipelined with them.
+TEST(PipelinedFrame, DISABLED_FrameTime)
+{
+  zeromq::MultiClient client(simulation_interface::protocol, "localhost", port);
+  constexpr int frame_count = 200;
+  constexpr std::size_t npc_count = 30;
+
+  auto measure = [&](auto && frame) {
+    const auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < frame_count; ++i) {
+      frame(i * step_time);
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin)
+             .count() /
+           frame_count;
+  };
+
+  const auto synchronous = measure([&](double time) {
+    EXPECT_TRUE(client.call(makeEntityStatusRequest(time, npc_count)).result().success());
+    updateEntities();
+    EXPECT_TRUE(client.call(makeUpdateFrameRequest(time)).result().success());
+  });
+
+  std::future<simulation_api_schema::UpdateEntityStatusResponse> entity_status_response;
+  std::future<simulation_api_schema::UpdateFrameResponse> update_frame_response;
+  const auto pipelined = measure([&](double time) {
+    if (entity_status_response.valid()) {
+      EXPECT_TRUE(entity_status_response.get().result().success());
+    }
+    entity_status_response = client.callAsync(makeEntityStatusRequest(time, npc_count));
+    updateEntities();
+    if (update_frame_response.valid()) {
+      EXPECT_TRUE(update_frame_response.get().result().success());
+    }
+    update_frame_response = client.callAsync(makeUpdateFrameRequest(time));
+  });
+  EXPECT_TRUE(update_frame_response.get().result().success());
+
+  std::cout << npc_count << " NPCs with lidar and occupancy grid: " << synchronous
+            << " ms per frame synchronous, " << pipelined << " ms per frame pipelined"
+            << std::endl;
+}
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+  testing::InitGoogleTest(&argc, argv);
+  testing::AddGlobalTestEnvironment(new Server());
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,358 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <lanelet2_core/LaneletMap.h>
+#include <memory>
+#include <new>
+#include <sensor_msgs/point_cloud2_iterator.hpp>
+#include <simple_sensor_simulator/exception.hpp>
+#include <simple_sensor_simulator/sensor_simulation/lidar/raycaster.hpp>
+#include <simple_sensor_simulator/sensor_simulation/primitives/triangle_mesh.hpp>
+#include <string>
+#include <vector>
+
+constexpr double step_time = 0.05;
+
+/// @note Every allocation of this process, for the allocation counts printed by the benchmarks.
+std::atomic<std::size_t> allocation_count{0};
+
+void * operator new(std::size_t size)
+{
+  ++allocation_count;
+  if (void * pointer = std::malloc(size == 0 ? 1 : size)) {
+    return pointer;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void * pointer) noexcept { std::free(pointer); }
+
+void operator delete(void * pointer, std::size_t) noexcept { std::free(pointer); }
+
+/// @note Channels spread from -25 to +15 degrees, 1800 rays per channel.
+auto makeLidarConfiguration(int channel_count) -> simulation_api_schema::LidarConfiguration
+{
+  simulation_api_schema::LidarConfiguration configuration;
+  configuration.set_horizontal_resolution(2.0 * M_PI / 1800);
+  for (int i = 0; i < channel_count; ++i) {
+    configuration.add_vertical_angles((-25.0 + 40.0 * i / (channel_count - 1)) * M_PI / 180.0);
+  }
+  return configuration;
+}
+
+auto makePose(double x, double y) -> geometry_msgs::msg::Pose
+{
+  geometry_msgs::msg::Pose pose;
+  pose.position.x = x;
+  pose.position.y = y;
+  pose.orientation.w = 1.0;
+  return pose;
+}
+
+/// @note NPCs on circles around the sensor, moving along them with the time.
+auto addEntities(simple_sensor_simulator::Raycaster & raycaster, std::size_t count, double time)
+  -> void
+{
+  for (std::size_t i = 0; i < count; ++i) {
+    const auto radius = 10.0 + 5.0 * static_cast<double>(i % 10);
+    const auto angle = 2.0 * M_PI * static_cast<double>(i) / count + 0.1 * time;
+    raycaster.addPrimitive<simple_sensor_simulator::primitives::Box>(
+      "npc" + std::to_string(i), 4.0, 2.0, 1.5,
+      makePose(radius * std::cos(angle), radius * std::sin(angle)));
+  }
+}
+
+/**
+ * @brief Straight lanes of 3.5 m side by side, split into lanelets of 10 m with a point every
+ * metre, 1.5 m below the sensor. The outer bounds are road borders.
+ */
+auto makeRoadMap(std::size_t lane_count, std::size_t lanelet_count) -> lanelet::LaneletMapPtr
+{
+  auto map = std::make_shared<lanelet::LaneletMap>();
+  lanelet::Id id = 1;
+  auto makeBound = [&](double x, double y) {
+    lanelet::LineString3d bound(id++);
+    for (int i = 0; i <= 10; ++i) {
+      bound.push_back(lanelet::Point3d(id++, x + i, y, -1.5));
+    }
+    return bound;
+  };
+  for (std::size_t lane = 0; lane < lane_count; ++lane) {
+    for (std::size_t i = 0; i < lanelet_count; ++i) {
+      const auto x = 10.0 * (static_cast<double>(i) - 0.5 * lanelet_count);
+      const auto y = 3.5 * (static_cast<double>(lane) - 0.5 * lane_count);
+      auto left = makeBound(x, y + 3.5);
+      auto right = makeBound(x, y);
+      using lanelet::AttributeName;
+      using lanelet::AttributeValueString;
+      if (lane + 1 == lane_count) {
+        left.attributes()[AttributeName::Type] = AttributeValueString::RoadBorder;
+      }
+      if (lane == 0) {
+        right.attributes()[AttributeName::Type] = AttributeValueString::RoadBorder;
+      }
+      map->add(lanelet::Lanelet(id++, left, right));
+    }
+  }
+  return map;
+}
+
+TEST(Raycaster, UpdateInstances)
+{
+  simple_sensor_simulator::Raycaster raycaster;
+  raycaster.setDirection(makeLidarConfiguration(16));
+  /// @note An entity hit by the rays of several threads is detected once.
+  const auto detected = [&]() {
+    raycaster.raycast("base_link", rclcpp::Time(), makePose(0.0, 0.0));
+    return raycaster.getDetectedObject();
+  };
+
+  raycaster.addPrimitive<simple_sensor_simulator::primitives::Box>(
+    "npc", 4.0, 2.0, 1.5, makePose(10.0, 0.0));
+  EXPECT_EQ(detected(), std::vector<std::string>({"npc"}));
+
+  raycaster.addPrimitive<simple_sensor_simulator::primitives::Box>(
+    "npc", 4.0, 2.0, 1.5, makePose(1000.0, 0.0));
+  EXPECT_TRUE(detected().empty());
+
+  raycaster.addPrimitive<simple_sensor_simulator::primitives::Box>(
+    "npc", 4.0, 2.0, 20.0, makePose(10.0, 0.0));
+  EXPECT_EQ(detected(), std::vector<std::string>({"npc"}));
+
+  raycaster.addPrimitive<simple_sensor_simulator::primitives::Box>(
+    "npc0", 4.0, 2.0, 1.5, makePose(10.0, 0.0));
+  raycaster.addPrimitive<simple_sensor_simulator::primitives::Box>(
+    "npc1", 4.0, 2.0, 1.5, makePose(-10.0, 0.0));
+  auto objects = detected();
+  std::sort(objects.begin(), objects.end());
+  EXPECT_EQ(objects, std::vector<std::string>({"npc0", "npc1"}));
+
+  EXPECT_TRUE(detected().empty());
+}
+
+TEST(Raycaster, RoadMesh)
+{
+  const auto mesh = simple_sensor_simulator::primitives::makeRoadMesh(*makeRoadMap(1, 1));
+  /// @note 20 triangles between the bounds, and 2 walls of 10 segments of 2 triangles.
+  EXPECT_EQ(mesh.getTriangles().size(), 20u + 2u * 10u * 2u);
+  EXPECT_EQ(mesh.getVertex().size(), 22u + 2u * 11u * 2u);
+}
+
+TEST(Raycaster, LoadMesh)
+{
+  const std::string path = testing::TempDir() + "test_raycaster.obj";
+  {
+    std::ofstream file(path);
+    file << "# a quad and a triangle\n"
+         << "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+         << "f 1/1/1 2/2/1 3/3/1 4/4/1\n"
+         << "f -4//1 -3//1 -1//1\n";
+  }
+  const auto mesh = simple_sensor_simulator::primitives::loadMesh(path);
+  EXPECT_EQ(mesh.getVertex().size(), 4u);
+  ASSERT_EQ(mesh.getTriangles().size(), 3u);
+  EXPECT_EQ(mesh.getTriangles()[1].v2, 3u);
+  EXPECT_EQ(mesh.getTriangles()[2].v2, 3u);
+  {
+    std::ofstream file(path);
+    file << "v 0 0 0\nv 1 0 0\nv 1 1 0\n"
+         << "f 1 2 x\n";
+  }
+  try {
+    simple_sensor_simulator::primitives::loadMesh(path);
+    ADD_FAILURE() << "an invalid face corner was loaded";
+  } catch (const simple_sensor_simulator::SimulationRuntimeError & error) {
+    EXPECT_NE(std::string(error.what()).find(path + ":4"), std::string::npos) << error.what();
+  }
+  {
+    std::ofstream file(path);
+    file << "v 0 0 0\nv 1 0 0\nv 1 1 0\n"
+         << "f 1 2 99999999999999999999\n";
+  }
+  EXPECT_THROW(
+    simple_sensor_simulator::primitives::loadMesh(path),
+    simple_sensor_simulator::SimulationRuntimeError);
+  std::remove(path.c_str());
+}
+
+TEST(Raycaster, StaticGeometry)
+{
+  const auto static_scene = std::make_shared<simple_sensor_simulator::StaticScene>(
+    std::vector<std::shared_ptr<const simple_sensor_simulator::primitives::Primitive>>{
+      std::make_shared<simple_sensor_simulator::primitives::TriangleMesh>(
+        simple_sensor_simulator::primitives::makeRoadMesh(*makeRoadMap(4, 8)))});
+  const auto point_count = [](auto & raycaster) {
+    const auto cloud = raycaster.raycast("base_link", rclcpp::Time(), makePose(0.0, 0.0));
+    return cloud.width * cloud.height;
+  };
+  simple_sensor_simulator::Raycaster without_static_scene;
+  without_static_scene.setDirection(makeLidarConfiguration(16));
+  EXPECT_EQ(point_count(without_static_scene), 0u);
+
+  /// @note Two lidars share the static scene. The downward channels hit the road, which is not
+  /// detected as an object.
+  simple_sensor_simulator::Raycaster raycaster(static_scene), other_raycaster(static_scene);
+  raycaster.setDirection(makeLidarConfiguration(16));
+  other_raycaster.setDirection(makeLidarConfiguration(16));
+  const auto road_point_count = point_count(raycaster);
+  EXPECT_GT(road_point_count, 0u);
+  EXPECT_EQ(point_count(other_raycaster), road_point_count);
+  EXPECT_TRUE(raycaster.getDetectedObject().empty());
+
+  raycaster.addPrimitive<simple_sensor_simulator::primitives::Box>(
+    "npc", 4.0, 2.0, 1.5, makePose(10.0, 0.0));
+  EXPECT_GT(point_count(raycaster), 0u);
+  EXPECT_EQ(raycaster.getDetectedObject(), std::vector<std::string>({"npc"}));
+  EXPECT_EQ(point_count(other_raycaster), road_point_count);
+  EXPECT_TRUE(other_raycaster.getDetectedObject().empty());
+}
+
+/// @brief Time of building the static map geometry, and of a raycast with and without it.
+TEST(Raycaster, DISABLED_StaticGeometryTime)
+{
+  constexpr int frame_count = 20;
+  for (const std::size_t lanelet_count : {100, 1000}) {
+    const auto map = makeRoadMap(4, lanelet_count);
+    auto measure = [&](auto && f) {
+      const auto begin = std::chrono::steady_clock::now();
+      f();
+      return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin)
+        .count();
+    };
+    auto frames = [&](auto & raycaster) {
+      raycaster.setDirection(makeLidarConfiguration(128));
+      double time = 0.0;
+      for (int i = 0; i < frame_count; ++i) {
+        addEntities(raycaster, 50, i * step_time);
+        time += measure(
+          [&]() { raycaster.raycast("base_link", rclcpp::Time(), makePose(0.0, 0.0)); });
+      }
+      return time / frame_count;
+    };
+    simple_sensor_simulator::Raycaster raycaster;
+    const auto without_static_geometry = frames(raycaster);
+    std::size_t triangle_count = 0;
+    std::shared_ptr<simple_sensor_simulator::StaticScene> static_scene;
+    const auto build = measure([&]() {
+      const auto mesh = std::make_shared<simple_sensor_simulator::primitives::TriangleMesh>(
+        simple_sensor_simulator::primitives::makeRoadMesh(*map));
+      triangle_count = mesh->getTriangles().size();
+      static_scene = std::make_shared<simple_sensor_simulator::StaticScene>(
+        std::vector<std::shared_ptr<const simple_sensor_simulator::primitives::Primitive>>{mesh});
+    });
+    simple_sensor_simulator::Raycaster static_raycaster(static_scene);
+    const auto with_static_geometry = frames(static_raycaster);
+    std::cout << 4 * lanelet_count << " lanelets, " << triangle_count << " triangles: " << build
+              << " ms to build, " << with_static_geometry << " ms per frame with it, "
+              << without_static_geometry << " ms per frame without it" << std::endl;
+  }
+}
+
+TEST(Raycaster, ReusePointCloud)
+{
+  simple_sensor_simulator::Raycaster raycaster;
+  raycaster.setDirection(makeLidarConfiguration(16));
+  sensor_msgs::msg::PointCloud2 pointcloud;
+  auto raycast = [&]() {
+    raycaster.addPrimitive<simple_sensor_simulator::primitives::Box>(
+      "npc", 4.0, 2.0, 1.5, makePose(10.0, 0.0));
+    raycaster.raycast(pointcloud, "base_link", rclcpp::Time(), makePose(0.0, 0.0));
+  };
+  raycast();
+  ASSERT_GT(pointcloud.width, 0u);
+  EXPECT_EQ(pointcloud.data.size(), pointcloud.width * pointcloud.point_step);
+  /// @note Every ray hits the face of the box towards the sensor.
+  for (sensor_msgs::PointCloud2ConstIterator<float> x(pointcloud, "x"); x != x.end(); ++x) {
+    EXPECT_NEAR(*x, 8.0, 1e-3);
+  }
+  const auto data = pointcloud.data.data();
+  const auto width = pointcloud.width;
+  raycast();
+  EXPECT_EQ(pointcloud.data.data(), data);
+  EXPECT_EQ(pointcloud.width, width);
+}
+
+/// @brief Time and allocations per raycast into a new message and into a reused one.
+TEST(Raycaster, DISABLED_PointCloudTime)
+{
+  constexpr int frame_count = 20;
+  for (const int channel_count : {32, 128}) {
+    simple_sensor_simulator::Raycaster raycaster;
+    raycaster.setDirection(makeLidarConfiguration(channel_count));
+    sensor_msgs::msg::PointCloud2 pointcloud;
+    // build the scene and size the message before measuring
+    addEntities(raycaster, 50, 0.0);
+    raycaster.raycast(pointcloud, "base_link", rclcpp::Time(), makePose(0.0, 0.0));
+    auto measure = [&](auto && raycast) {
+      double time = 0.0;
+      std::size_t allocations = 0;
+      for (int i = 0; i < frame_count; ++i) {
+        addEntities(raycaster, 50, i * step_time);
+        const auto begin = std::chrono::steady_clock::now();
+        const std::size_t allocation_count_begin = allocation_count;
+        raycast();
+        allocations += allocation_count - allocation_count_begin;
+        time += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin)
+                  .count();
+      }
+      return std::make_pair(time / frame_count, static_cast<double>(allocations) / frame_count);
+    };
+    const auto [new_time, new_allocations] = measure(
+      [&]() { return raycaster.raycast("base_link", rclcpp::Time(), makePose(0.0, 0.0)); });
+    const auto [reused_time, reused_allocations] = measure([&]() {
+      raycaster.raycast(pointcloud, "base_link", rclcpp::Time(), makePose(0.0, 0.0));
+    });
+    std::cout << channel_count << " channels: " << new_time << " ms and " << new_allocations
+              << " allocations per frame with a new message, " << reused_time << " ms and "
+              << reused_allocations << " allocations per frame with the message reused"
+              << std::endl;
+  }
+}
+
+/// @brief Time of the first raycast, which builds the scene, and of the following ones.
+TEST(Raycaster, DISABLED_FrameTime)
+{
+  constexpr int frame_count = 20;
+  for (const int channel_count : {32, 128}) {
+    for (const std::size_t entity_count : {50, 300}) {
+      simple_sensor_simulator::Raycaster raycaster;
+      raycaster.setDirection(makeLidarConfiguration(channel_count));
+      auto raycast = [&](double time) {
+        addEntities(raycaster, entity_count, time);
+        const auto begin = std::chrono::steady_clock::now();
+        raycaster.raycast("base_link", rclcpp::Time(), makePose(0.0, 0.0));
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin)
+          .count();
+      };
+      const auto first_frame = raycast(0.0);
+      double frames = 0.0;
+      for (int i = 1; i <= frame_count; ++i) {
+        frames += raycast(i * step_time);
+      }
+      std::cout << channel_count << " channels, " << entity_count << " entities: " << first_frame
+                << " ms for the first frame, " << frames / frame_count
+                << " ms per frame after it" << std::endl;
+    }
+  }
+}
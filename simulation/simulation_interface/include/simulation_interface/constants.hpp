@@ -19,10 +19,13 @@
 
 namespace simulation_interface
 {
-enum class TransportProtocol { TCP /*, UDP*/ };
+/// @note SHARED_MEMORY connects two processes on the same host, see SharedMemoryChannel.
+enum class TransportProtocol { TCP, SHARED_MEMORY /*, UDP*/ };
 
 std::string enumToString(const TransportProtocol & protocol);
 
+TransportProtocol stringToTransportProtocol(const std::string & protocol);
+
 enum class HostName { LOCALHOST, ANY };
 
 std::string enumToString(const HostName & hostname);
@@ -72,6 +72,13 @@ Proto toProto(const zmqpp::message & msg)
   proto.ParseFromString(serialized_str);
   return proto;
 }
+
+/// @note Parses the frame in place, into a message which may be on an arena.
+template <typename Proto>
+void toProto(const zmqpp::message & msg, Proto & proto)
+{
+  proto.ParseFromArray(msg.raw_data(0), static_cast<int>(msg.size(0)));
+}
 }  // namespace zeromq
 
 namespace simulation_interface
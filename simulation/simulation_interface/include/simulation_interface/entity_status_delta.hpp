@@ -0,0 +1,70 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SIMULATION_INTERFACE__ENTITY_STATUS_DELTA_HPP_
+#define SIMULATION_INTERFACE__ENTITY_STATUS_DELTA_HPP_
+
+#include <simulation_api_schema.pb.h>
+
+#include <cstdint>
+#include <geometry_msgs/msg/pose.hpp>
+#include <string>
+#include <traffic_simulator_msgs/msg/action_status.hpp>
+#include <traffic_simulator_msgs/msg/entity_status.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace simulation_interface
+{
+/**
+ * @brief Client side of the delta encoding of UpdateEntityStatusRequest. The first status of an
+ * entity is sent in full with a new id. The later ones are sent as an EntityStatusDelta carrying
+ * only the dynamic fields which changed since the status was last sent, and nothing at all if
+ * none did.
+ */
+class EntityStatusDeltaEncoder
+{
+public:
+  /// @note A forced status is sent even if nothing changed, for the simulator to update it.
+  void encode(
+    const traffic_simulator_msgs::msg::EntityStatus & status,
+    simulation_api_schema::UpdateEntityStatusRequest & request, const bool force = false);
+
+  /**
+   * @brief Record the changes the simulator made to a status, which the next delta is relative to.
+   * @return Name of the entity.
+   */
+  const std::string & decode(const simulation_api_schema::EntityStatusDelta & delta);
+
+  /// @note Call on despawn, so that a respawned entity is sent in full again.
+  void erase(const std::string & name);
+
+private:
+  struct Sent
+  {
+    std::uint32_t id;
+
+    geometry_msgs::msg::Pose pose;
+
+    traffic_simulator_msgs::msg::ActionStatus action_status;
+  };
+
+  std::unordered_map<std::string, Sent> sent_;
+
+  /// @note Names indexed by id, id 0 is never given.
+  std::vector<std::string> names_ = {""};
+};
+}  // namespace simulation_interface
+
+#endif  // SIMULATION_INTERFACE__ENTITY_STATUS_DELTA_HPP_
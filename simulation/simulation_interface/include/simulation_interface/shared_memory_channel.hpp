@@ -0,0 +1,111 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SIMULATION_INTERFACE__SHARED_MEMORY_CHANNEL_HPP_
+#define SIMULATION_INTERFACE__SHARED_MEMORY_CHANNEL_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace simulation_interface
+{
+/**
+ * @brief Request/reply channel between two processes on the same host, made of two ring buffers
+ * in a POSIX shared memory segment, one for each direction. A side waiting for data spins
+ * briefly, then sleeps on a futex which the other side wakes only when someone is sleeping.
+ * Messages of any size are streamed through the ring buffers.
+ *
+ * The rings have a single producer and a single consumer on each side, so a segment serves one
+ * client process at a time: a second client is rejected with a SimulationError and must use TCP.
+ * Each server writes a new session id in the segment it creates, which lets a client find out that
+ * the server it talks to was restarted and map the segment of the new server.
+ */
+class SharedMemoryChannel
+{
+public:
+  enum class Side { SERVER, CLIENT };
+
+  /**
+   * @brief The server creates the segment, replacing any segment left behind by a previous
+   * server, and removes it on destruction unless another server replaced it already. The client
+   * opens the segment when it first sends, waiting for a server to create it, and claims it until
+   * destruction. The claim of a client process which died is taken over. A client waits until the
+   * server empties the rings of what the previous client left in them, so that no message of the
+   * previous client is paired with one of the new client.
+   */
+  explicit SharedMemoryChannel(const std::string & name, const Side side);
+
+  ~SharedMemoryChannel();
+
+  SharedMemoryChannel(const SharedMemoryChannel &) = delete;
+
+  SharedMemoryChannel & operator=(const SharedMemoryChannel &) = delete;
+
+  void send(const std::string & message);
+
+  /// @note Blocks until a message is received.
+  void receive(std::string & message);
+
+  /// @return false if no message has started arriving within the timeout.
+  bool receive(std::string & message, const std::chrono::microseconds & timeout);
+
+  /**
+   * @brief Client only. Map the segment again if the server which created it shut down or was
+   * replaced by a new server, waiting for a new server if there is none yet.
+   * @return true if the segment was mapped again, in which case the messages in flight are lost
+   * and a request sent to the previous server must be sent again.
+   * @note Looks the segment up by name, so it is meant to be called when a response is late.
+   */
+  bool reopen();
+
+private:
+  struct Ring;
+
+  struct Segment;
+
+  void open();
+
+  void unmap();
+
+  /// @return Whether a new client claimed the segment and waits for the server to accept it.
+  bool clientChanged() const;
+
+  /// @note Server only. Empties the rings for a new client, @return false if there is none.
+  bool acceptClient();
+
+  /// @return Session id of the segment currently named name, or 0 if there is none.
+  static std::uint64_t currentSession(const std::string & name);
+
+  /// @return false if the server gave up on the message, because a new client claimed the segment.
+  bool write(Ring &, const char * data, std::size_t size);
+
+  bool read(Ring &, char * data, std::size_t size);
+
+  const std::string name_;
+
+  const Side side_;
+
+  Segment * segment_ = nullptr;
+
+  /// @note Session id of the segment mapped.
+  std::uint64_t session_ = 0;
+};
+
+/// @note Name of the segment of the channel used in place of the given TCP port.
+std::string getSharedMemoryName(const unsigned int & port);
+}  // namespace simulation_interface
+
+#endif  // SIMULATION_INTERFACE__SHARED_MEMORY_CHANNEL_HPP_
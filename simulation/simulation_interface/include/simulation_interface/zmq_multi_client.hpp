@@ -17,12 +17,17 @@
 
 #include <simulation_api_schema.pb.h>
 
+#include <condition_variable>
+#include <deque>
 #include <functional>
+#include <future>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <rclcpp/rclcpp.hpp>
 #include <scenario_simulator_exception/exception.hpp>
 #include <simulation_interface/constants.hpp>
+#include <simulation_interface/shared_memory_channel.hpp>
 #include <string>
 #include <thread>
 #include <zmqpp/zmqpp.hpp>
@@ -82,6 +87,25 @@ public:
   auto call(const simulation_api_schema::AttachPseudoTrafficLightDetectorRequest &)
     -> simulation_api_schema::AttachPseudoTrafficLightDetectorResponse;
 
+  auto call(const simulation_api_schema::FrameTransactionRequest &)
+    -> simulation_api_schema::FrameTransactionResponse;
+
+  /**
+   * @brief Send a request on a worker thread without waiting for the response.
+   * @note Requests are sent in the order they are given to call and callAsync. call waits for the
+   * requests given to callAsync before it, so a synchronous request never overtakes them.
+   */
+  template <typename Request>
+  auto callAsync(const Request & request) -> std::future<decltype(call(request))>
+  {
+    using Response = decltype(call(request));
+    auto task = std::make_shared<std::packaged_task<Response()>>(
+      [this, request]() { return call(request); });
+    auto response = task->get_future();
+    enqueue([task]() { (*task)(); });
+    return response;
+  }
+
   const simulation_interface::TransportProtocol protocol;
   const std::string hostname;
 
@@ -90,7 +114,42 @@ private:
   const zmqpp::socket_type type_;
   zmqpp::socket socket_;
 
+  /// @note Used instead of socket_ if the protocol is SHARED_MEMORY, by one client at a time.
+  std::unique_ptr<simulation_interface::SharedMemoryChannel> shared_memory_channel_;
+
+  std::string buffer_;
+
   bool is_running = true;
+
+  auto exchange(
+    const simulation_api_schema::SimulationRequest &, simulation_api_schema::SimulationResponse &)
+    -> void;
+
+  template <typename Request, typename Response>
+  auto callOnArena(
+    const Request &, Request * (simulation_api_schema::SimulationRequest::*)(),
+    const Response & (simulation_api_schema::SimulationResponse::*)() const) -> Response;
+
+  auto enqueue(std::function<void()> &&) -> void;
+
+  auto waitForAsyncCalls() -> void;
+
+  auto runAsyncCalls() -> void;
+
+  /// @note Started by the first callAsync, so the synchronous clients never start a thread.
+  std::thread async_call_thread_;
+
+  std::mutex async_call_mutex_;
+
+  std::condition_variable async_call_requested_;
+
+  std::condition_variable async_calls_done_;
+
+  std::deque<std::function<void()>> async_calls_;
+
+  bool async_call_running_ = false;
+
+  bool async_call_stopped_ = false;
 };
 }  // namespace zeromq
 
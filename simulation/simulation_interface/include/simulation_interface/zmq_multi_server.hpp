@@ -18,12 +18,15 @@
 #include <simulation_api_schema.pb.h>
 
 #include <functional>
+#include <memory>
 #include <rclcpp/rclcpp.hpp>
 #include <scenario_simulator_exception/exception.hpp>
 #include <simulation_interface/constants.hpp>
+#include <simulation_interface/shared_memory_channel.hpp>
 #include <string>
 #include <thread>
 #include <tuple>
+#include <vector>
 #include <zmqpp/zmqpp.hpp>
 
 namespace zeromq
@@ -40,8 +43,14 @@ public:
     socket_(context_, type_),
     functions_(std::forward<decltype(xs)>(xs)...)
   {
-    socket_.bind(simulation_interface::getEndPoint(protocol, hostname, socket_port));
-    poller_.add(socket_);
+    if (protocol == simulation_interface::TransportProtocol::SHARED_MEMORY) {
+      shared_memory_channel_ = std::make_unique<simulation_interface::SharedMemoryChannel>(
+        simulation_interface::getSharedMemoryName(socket_port),
+        simulation_interface::SharedMemoryChannel::Side::SERVER);
+    } else {
+      socket_.bind(simulation_interface::getEndPoint(protocol, hostname, socket_port));
+      poller_.add(socket_);
+    }
     thread_ = std::thread(&MultiServer::start_poll, this);
   }
 
@@ -50,11 +59,21 @@ public:
 private:
   void poll();
   void start_poll();
+  auto handle(const simulation_api_schema::SimulationRequest &)
+    -> simulation_api_schema::SimulationResponse;
+  auto frameTransaction(const simulation_api_schema::FrameTransactionRequest &)
+    -> simulation_api_schema::FrameTransactionResponse;
   std::thread thread_;
   const zmqpp::context context_;
   const zmqpp::socket_type type_;
   zmqpp::poller poller_;
   zmqpp::socket socket_;
+  /// @note Used instead of socket_ if the protocol is SHARED_MEMORY.
+  std::unique_ptr<simulation_interface::SharedMemoryChannel> shared_memory_channel_;
+  std::string buffer_;
+
+  /// @note First block of the arena of each request, see poll.
+  std::vector<char> arena_block_ = std::vector<char>(1 << 20);
 
 #define DEFINE_FUNCTION_TYPE(TYPENAME)                                      \
   using TYPENAME = std::function<simulation_api_schema::TYPENAME##Response( \
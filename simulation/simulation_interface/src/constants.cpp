@@ -37,12 +37,24 @@ std::string enumToString(const TransportProtocol & protocol)
   switch (protocol) {
     case TransportProtocol::TCP:
       return "tcp";
+    case TransportProtocol::SHARED_MEMORY:
+      return "shm";
       /*
     case TransportProtocol::UDP:
       return "udp";              
       */
   }
-  THROW_SIMULATION_ERROR("Protocol should be TCP.");  // LCOV_EXCL_LINE
+  THROW_SIMULATION_ERROR("Protocol should be TCP or SHARED_MEMORY.");  // LCOV_EXCL_LINE
+}
+
+TransportProtocol stringToTransportProtocol(const std::string & protocol)
+{
+  if (protocol == "tcp") {
+    return TransportProtocol::TCP;
+  } else if (protocol == "shm") {
+    return TransportProtocol::SHARED_MEMORY;
+  }
+  THROW_SIMULATION_ERROR("Protocol should be \"tcp\" or \"shm\", but ", protocol, " given.");
 }
 
 std::string enumToString(const HostName & hostname)
@@ -0,0 +1,77 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <scenario_simulator_exception/exception.hpp>
+#include <simulation_interface/conversions.hpp>
+#include <simulation_interface/entity_status_delta.hpp>
+#include <string>
+
+namespace simulation_interface
+{
+void EntityStatusDeltaEncoder::encode(
+  const traffic_simulator_msgs::msg::EntityStatus & status,
+  simulation_api_schema::UpdateEntityStatusRequest & request, const bool force)
+{
+  if (auto iterator = sent_.find(status.name); iterator == sent_.end()) {
+    const auto id = static_cast<std::uint32_t>(names_.size());
+    names_.push_back(status.name);
+    sent_.emplace(status.name, Sent{id, status.pose, status.action_status});
+    auto & proto = *request.add_status();
+    toProto(status, proto);
+    proto.set_id(id);
+  } else {
+    auto & sent = iterator->second;
+    const auto pose_changed = sent.pose != status.pose;
+    const auto action_status_changed = sent.action_status != status.action_status;
+    if (pose_changed or action_status_changed or force) {
+      auto & delta = *request.add_status_delta();
+      delta.set_id(sent.id);
+      delta.set_time(status.time);
+      if (pose_changed) {
+        toProto(status.pose, *delta.mutable_pose());
+        sent.pose = status.pose;
+      }
+      if (action_status_changed) {
+        toProto(status.action_status, *delta.mutable_action_status());
+        sent.action_status = status.action_status;
+      }
+    }
+  }
+}
+
+const std::string & EntityStatusDeltaEncoder::decode(
+  const simulation_api_schema::EntityStatusDelta & delta)
+{
+  if (delta.id() == 0 or delta.id() >= names_.size() or names_[delta.id()].empty()) {
+    THROW_SIMULATION_ERROR("Entity status delta for unknown id ", delta.id(), ".");
+  }
+  const auto & name = names_[delta.id()];
+  auto & sent = sent_.at(name);
+  if (delta.has_pose()) {
+    toMsg(delta.pose(), sent.pose);
+  }
+  if (delta.has_action_status()) {
+    toMsg(delta.action_status(), sent.action_status);
+  }
+  return name;
+}
+
+void EntityStatusDeltaEncoder::erase(const std::string & name)
+{
+  if (const auto iterator = sent_.find(name); iterator != sent_.end()) {
+    names_[iterator->second.id].clear();
+    sent_.erase(iterator);
+  }
+}
+}  // namespace simulation_interface
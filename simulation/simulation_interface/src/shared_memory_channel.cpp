@@ -0,0 +1,404 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <scenario_simulator_exception/exception.hpp>
+#include <simulation_interface/shared_memory_channel.hpp>
+#include <string>
+#include <thread>
+
+namespace simulation_interface
+{
+namespace
+{
+using Word = std::atomic<std::uint32_t>;
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "futex words must be lock free");
+
+static_assert(sizeof(Word) == sizeof(std::uint32_t), "futex words must be 32 bit");
+
+/// @note Written by the server once the segment is initialized, and cleared on shutdown.
+constexpr std::uint32_t ready_magic = 0x53534d31;
+
+/// @note How often a server waiting in the middle of a message checks whether the client changed.
+constexpr timespec client_check_interval = {0, 10'000'000};
+
+/// @note Spinning only delays the other side when both share a single core.
+const int spin_count = std::thread::hardware_concurrency() > 1 ? 4096 : 0;
+
+auto futex(Word & word, int operation, std::uint32_t value, const timespec * timeout) -> long
+{
+  /// @note Not FUTEX_PRIVATE_FLAG, since the word is shared between processes.
+  return syscall(
+    SYS_futex, reinterpret_cast<std::uint32_t *>(&word), operation, value, timeout, nullptr, 0);
+}
+
+/// @return false if the word still has the value on return, because of the timeout or not.
+auto wait(Word & word, Word & waiters, std::uint32_t value, const timespec * timeout) -> bool
+{
+  for (int i = 0; i < spin_count; ++i) {
+    if (word.load(std::memory_order_acquire) != value) {
+      return true;
+    }
+  }
+  /// @note The other side stores the word before loading waiters, and this side increments
+  /// waiters before loading the word, so one of them sees the other.
+  waiters.fetch_add(1);
+  if (word.load() == value) {
+    futex(word, FUTEX_WAIT, value, timeout);
+  }
+  waiters.fetch_sub(1);
+  return word.load(std::memory_order_acquire) != value;
+}
+
+auto notify(Word & word, Word & waiters, std::uint32_t value) -> void
+{
+  word.store(value);
+  if (waiters.load() != 0) {
+    futex(word, FUTEX_WAKE, INT_MAX, nullptr);
+  }
+}
+
+/// @return false if a live process other than this one holds the claim.
+auto claim(Word & client) -> bool
+{
+  const auto self = static_cast<std::uint32_t>(getpid());
+  auto owner = client.load();
+  do {
+    if (owner != 0 and not(kill(static_cast<pid_t>(owner), 0) != 0 and errno == ESRCH)) {
+      return false;
+    }
+  } while (not client.compare_exchange_weak(owner, self));
+  return true;
+}
+}  // namespace
+
+/**
+ * @brief Single producer, single consumer byte ring buffer. The counters of bytes written and
+ * read run freely and wrap around, so the capacity must divide 2^32.
+ */
+struct SharedMemoryChannel::Ring
+{
+  static constexpr std::uint32_t capacity = 1 << 20;
+
+  alignas(64) Word written;
+
+  Word written_waiters;
+
+  alignas(64) Word read;
+
+  Word read_waiters;
+
+  alignas(64) char data[capacity];
+};
+
+struct SharedMemoryChannel::Segment
+{
+  Word ready;
+
+  /// @note Process id of the client, or 0 if no client claimed the segment.
+  Word client;
+
+  /// @note Incremented by each client claiming the segment, then acknowledged by the server in
+  /// accepted_generation once it emptied the rings of what the previous client left in them.
+  Word client_generation;
+
+  Word accepted_generation;
+
+  /// @note Written by the server before ready, unique to each segment created on the host.
+  std::uint64_t session;
+
+  Ring to_server;
+
+  Ring to_client;
+};
+
+SharedMemoryChannel::SharedMemoryChannel(const std::string & name, const Side side)
+: name_(name), side_(side)
+{
+  if (side_ == Side::SERVER) {
+    shm_unlink(name_.c_str());
+    const auto descriptor = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (descriptor < 0) {
+      THROW_SIMULATION_ERROR("Failed to create shared memory ", name_, ": ", std::strerror(errno));
+    }
+    auto address = MAP_FAILED;
+    if (ftruncate(descriptor, sizeof(Segment)) == 0) {
+      address = mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    }
+    close(descriptor);
+    if (address == MAP_FAILED) {
+      shm_unlink(name_.c_str());
+      THROW_SIMULATION_ERROR("Failed to map shared memory ", name_, ": ", std::strerror(errno));
+    }
+    /// @note The pages of a new segment are zero, which is the initial value of every counter.
+    segment_ = new (address) Segment;
+    session_ = std::chrono::steady_clock::now().time_since_epoch().count();
+    segment_->session = session_;
+    segment_->ready.store(ready_magic, std::memory_order_release);
+  }
+}
+
+SharedMemoryChannel::~SharedMemoryChannel()
+{
+  if (side_ == Side::SERVER) {
+    /// @note Tells the client to map the segment of the next server.
+    segment_->ready.store(0, std::memory_order_release);
+    if (currentSession(name_) == session_) {
+      shm_unlink(name_.c_str());
+    }
+  }
+  unmap();
+}
+
+void SharedMemoryChannel::unmap()
+{
+  if (segment_) {
+    if (side_ == Side::CLIENT) {
+      auto self = static_cast<std::uint32_t>(getpid());
+      segment_->client.compare_exchange_strong(self, 0);
+    }
+    munmap(segment_, sizeof(Segment));
+    segment_ = nullptr;
+  }
+}
+
+std::uint64_t SharedMemoryChannel::currentSession(const std::string & name)
+{
+  std::uint64_t session = 0;
+  const auto descriptor = shm_open(name.c_str(), O_RDONLY, 0600);
+  if (descriptor >= 0) {
+    struct stat status;
+    if (fstat(descriptor, &status) == 0 and status.st_size == sizeof(Segment)) {
+      /// @note Only the page of the header is touched.
+      const auto address = mmap(nullptr, sizeof(Segment), PROT_READ, MAP_SHARED, descriptor, 0);
+      if (address != MAP_FAILED) {
+        const auto segment = static_cast<const Segment *>(address);
+        if (segment->ready.load(std::memory_order_acquire) == ready_magic) {
+          session = segment->session;
+        }
+        munmap(address, sizeof(Segment));
+      }
+    }
+    close(descriptor);
+  }
+  return session;
+}
+
+bool SharedMemoryChannel::reopen()
+{
+  if (side_ == Side::CLIENT and segment_ and currentSession(name_) != session_) {
+    unmap();
+    open();
+    return true;
+  } else {
+    return false;
+  }
+}
+
+void SharedMemoryChannel::open()
+{
+  if (segment_ and segment_->ready.load(std::memory_order_acquire) != ready_magic) {
+    unmap();
+  }
+  while (not segment_) {
+    const auto descriptor = shm_open(name_.c_str(), O_RDWR, 0600);
+    if (descriptor >= 0) {
+      struct stat status;
+      if (fstat(descriptor, &status) == 0 and status.st_size == sizeof(Segment)) {
+        const auto address =
+          mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+        if (address != MAP_FAILED) {
+          segment_ = static_cast<Segment *>(address);
+        }
+      }
+      close(descriptor);
+    }
+    if (segment_ and segment_->ready.load(std::memory_order_acquire) != ready_magic) {
+      munmap(segment_, sizeof(Segment));
+      segment_ = nullptr;
+    }
+    if (not segment_) {
+      /// @note Same as a ZeroMQ request sent before the server binds, wait for the server.
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    } else if (not claim(segment_->client)) {
+      const auto owner = segment_->client.load();
+      munmap(segment_, sizeof(Segment));
+      segment_ = nullptr;
+      THROW_SIMULATION_ERROR(
+        "Shared memory ", name_, " is already used by the client process ", owner,
+        ", only one client is supported, use TCP for the others.");
+    } else {
+      session_ = segment_->session;
+      const auto generation = segment_->client_generation.fetch_add(1) + 1;
+      /// @note Wakes the server if it waits for a request, so that it accepts this client now.
+      futex(segment_->to_server.written, FUTEX_WAKE, INT_MAX, nullptr);
+      while (segment_->accepted_generation.load(std::memory_order_acquire) != generation) {
+        if (
+          segment_->ready.load(std::memory_order_acquire) != ready_magic or
+          currentSession(name_) != session_) {
+          unmap();
+          break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    }
+  }
+}
+
+bool SharedMemoryChannel::clientChanged() const
+{
+  return side_ == Side::SERVER and
+         segment_->client_generation.load(std::memory_order_acquire) !=
+           segment_->accepted_generation.load(std::memory_order_relaxed);
+}
+
+bool SharedMemoryChannel::acceptClient()
+{
+  if (not clientChanged()) {
+    return false;
+  }
+  const auto generation = segment_->client_generation.load(std::memory_order_acquire);
+  /// @note No one else uses the rings, the new client waits for the generation to be accepted.
+  for (auto ring : {&segment_->to_server, &segment_->to_client}) {
+    ring->written.store(0);
+    ring->read.store(0);
+  }
+  segment_->accepted_generation.store(generation, std::memory_order_release);
+  return true;
+}
+
+void SharedMemoryChannel::send(const std::string & message)
+{
+  open();
+  /// @note A response to the request of a previous client is dropped.
+  if (acceptClient()) {
+    return;
+  }
+  auto & ring = side_ == Side::SERVER ? segment_->to_client : segment_->to_server;
+  const auto size = static_cast<std::uint32_t>(message.size());
+  if (
+    not write(ring, reinterpret_cast<const char *>(&size), sizeof(size)) or
+    not write(ring, message.data(), message.size())) {
+    acceptClient();
+  }
+}
+
+void SharedMemoryChannel::receive(std::string & message)
+{
+  while (not receive(message, std::chrono::seconds(1))) {
+  }
+}
+
+bool SharedMemoryChannel::receive(std::string & message, const std::chrono::microseconds & timeout)
+{
+  open();
+  acceptClient();
+  auto & ring = side_ == Side::SERVER ? segment_->to_server : segment_->to_client;
+  const auto read = ring.read.load(std::memory_order_relaxed);
+  const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+  const auto relative_timeout = timespec{
+    static_cast<time_t>(seconds.count()),
+    static_cast<long>(std::chrono::nanoseconds(timeout - seconds).count())};
+  if (not wait(ring.written, ring.written_waiters, read, &relative_timeout)) {
+    /// @note Woken up by a client claiming the segment.
+    acceptClient();
+    return false;
+  }
+  std::uint32_t size = 0;
+  if (not this->read(ring, reinterpret_cast<char *>(&size), sizeof(size))) {
+    acceptClient();
+    return false;
+  }
+  message.resize(size);
+  /// @note A request which the previous client did not finish writing is dropped.
+  if (not this->read(ring, &message[0], size)) {
+    acceptClient();
+    return false;
+  }
+  return true;
+}
+
+bool SharedMemoryChannel::write(Ring & ring, const char * data, std::size_t size)
+{
+  const auto timeout = side_ == Side::SERVER ? &client_check_interval : nullptr;
+  auto written = ring.written.load(std::memory_order_relaxed);
+  while (size != 0) {
+    const auto read = ring.read.load(std::memory_order_acquire);
+    const auto free = Ring::capacity - (written - read);
+    if (free == 0) {
+      if (not wait(ring.read, ring.read_waiters, read, timeout) and clientChanged()) {
+        return false;
+      }
+    } else {
+      const auto count = static_cast<std::uint32_t>(std::min<std::size_t>(size, free));
+      const auto offset = written % Ring::capacity;
+      const auto first = std::min(count, Ring::capacity - offset);
+      std::memcpy(ring.data + offset, data, first);
+      std::memcpy(ring.data, data + first, count - first);
+      written += count;
+      data += count;
+      size -= count;
+      notify(ring.written, ring.written_waiters, written);
+    }
+  }
+  return true;
+}
+
+bool SharedMemoryChannel::read(Ring & ring, char * data, std::size_t size)
+{
+  const auto timeout = side_ == Side::SERVER ? &client_check_interval : nullptr;
+  auto read = ring.read.load(std::memory_order_relaxed);
+  while (size != 0) {
+    const auto written = ring.written.load(std::memory_order_acquire);
+    const auto available = written - read;
+    if (available == 0) {
+      if (not wait(ring.written, ring.written_waiters, written, timeout) and clientChanged()) {
+        return false;
+      }
+    } else {
+      const auto count = static_cast<std::uint32_t>(std::min<std::size_t>(size, available));
+      const auto offset = read % Ring::capacity;
+      const auto first = std::min(count, Ring::capacity - offset);
+      std::memcpy(data, ring.data + offset, first);
+      std::memcpy(data + first, ring.data, count - first);
+      read += count;
+      data += count;
+      size -= count;
+      notify(ring.read, ring.read_waiters, read);
+    }
+  }
+  return true;
+}
+
+std::string getSharedMemoryName(const unsigned int & port)
+{
+  return "/simulation_interface_" + std::to_string(port);
+}
+}  // namespace simulation_interface
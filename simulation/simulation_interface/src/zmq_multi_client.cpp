@@ -12,12 +12,33 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <google/protobuf/arena.h>
+
+#include <chrono>
+#include <memory>
+#include <mutex>
 #include <rclcpp/utilities.hpp>
 #include <simulation_interface/conversions.hpp>
 #include <simulation_interface/zmq_multi_client.hpp>
 #include <string>
+#include <vector>
+
 namespace zeromq
 {
+namespace
+{
+/// @note The first block is kept by each thread calling, so that an arena fitting in it does not
+/// allocate. Only one arena per thread uses it at a time, see MultiClient::callOnArena.
+auto arenaOptions() -> google::protobuf::ArenaOptions
+{
+  thread_local std::vector<char> initial_block(1 << 20);
+  google::protobuf::ArenaOptions options;
+  options.initial_block = initial_block.data();
+  options.initial_block_size = initial_block.size();
+  return options;
+}
+}  // namespace
+
 MultiClient::MultiClient(
   const simulation_interface::TransportProtocol & protocol, const std::string & hostname,
   const unsigned int socket_port)
@@ -27,11 +48,25 @@ MultiClient::MultiClient(
   type_(zmqpp::socket_type::request),
   socket_(context_, type_)
 {
-  socket_.connect(simulation_interface::getEndPoint(protocol, hostname, socket_port));
+  if (protocol == simulation_interface::TransportProtocol::SHARED_MEMORY) {
+    shared_memory_channel_ = std::make_unique<simulation_interface::SharedMemoryChannel>(
+      simulation_interface::getSharedMemoryName(socket_port),
+      simulation_interface::SharedMemoryChannel::Side::CLIENT);
+  } else {
+    socket_.connect(simulation_interface::getEndPoint(protocol, hostname, socket_port));
+  }
 }
 
 void MultiClient::closeConnection()
 {
+  if (async_call_thread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(async_call_mutex_);
+      async_call_stopped_ = true;
+    }
+    async_call_requested_.notify_one();
+    async_call_thread_.join();
+  }
   if (is_running) {
     is_running = false;
     socket_.close();
@@ -40,170 +75,220 @@ void MultiClient::closeConnection()
 
 MultiClient::~MultiClient() { closeConnection(); }
 
-auto MultiClient::call(const simulation_api_schema::SimulationRequest & req)
-  -> simulation_api_schema::SimulationResponse
+auto MultiClient::enqueue(std::function<void()> && async_call) -> void
 {
-  zmqpp::message message = toZMQ(req);
-  socket_.send(message);
-  zmqpp::message buffer;
-  socket_.receive(buffer);
-  return toProto<simulation_api_schema::SimulationResponse>(buffer);
+  {
+    std::lock_guard<std::mutex> lock(async_call_mutex_);
+    if (async_call_stopped_) {
+      THROW_SIMULATION_ERROR("MultiClient::callAsync is called after the connection is closed.");
+    }
+    async_calls_.push_back(std::move(async_call));
+    if (not async_call_thread_.joinable()) {
+      async_call_thread_ = std::thread([this]() { runAsyncCalls(); });
+    }
+  }
+  async_call_requested_.notify_one();
 }
 
-auto MultiClient::call(const simulation_api_schema::InitializeRequest & request)
-  -> simulation_api_schema::InitializeResponse
+auto MultiClient::waitForAsyncCalls() -> void
 {
-  if (is_running) {
-    simulation_api_schema::SimulationRequest sim_request;
-    *sim_request.mutable_initialize() = request;
-    return call(sim_request).initialize();
+  std::unique_lock<std::mutex> lock(async_call_mutex_);
+  /// @note The asynchronous calls themselves go through call on the worker thread. The thread is
+  /// read under the lock, since callAsync may start it concurrently.
+  if (std::this_thread::get_id() != async_call_thread_.get_id()) {
+    async_calls_done_.wait(
+      lock, [this]() { return async_calls_.empty() and not async_call_running_; });
+  }
+}
+
+auto MultiClient::runAsyncCalls() -> void
+{
+  std::unique_lock<std::mutex> lock(async_call_mutex_);
+  while (true) {
+    async_call_requested_.wait(
+      lock, [this]() { return not async_calls_.empty() or async_call_stopped_; });
+    if (async_calls_.empty()) {
+      return;
+    }
+    auto async_call = std::move(async_calls_.front());
+    async_calls_.pop_front();
+    async_call_running_ = true;
+    lock.unlock();
+    async_call();
+    lock.lock();
+    async_call_running_ = false;
+    if (async_calls_.empty()) {
+      async_calls_done_.notify_all();
+    }
+  }
+}
+
+auto MultiClient::exchange(
+  const simulation_api_schema::SimulationRequest & request,
+  simulation_api_schema::SimulationResponse & response) -> void
+{
+  waitForAsyncCalls();
+  request.SerializeToString(&buffer_);
+  if (shared_memory_channel_) {
+    shared_memory_channel_->send(buffer_);
+    while (not shared_memory_channel_->receive(buffer_, std::chrono::seconds(1))) {
+      /// @note A restarted server never got the request, which is still in the buffer.
+      if (shared_memory_channel_->reopen()) {
+        shared_memory_channel_->send(buffer_);
+      }
+    }
+    response.ParseFromString(buffer_);
   } else {
-    return {};
+    zmqpp::message message;
+    message.add_raw(buffer_.data(), buffer_.size());
+    socket_.send(message);
+    zmqpp::message buffer;
+    socket_.receive(buffer);
+    toProto(buffer, response);
   }
 }
 
-auto MultiClient::call(const simulation_api_schema::UpdateFrameRequest & request)
-  -> simulation_api_schema::UpdateFrameResponse
+/// @note Allocates only the response returned, when the request and the response fit in the
+/// first block of the arena.
+template <typename Request, typename Response>
+auto MultiClient::callOnArena(
+  const Request & request,
+  Request * (simulation_api_schema::SimulationRequest::*mutable_request)(),
+  const Response & (simulation_api_schema::SimulationResponse::*response)() const) -> Response
 {
   if (is_running) {
-    simulation_api_schema::SimulationRequest sim_request;
-    *sim_request.mutable_update_frame() = request;
-    return call(sim_request).update_frame();
+    google::protobuf::Arena arena(arenaOptions());
+    auto simulation_request =
+      google::protobuf::Arena::CreateMessage<simulation_api_schema::SimulationRequest>(&arena);
+    (simulation_request->*mutable_request)()->CopyFrom(request);
+    auto simulation_response =
+      google::protobuf::Arena::CreateMessage<simulation_api_schema::SimulationResponse>(&arena);
+    exchange(*simulation_request, *simulation_response);
+    return (simulation_response->*response)();
   } else {
     return {};
   }
 }
 
+auto MultiClient::call(const simulation_api_schema::SimulationRequest & req)
+  -> simulation_api_schema::SimulationResponse
+{
+  simulation_api_schema::SimulationResponse response;
+  exchange(req, response);
+  return response;
+}
+
+auto MultiClient::call(const simulation_api_schema::InitializeRequest & request)
+  -> simulation_api_schema::InitializeResponse
+{
+  return callOnArena(
+    request, &simulation_api_schema::SimulationRequest::mutable_initialize,
+    &simulation_api_schema::SimulationResponse::initialize);
+}
+
+auto MultiClient::call(const simulation_api_schema::UpdateFrameRequest & request)
+  -> simulation_api_schema::UpdateFrameResponse
+{
+  return callOnArena(
+    request, &simulation_api_schema::SimulationRequest::mutable_update_frame,
+    &simulation_api_schema::SimulationResponse::update_frame);
+}
+
 auto MultiClient::call(const simulation_api_schema::SpawnVehicleEntityRequest & request)
   -> simulation_api_schema::SpawnVehicleEntityResponse
 {
-  if (is_running) {
-    simulation_api_schema::SimulationRequest sim_request;
-    *sim_request.mutable_spawn_vehicle_entity() = request;
-    return call(sim_request).spawn_vehicle_entity();
-  } else {
-    return {};
-  }
+  return callOnArena(
+    request, &simulation_api_schema::SimulationRequest::mutable_spawn_vehicle_entity,
+    &simulation_api_schema::SimulationResponse::spawn_vehicle_entity);
 }
 
 auto MultiClient::call(const simulation_api_schema::SpawnPedestrianEntityRequest & request)
   -> simulation_api_schema::SpawnPedestrianEntityResponse
 {
-  if (is_running) {
-    simulation_api_schema::SimulationRequest sim_request;
-    *sim_request.mutable_spawn_pedestrian_entity() = request;
-    return call(sim_request).spawn_pedestrian_entity();
-  } else {
-    return {};
-  }
+  return callOnArena(
+    request, &simulation_api_schema::SimulationRequest::mutable_spawn_pedestrian_entity,
+    &simulation_api_schema::SimulationResponse::spawn_pedestrian_entity);
 }
 
 auto MultiClient::call(const simulation_api_schema::SpawnMiscObjectEntityRequest & request)
   -> simulation_api_schema::SpawnMiscObjectEntityResponse
 {
-  if (is_running) {
-    simulation_api_schema::SimulationRequest sim_request;
-    *sim_request.mutable_spawn_misc_object_entity() = request;
-    return call(sim_request).spawn_misc_object_entity();
-  } else {
-    return {};
-  }
+  return callOnArena(
+    request, &simulation_api_schema::SimulationRequest::mutable_spawn_misc_object_entity,
+    &simulation_api_schema::SimulationResponse::spawn_misc_object_entity);
 }
 
 auto MultiClient::call(const simulation_api_schema::DespawnEntityRequest & request)
   -> simulation_api_schema::DespawnEntityResponse
 {
-  if (is_running) {
-    simulation_api_schema::SimulationRequest sim_request;
-    *sim_request.mutable_despawn_entity() = request;
-    return call(sim_request).despawn_entity();
-  } else {
-    return {};
-  }
+  return callOnArena(
+    request, &simulation_api_schema::SimulationRequest::mutable_despawn_entity,
+    &simulation_api_schema::SimulationResponse::despawn_entity);
 }
 
 auto MultiClient::call(const simulation_api_schema::UpdateEntityStatusRequest & request)
   -> simulation_api_schema::UpdateEntityStatusResponse
 {
-  if (is_running) {
-    simulation_api_schema::SimulationRequest sim_request;
-    *sim_request.mutable_update_entity_status() = request;
-    return call(sim_request).update_entity_status();
-  } else {
-    return {};
-  }
+  return callOnArena(
+    request, &simulation_api_schema::SimulationRequest::mutable_update_entity_status,
+    &simulation_api_schema::SimulationResponse::update_entity_status);
 }
 
 auto MultiClient::call(const simulation_api_schema::AttachLidarSensorRequest & request)
   -> simulation_api_schema::AttachLidarSensorResponse
 {
-  if (is_running) {
-    simulation_api_schema::SimulationRequest sim_request;
-    *sim_request.mutable_attach_lidar_sensor() = request;
-    return call(sim_request).attach_lidar_sensor();
-  } else {
-    return {};
-  }
+  return callOnArena(
+    request, &simulation_api_schema::SimulationRequest::mutable_attach_lidar_sensor,
+    &simulation_api_schema::SimulationResponse::attach_lidar_sensor);
 }
 
 auto MultiClient::call(const simulation_api_schema::AttachDetectionSensorRequest & request)
   -> simulation_api_schema::AttachDetectionSensorResponse
 {
-  if (is_running) {
-    simulation_api_schema::SimulationRequest sim_request;
-    *sim_request.mutable_attach_detection_sensor() = request;
-    return call(sim_request).attach_detection_sensor();
-  } else {
-    return {};
-  }
+  return callOnArena(
+    request, &simulation_api_schema::SimulationRequest::mutable_attach_detection_sensor,
+    &simulation_api_schema::SimulationResponse::attach_detection_sensor);
 }
 
 auto MultiClient::call(const simulation_api_schema::AttachOccupancyGridSensorRequest & request)
   -> simulation_api_schema::AttachOccupancyGridSensorResponse
 {
-  if (is_running) {
-    simulation_api_schema::SimulationRequest sim_request;
-    *sim_request.mutable_attach_occupancy_grid_sensor() = request;
-    return call(sim_request).attach_occupancy_grid_sensor();
-  } else {
-    return {};
-  }
+  return callOnArena(
+    request, &simulation_api_schema::SimulationRequest::mutable_attach_occupancy_grid_sensor,
+    &simulation_api_schema::SimulationResponse::attach_occupancy_grid_sensor);
 }
 
 auto MultiClient::call(const simulation_api_schema::UpdateTrafficLightsRequest & request)
   -> simulation_api_schema::UpdateTrafficLightsResponse
 {
-  if (is_running) {
-    simulation_api_schema::SimulationRequest sim_request;
-    *sim_request.mutable_update_traffic_lights() = request;
-    return call(sim_request).update_traffic_lights();
-  } else {
-    return {};
-  }
+  return callOnArena(
+    request, &simulation_api_schema::SimulationRequest::mutable_update_traffic_lights,
+    &simulation_api_schema::SimulationResponse::update_traffic_lights);
 }
 
 auto MultiClient::call(const simulation_api_schema::FollowPolylineTrajectoryRequest & request)
   -> simulation_api_schema::FollowPolylineTrajectoryResponse
 {
-  if (is_running) {
-    auto simulation_request = simulation_api_schema::SimulationRequest();
-    *simulation_request.mutable_follow_polyline_trajectory() = request;
-    return call(simulation_request).follow_polyline_trajectory();
-  } else {
-    return {};
-  }
+  return callOnArena(
+    request, &simulation_api_schema::SimulationRequest::mutable_follow_polyline_trajectory,
+    &simulation_api_schema::SimulationResponse::follow_polyline_trajectory);
 }
 
 auto MultiClient::call(
   const simulation_api_schema::AttachPseudoTrafficLightDetectorRequest & request)
   -> simulation_api_schema::AttachPseudoTrafficLightDetectorResponse
 {
-  if (is_running) {
-    auto simulation_request = simulation_api_schema::SimulationRequest();
-    *simulation_request.mutable_attach_pseudo_traffic_light_detector() = request;
-    return call(simulation_request).attach_pseudo_traffic_light_detector();
-  } else {
-    return {};
-  }
+  return callOnArena(
+    request,
+    &simulation_api_schema::SimulationRequest::mutable_attach_pseudo_traffic_light_detector,
+    &simulation_api_schema::SimulationResponse::attach_pseudo_traffic_light_detector);
+}
+
+auto MultiClient::call(const simulation_api_schema::FrameTransactionRequest & request)
+  -> simulation_api_schema::FrameTransactionResponse
+{
+  return callOnArena(
+    request, &simulation_api_schema::SimulationRequest::mutable_frame_transaction,
+    &simulation_api_schema::SimulationResponse::frame_transaction);
 }
 }  // namespace zeromq
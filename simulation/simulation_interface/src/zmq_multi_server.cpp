@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <google/protobuf/arena.h>
+
 #include <simulation_interface/conversions.hpp>
 #include <simulation_interface/zmq_multi_server.hpp>
 #include <status_monitor/status_monitor.hpp>
@@ -23,71 +25,136 @@ MultiServer::~MultiServer() { thread_.join(); }
 void MultiServer::poll()
 {
   constexpr long timeout_ms = 1L;
+  /// @note The request and the response are on an arena, which allocates nothing while they fit in
+  /// its first block.
+  auto exchange = [this](auto && parse) {
+    google::protobuf::ArenaOptions options;
+    options.initial_block = arena_block_.data();
+    options.initial_block_size = arena_block_.size();
+    google::protobuf::Arena arena(options);
+    auto request =
+      google::protobuf::Arena::CreateMessage<simulation_api_schema::SimulationRequest>(&arena);
+    parse(*request);
+    auto response =
+      google::protobuf::Arena::CreateMessage<simulation_api_schema::SimulationResponse>(&arena);
+    handle(*request, *response);
+    response->SerializeToString(&buffer_);
+  };
+  if (shared_memory_channel_) {
+    /// @note Returns as soon as a request arrives, the timeout only bounds the time to shut down.
+    if (shared_memory_channel_->receive(buffer_, std::chrono::milliseconds(timeout_ms))) {
+      exchange([this](auto & request) { request.ParseFromString(buffer_); });
+      shared_memory_channel_->send(buffer_);
+    }
+    return;
+  }
   poller_.poll(timeout_ms);
   if (poller_.has_input(socket_)) {
-    simulation_api_schema::SimulationResponse sim_response;
     zmqpp::message sim_request;
     socket_.receive(sim_request);
-    auto proto = toProto<simulation_api_schema::SimulationRequest>(sim_request);
-    switch (proto.request_case()) {
-      case simulation_api_schema::SimulationRequest::RequestCase::kInitialize:
-        *sim_response.mutable_initialize() = std::get<Initialize>(functions_)(proto.initialize());
-        break;
-      case simulation_api_schema::SimulationRequest::RequestCase::kUpdateFrame:
-        *sim_response.mutable_update_frame() =
-          std::get<UpdateFrame>(functions_)(proto.update_frame());
-        break;
-      case simulation_api_schema::SimulationRequest::RequestCase::kSpawnVehicleEntity:
-        *sim_response.mutable_spawn_vehicle_entity() =
-          std::get<SpawnVehicleEntity>(functions_)(proto.spawn_vehicle_entity());
-        break;
-      case simulation_api_schema::SimulationRequest::RequestCase::kSpawnPedestrianEntity:
-        *sim_response.mutable_spawn_pedestrian_entity() =
-          std::get<SpawnPedestrianEntity>(functions_)(proto.spawn_pedestrian_entity());
-        break;
-      case simulation_api_schema::SimulationRequest::RequestCase::kSpawnMiscObjectEntity:
-        *sim_response.mutable_spawn_misc_object_entity() =
-          std::get<SpawnMiscObjectEntity>(functions_)(proto.spawn_misc_object_entity());
-        break;
-      case simulation_api_schema::SimulationRequest::RequestCase::kDespawnEntity:
-        *sim_response.mutable_despawn_entity() =
-          std::get<DespawnEntity>(functions_)(proto.despawn_entity());
-        break;
-      case simulation_api_schema::SimulationRequest::RequestCase::kUpdateEntityStatus:
-        *sim_response.mutable_update_entity_status() =
-          std::get<UpdateEntityStatus>(functions_)(proto.update_entity_status());
-        break;
-      case simulation_api_schema::SimulationRequest::RequestCase::kAttachLidarSensor:
-        *sim_response.mutable_attach_lidar_sensor() =
-          std::get<AttachLidarSensor>(functions_)(proto.attach_lidar_sensor());
-        break;
-      case simulation_api_schema::SimulationRequest::RequestCase::kAttachDetectionSensor:
-        *sim_response.mutable_attach_detection_sensor() =
-          std::get<AttachDetectionSensor>(functions_)(proto.attach_detection_sensor());
-        break;
-      case simulation_api_schema::SimulationRequest::RequestCase::kAttachOccupancyGridSensor:
-        *sim_response.mutable_attach_occupancy_grid_sensor() =
-          std::get<AttachOccupancyGridSensor>(functions_)(proto.attach_occupancy_grid_sensor());
-        break;
-      case simulation_api_schema::SimulationRequest::RequestCase::kUpdateTrafficLights:
-        *sim_response.mutable_update_traffic_lights() =
-          std::get<UpdateTrafficLights>(functions_)(proto.update_traffic_lights());
-        break;
-      case simulation_api_schema::SimulationRequest::RequestCase::kFollowPolylineTrajectory:
-        *sim_response.mutable_follow_polyline_trajectory() =
-          std::get<FollowPolylineTrajectory>(functions_)(proto.follow_polyline_trajectory());
-        break;
-      case simulation_api_schema::SimulationRequest::RequestCase::kAttachPseudoTrafficLightDetector:
-        *sim_response.mutable_attach_pseudo_traffic_light_detector() =
-          std::get<AttachPseudoTrafficLightDetector>(functions_)(
-            proto.attach_pseudo_traffic_light_detector());
-        break;
-      case simulation_api_schema::SimulationRequest::RequestCase::REQUEST_NOT_SET: {
-        THROW_SIMULATION_ERROR("No case defined for oneof in SimulationRequest message");
-      }
+    exchange([&](auto & request) { toProto(sim_request, request); });
+    zmqpp::message sim_response;
+    sim_response.add_raw(buffer_.data(), buffer_.size());
+    socket_.send(sim_response);
+  }
+}
+
+auto MultiServer::handle(
+  const simulation_api_schema::SimulationRequest & proto,
+  simulation_api_schema::SimulationResponse & sim_response) -> void
+{
+  switch (proto.request_case()) {
+    case simulation_api_schema::SimulationRequest::RequestCase::kInitialize:
+      *sim_response.mutable_initialize() = std::get<Initialize>(functions_)(proto.initialize());
+      break;
+    case simulation_api_schema::SimulationRequest::RequestCase::kUpdateFrame:
+      *sim_response.mutable_update_frame() =
+        std::get<UpdateFrame>(functions_)(proto.update_frame());
+      break;
+    case simulation_api_schema::SimulationRequest::RequestCase::kSpawnVehicleEntity:
+      *sim_response.mutable_spawn_vehicle_entity() =
+        std::get<SpawnVehicleEntity>(functions_)(proto.spawn_vehicle_entity());
+      break;
+    case simulation_api_schema::SimulationRequest::RequestCase::kSpawnPedestrianEntity:
+      *sim_response.mutable_spawn_pedestrian_entity() =
+        std::get<SpawnPedestrianEntity>(functions_)(proto.spawn_pedestrian_entity());
+      break;
+    case simulation_api_schema::SimulationRequest::RequestCase::kSpawnMiscObjectEntity:
+      *sim_response.mutable_spawn_misc_object_entity() =
+        std::get<SpawnMiscObjectEntity>(functions_)(proto.spawn_misc_object_entity());
+      break;
+    case simulation_api_schema::SimulationRequest::RequestCase::kDespawnEntity:
+      *sim_response.mutable_despawn_entity() =
+        std::get<DespawnEntity>(functions_)(proto.despawn_entity());
+      break;
+    case simulation_api_schema::SimulationRequest::RequestCase::kUpdateEntityStatus:
+      *sim_response.mutable_update_entity_status() =
+        std::get<UpdateEntityStatus>(functions_)(proto.update_entity_status());
+      break;
+    case simulation_api_schema::SimulationRequest::RequestCase::kAttachLidarSensor:
+      *sim_response.mutable_attach_lidar_sensor() =
+        std::get<AttachLidarSensor>(functions_)(proto.attach_lidar_sensor());
+      break;
+    case simulation_api_schema::SimulationRequest::RequestCase::kAttachDetectionSensor:
+      *sim_response.mutable_attach_detection_sensor() =
+        std::get<AttachDetectionSensor>(functions_)(proto.attach_detection_sensor());
+      break;
+    case simulation_api_schema::SimulationRequest::RequestCase::kAttachOccupancyGridSensor:
+      *sim_response.mutable_attach_occupancy_grid_sensor() =
+        std::get<AttachOccupancyGridSensor>(functions_)(proto.attach_occupancy_grid_sensor());
+      break;
+    case simulation_api_schema::SimulationRequest::RequestCase::kUpdateTrafficLights:
+      *sim_response.mutable_update_traffic_lights() =
+        std::get<UpdateTrafficLights>(functions_)(proto.update_traffic_lights());
+      break;
+    case simulation_api_schema::SimulationRequest::RequestCase::kFollowPolylineTrajectory:
+      *sim_response.mutable_follow_polyline_trajectory() =
+        std::get<FollowPolylineTrajectory>(functions_)(proto.follow_polyline_trajectory());
+      break;
+    case simulation_api_schema::SimulationRequest::RequestCase::kAttachPseudoTrafficLightDetector:
+      *sim_response.mutable_attach_pseudo_traffic_light_detector() =
+        std::get<AttachPseudoTrafficLightDetector>(functions_)(
+          proto.attach_pseudo_traffic_light_detector());
+      break;
+    case simulation_api_schema::SimulationRequest::RequestCase::kFrameTransaction:
+      frameTransaction(proto.frame_transaction(), *sim_response.mutable_frame_transaction());
+      break;
+    case simulation_api_schema::SimulationRequest::RequestCase::REQUEST_NOT_SET: {
+      THROW_SIMULATION_ERROR("No case defined for oneof in SimulationRequest message");
     }
-    auto msg = toZMQ(sim_response);
-    socket_.send(msg);
+  }
+}
+
+auto MultiServer::frameTransaction(
+  const simulation_api_schema::FrameTransactionRequest & request,
+  simulation_api_schema::FrameTransactionResponse & response) -> void
+{
+  auto succeeded = [&](const auto & sub_response) {
+    *response.mutable_result() = sub_response.result();
+    return sub_response.result().success();
+  };
+  /// @note Same order as the separate requests: traffic lights and time of the previous frame
+  /// are applied before the entity status of the current frame is.
+  if (
+    request.has_update_traffic_lights() and
+    not succeeded(
+      *response.mutable_update_traffic_lights() =
+        std::get<UpdateTrafficLights>(functions_)(request.update_traffic_lights()))) {
+    return;
+  }
+  if (
+    request.has_update_frame() and
+    not succeeded(
+      *response.mutable_update_frame() =
+        std::get<UpdateFrame>(functions_)(request.update_frame()))) {
+    return;
+  }
+  if (request.has_update_entity_status()) {
+    succeeded(
+      *response.mutable_update_entity_status() =
+        std::get<UpdateEntityStatus>(functions_)(request.update_entity_status()));
+  } else {
+    response.mutable_result()->set_success(true);
   }
 }
 
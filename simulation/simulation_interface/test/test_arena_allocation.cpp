@@ -0,0 +1,183 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <rclcpp/rclcpp.hpp>
+#include <simulation_interface/conversions.hpp>
+#include <simulation_interface/zmq_multi_client.hpp>
+#include <simulation_interface/zmq_multi_server.hpp>
+#include <string>
+#include <utility>
+
+/// @note Allocations with operator new by any thread, which is what protobuf allocates with.
+std::atomic<std::size_t> allocation_count{0};
+
+auto operator new(std::size_t size) -> void *
+{
+  ++allocation_count;
+  if (auto pointer = std::malloc(size == 0 ? 1 : size)) {
+    return pointer;
+  } else {
+    throw std::bad_alloc();
+  }
+}
+
+auto operator delete(void * pointer) noexcept -> void { std::free(pointer); }
+
+auto operator delete(void * pointer, std::size_t) noexcept -> void { std::free(pointer); }
+
+constexpr unsigned int port = 5565;
+
+/**
+ * @brief Server answering every request, shut down with rclcpp after the last test, since
+ * MultiServer polls until rclcpp::ok() is false.
+ */
+class Server : public testing::Environment
+{
+public:
+  auto SetUp() -> void override
+  {
+    namespace schema = simulation_api_schema;
+    auto succeed = [](auto response) {
+      response.mutable_result()->set_success(true);
+      return response;
+    };
+    server_ = std::make_unique<zeromq::MultiServer>(
+      simulation_interface::protocol, simulation_interface::HostName::ANY, port,
+      [=](const auto &) { return succeed(schema::InitializeResponse()); },
+      [=](const auto &) { return succeed(schema::UpdateFrameResponse()); },
+      [=](const auto &) { return succeed(schema::SpawnVehicleEntityResponse()); },
+      [=](const auto &) { return succeed(schema::SpawnPedestrianEntityResponse()); },
+      [=](const auto &) { return succeed(schema::SpawnMiscObjectEntityResponse()); },
+      [=](const auto &) { return succeed(schema::DespawnEntityResponse()); },
+      [=](const auto &) { return succeed(schema::UpdateEntityStatusResponse()); },
+      [=](const auto &) { return succeed(schema::AttachLidarSensorResponse()); },
+      [=](const auto &) { return succeed(schema::AttachDetectionSensorResponse()); },
+      [=](const auto &) { return succeed(schema::AttachOccupancyGridSensorResponse()); },
+      [=](const auto &) { return succeed(schema::UpdateTrafficLightsResponse()); },
+      [=](const auto &) { return succeed(schema::FollowPolylineTrajectoryResponse()); },
+      [=](const auto &) { return succeed(schema::AttachPseudoTrafficLightDetectorResponse()); });
+  }
+
+  auto TearDown() -> void override
+  {
+    rclcpp::shutdown();
+    server_.reset();
+  }
+
+private:
+  std::unique_ptr<zeromq::MultiServer> server_;
+};
+
+auto makeEntityStatusRequest(std::size_t entity_count)
+  -> simulation_api_schema::UpdateEntityStatusRequest
+{
+  simulation_api_schema::UpdateEntityStatusRequest request;
+  request.set_npc_logic_started(true);
+  for (std::size_t i = 0; i < entity_count; ++i) {
+    auto status = request.add_status();
+    status->set_name("entity" + std::to_string(i));
+    status->mutable_pose()->mutable_position()->set_x(static_cast<double>(i));
+    status->mutable_pose()->mutable_orientation()->set_w(1.0);
+    status->mutable_action_status()->set_current_action("follow_lane");
+  }
+  return request;
+}
+
+/**
+ * @brief Allocations per frame with the messages on arenas, and with the conversions done before,
+ * which made every message on the heap. The frame before is replayed without sockets, the
+ * allocations inside ZeroMQ are not counted in either.
+ * @return allocations per frame before and on arenas
+ */
+auto allocationsPerFrame(zeromq::MultiClient & client, std::size_t entity_count)
+  -> std::pair<std::size_t, std::size_t>
+{
+  constexpr std::size_t frame_count = 100;
+  const auto request = makeEntityStatusRequest(entity_count);
+  simulation_api_schema::UpdateFrameRequest update_frame_request;
+
+  auto measure = [&](auto && frame) {
+    frame();
+    const auto begin = allocation_count.load();
+    for (std::size_t i = 0; i < frame_count; ++i) {
+      frame();
+    }
+    return (allocation_count.load() - begin) / frame_count;
+  };
+
+  const auto before = measure([&]() {
+    auto exchange = [](const auto & sub_request, auto mutable_request, auto handled) {
+      simulation_api_schema::SimulationRequest simulation_request;
+      *(simulation_request.*mutable_request)() = sub_request;
+      const auto received = zeromq::toProto<simulation_api_schema::SimulationRequest>(
+        zeromq::toZMQ(simulation_request));
+      simulation_api_schema::SimulationResponse simulation_response;
+      handled(received, simulation_response);
+      return zeromq::toProto<simulation_api_schema::SimulationResponse>(
+        zeromq::toZMQ(simulation_response));
+    };
+    exchange(
+      request, &simulation_api_schema::SimulationRequest::mutable_update_entity_status,
+      [](const auto &, auto & response) {
+        response.mutable_update_entity_status()->mutable_result()->set_success(true);
+      })
+      .update_entity_status();
+    exchange(
+      update_frame_request, &simulation_api_schema::SimulationRequest::mutable_update_frame,
+      [](const auto &, auto & response) {
+        response.mutable_update_frame()->mutable_result()->set_success(true);
+      })
+      .update_frame();
+  });
+
+  const auto after = measure([&]() {
+    EXPECT_TRUE(client.call(request).result().success());
+    EXPECT_TRUE(client.call(update_frame_request).result().success());
+  });
+
+  return {before, after};
+}
+
+TEST(ArenaAllocation, FewerAllocationsPerFrame)
+{
+  zeromq::MultiClient client(simulation_interface::protocol, "localhost", port);
+  const auto [before, after] = allocationsPerFrame(client, 100);
+  EXPECT_LT(after, before);
+}
+
+/// @brief Allocations per frame for several entity counts, with and without the arena.
+TEST(ArenaAllocation, DISABLED_AllocationsPerFrame)
+{
+  zeromq::MultiClient client(simulation_interface::protocol, "localhost", port);
+  for (const std::size_t entity_count : {10, 100, 500}) {
+    const auto [before, after] = allocationsPerFrame(client, entity_count);
+    std::cout << entity_count << " entities: " << before << " allocations per frame before, "
+              << after << " allocations per frame on arenas" << std::endl;
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+  testing::InitGoogleTest(&argc, argv);
+  testing::AddGlobalTestEnvironment(new Server());
+  return RUN_ALL_TESTS();
+}
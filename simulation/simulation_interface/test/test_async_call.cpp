@@ -0,0 +1,136 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <rclcpp/rclcpp.hpp>
+#include <simulation_interface/zmq_multi_client.hpp>
+#include <simulation_interface/zmq_multi_server.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr unsigned int port = 5563;
+
+/// @note Time the server takes to update a frame, standing in for the sensor simulation.
+constexpr auto update_frame_duration = std::chrono::milliseconds(50);
+
+/// @note Names of the handlers called by the server, in the order they were called.
+std::vector<std::string> handled;
+
+template <typename Response>
+auto succeed(const std::string & name) -> Response
+{
+  handled.push_back(name);
+  Response response;
+  response.mutable_result()->set_success(true);
+  return response;
+}
+
+/**
+ * @brief Server answering every request, shut down with rclcpp after the last test, since
+ * MultiServer polls until rclcpp::ok() is false.
+ */
+class Server : public testing::Environment
+{
+public:
+  auto SetUp() -> void override
+  {
+    namespace schema = simulation_api_schema;
+    server_ = std::make_unique<zeromq::MultiServer>(
+      simulation_interface::protocol, simulation_interface::HostName::ANY, port,
+      [](const auto &) { return succeed<schema::InitializeResponse>("initialize"); },
+      [](const auto &) {
+        std::this_thread::sleep_for(update_frame_duration);
+        return succeed<schema::UpdateFrameResponse>("update_frame");
+      },
+      [](const auto &) { return succeed<schema::SpawnVehicleEntityResponse>("spawn"); },
+      [](const auto &) { return succeed<schema::SpawnPedestrianEntityResponse>("spawn"); },
+      [](const auto &) { return succeed<schema::SpawnMiscObjectEntityResponse>("spawn"); },
+      [](const auto &) { return succeed<schema::DespawnEntityResponse>("despawn"); },
+      [](const auto &) {
+        return succeed<schema::UpdateEntityStatusResponse>("update_entity_status");
+      },
+      [](const auto &) { return succeed<schema::AttachLidarSensorResponse>("attach"); },
+      [](const auto &) { return succeed<schema::AttachDetectionSensorResponse>("attach"); },
+      [](const auto &) { return succeed<schema::AttachOccupancyGridSensorResponse>("attach"); },
+      [](const auto &) {
+        return succeed<schema::UpdateTrafficLightsResponse>("update_traffic_lights");
+      },
+      [](const auto &) { return succeed<schema::FollowPolylineTrajectoryResponse>("follow"); },
+      [](const auto &) {
+        return succeed<schema::AttachPseudoTrafficLightDetectorResponse>("attach");
+      });
+  }
+
+  auto TearDown() -> void override
+  {
+    rclcpp::shutdown();
+    server_.reset();
+  }
+
+private:
+  std::unique_ptr<zeromq::MultiServer> server_;
+};
+
+TEST(AsyncCall, ReturnsResponse)
+{
+  zeromq::MultiClient client(simulation_interface::protocol, "localhost", port);
+  handled.clear();
+
+  auto response = client.callAsync(simulation_api_schema::UpdateFrameRequest());
+  EXPECT_TRUE(response.get().result().success());
+  EXPECT_EQ(handled, (std::vector<std::string>{"update_frame"}));
+}
+
+TEST(AsyncCall, KeepsOrderWithSynchronousCalls)
+{
+  zeromq::MultiClient client(simulation_interface::protocol, "localhost", port);
+  handled.clear();
+
+  auto update_entity_status =
+    client.callAsync(simulation_api_schema::UpdateEntityStatusRequest());
+  auto update_frame = client.callAsync(simulation_api_schema::UpdateFrameRequest());
+  EXPECT_TRUE(client.call(simulation_api_schema::DespawnEntityRequest()).result().success());
+  auto update_traffic_lights =
+    client.callAsync(simulation_api_schema::UpdateTrafficLightsRequest());
+
+  EXPECT_TRUE(update_traffic_lights.get().result().success());
+  EXPECT_TRUE(update_frame.get().result().success());
+  EXPECT_TRUE(update_entity_status.get().result().success());
+  EXPECT_EQ(
+    handled, (std::vector<std::string>{
+               "update_entity_status", "update_frame", "despawn", "update_traffic_lights"}));
+}
+
+TEST(AsyncCall, SendsPendingCallsOnClose)
+{
+  zeromq::MultiClient client(simulation_interface::protocol, "localhost", port);
+  handled.clear();
+
+  auto response = client.callAsync(simulation_api_schema::UpdateFrameRequest());
+  client.closeConnection();
+  EXPECT_TRUE(response.get().result().success());
+  EXPECT_EQ(handled, (std::vector<std::string>{"update_frame"}));
+}
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+  testing::InitGoogleTest(&argc, argv);
+  testing::AddGlobalTestEnvironment(new Server());
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,172 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <scenario_simulator_exception/exception.hpp>
+#include <simulation_interface/conversions.hpp>
+#include <simulation_interface/entity_status_delta.hpp>
+#include <string>
+#include <vector>
+
+auto makeEntityStatus(const std::string & name) -> traffic_simulator_msgs::msg::EntityStatus
+{
+  traffic_simulator_msgs::msg::EntityStatus status;
+  status.name = name;
+  status.type.type = traffic_simulator_msgs::msg::EntityType::VEHICLE;
+  status.subtype.value = traffic_simulator_msgs::msg::EntitySubtype::CAR;
+  status.bounding_box.dimensions.x = 4.0;
+  status.pose.position.x = 1.0;
+  status.action_status.twist.linear.x = 2.0;
+  status.action_status.current_action = "follow_lane";
+  return status;
+}
+
+TEST(EntityStatusDelta, FullStatusOnlyTheFirstTime)
+{
+  simulation_interface::EntityStatusDeltaEncoder encoder;
+  auto status = makeEntityStatus("npc");
+
+  simulation_api_schema::UpdateEntityStatusRequest first;
+  encoder.encode(status, first);
+  ASSERT_EQ(first.status_size(), 1);
+  EXPECT_EQ(first.status_delta_size(), 0);
+  EXPECT_NE(first.status(0).id(), 0u);
+  EXPECT_EQ(first.status(0).name(), "npc");
+
+  simulation_api_schema::UpdateEntityStatusRequest unchanged;
+  status.time = 0.1;
+  encoder.encode(status, unchanged);
+  EXPECT_EQ(unchanged.status_size(), 0);
+  EXPECT_EQ(unchanged.status_delta_size(), 0);
+
+  simulation_api_schema::UpdateEntityStatusRequest forced;
+  encoder.encode(status, forced, true);
+  ASSERT_EQ(forced.status_delta_size(), 1);
+  EXPECT_EQ(forced.status_delta(0).id(), first.status(0).id());
+  EXPECT_DOUBLE_EQ(forced.status_delta(0).time(), 0.1);
+  EXPECT_FALSE(forced.status_delta(0).has_pose());
+  EXPECT_FALSE(forced.status_delta(0).has_action_status());
+}
+
+TEST(EntityStatusDelta, OnlyChangedFields)
+{
+  simulation_interface::EntityStatusDeltaEncoder encoder;
+  auto status = makeEntityStatus("npc");
+  simulation_api_schema::UpdateEntityStatusRequest first;
+  encoder.encode(status, first);
+
+  simulation_api_schema::UpdateEntityStatusRequest moved;
+  status.time = 0.1;
+  status.pose.position.x = 1.5;
+  encoder.encode(status, moved);
+  ASSERT_EQ(moved.status_delta_size(), 1);
+  const auto & delta = moved.status_delta(0);
+  EXPECT_DOUBLE_EQ(delta.time(), 0.1);
+  EXPECT_DOUBLE_EQ(delta.pose().position().x(), 1.5);
+  EXPECT_FALSE(delta.has_action_status());
+}
+
+TEST(EntityStatusDelta, DecodeRecordsChangesOfTheSimulator)
+{
+  simulation_interface::EntityStatusDeltaEncoder encoder;
+  auto status = makeEntityStatus("ego");
+  simulation_api_schema::UpdateEntityStatusRequest first;
+  encoder.encode(status, first);
+
+  simulation_api_schema::EntityStatusDelta response;
+  response.set_id(first.status(0).id());
+  response.mutable_pose()->mutable_position()->set_x(3.0);
+  EXPECT_EQ(encoder.decode(response), "ego");
+
+  /// @note Sending back what the simulator sent is not a change.
+  simulation_api_schema::UpdateEntityStatusRequest unchanged;
+  simulation_interface::toMsg(response.pose(), status.pose);
+  encoder.encode(status, unchanged);
+  EXPECT_EQ(unchanged.status_delta_size(), 0);
+
+  response.set_id(first.status(0).id() + 1);
+  EXPECT_THROW(encoder.decode(response), common::SimulationError);
+}
+
+TEST(EntityStatusDelta, RespawnSendsFullStatusWithNewId)
+{
+  simulation_interface::EntityStatusDeltaEncoder encoder;
+  const auto status = makeEntityStatus("npc");
+  simulation_api_schema::UpdateEntityStatusRequest first;
+  encoder.encode(status, first);
+  encoder.erase("npc");
+
+  simulation_api_schema::UpdateEntityStatusRequest respawned;
+  encoder.encode(status, respawned);
+  ASSERT_EQ(respawned.status_size(), 1);
+  EXPECT_NE(respawned.status(0).id(), first.status(0).id());
+}
+
+/**
+ * @return Bytes of the requests of frame_count frames, in which 10% of the entities move.
+ */
+auto serializedSize(std::size_t entity_count, int frame_count, bool delta) -> std::size_t
+{
+  std::vector<traffic_simulator_msgs::msg::EntityStatus> statuses;
+  for (std::size_t i = 0; i < entity_count; ++i) {
+    statuses.push_back(makeEntityStatus("entity" + std::to_string(i)));
+  }
+  simulation_interface::EntityStatusDeltaEncoder encoder;
+  std::size_t bytes = 0;
+  for (int frame = 0; frame < frame_count; ++frame) {
+    simulation_api_schema::UpdateEntityStatusRequest request;
+    for (std::size_t i = 0; i < entity_count; ++i) {
+      statuses[i].time = frame * 0.05;
+      if (i % 10 == 0) {
+        statuses[i].pose.position.x += 0.1;
+      }
+      if (delta) {
+        encoder.encode(statuses[i], request);
+      } else {
+        simulation_interface::toProto(statuses[i], *request.add_status());
+      }
+    }
+    bytes += request.SerializeAsString().size();
+  }
+  return bytes;
+}
+
+TEST(EntityStatusDelta, SmallerThanFull)
+{
+  EXPECT_LT(serializedSize(500, 10, true), serializedSize(500, 10, false) / 2);
+}
+
+/// @brief Time and size of a full and a delta request, when 50 of 500 entities move per frame.
+TEST(EntityStatusDelta, DISABLED_Cost)
+{
+  constexpr std::size_t entity_count = 500;
+  constexpr int frame_count = 100;
+  for (const auto delta : {false, true}) {
+    const auto begin = std::chrono::steady_clock::now();
+    const auto bytes = serializedSize(entity_count, frame_count, delta);
+    const auto time =
+      std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << (delta ? "delta: " : "full: ") << time / frame_count << " us and "
+              << bytes / frame_count << " bytes per frame" << std::endl;
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
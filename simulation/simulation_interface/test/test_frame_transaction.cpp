@@ -0,0 +1,185 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <rclcpp/rclcpp.hpp>
+#include <simulation_interface/zmq_multi_client.hpp>
+#include <simulation_interface/zmq_multi_server.hpp>
+#include <string>
+#include <vector>
+
+constexpr unsigned int port = 5561;
+
+/// @note Names of the handlers called by the server, in the order they were called.
+std::vector<std::string> handled;
+
+template <typename Response>
+auto succeed(const std::string & name) -> Response
+{
+  handled.push_back(name);
+  Response response;
+  response.mutable_result()->set_success(true);
+  return response;
+}
+
+/**
+ * @brief Server answering every request, shut down with rclcpp after the last test, since
+ * MultiServer polls until rclcpp::ok() is false.
+ */
+class Server : public testing::Environment
+{
+public:
+  auto SetUp() -> void override
+  {
+    namespace schema = simulation_api_schema;
+    server_ = std::make_unique<zeromq::MultiServer>(
+      simulation_interface::protocol, simulation_interface::HostName::ANY, port,
+      [](const auto &) { return succeed<schema::InitializeResponse>("initialize"); },
+      [](const auto &) { return succeed<schema::UpdateFrameResponse>("update_frame"); },
+      [](const auto &) { return succeed<schema::SpawnVehicleEntityResponse>("spawn"); },
+      [](const auto &) { return succeed<schema::SpawnPedestrianEntityResponse>("spawn"); },
+      [](const auto &) { return succeed<schema::SpawnMiscObjectEntityResponse>("spawn"); },
+      [](const auto &) { return succeed<schema::DespawnEntityResponse>("despawn"); },
+      [](const schema::UpdateEntityStatusRequest & request) {
+        auto response = succeed<schema::UpdateEntityStatusResponse>("update_entity_status");
+        for (const auto & status : request.status()) {
+          auto updated_status = response.add_status();
+          updated_status->set_name(status.name());
+          *updated_status->mutable_pose() = status.pose();
+          *updated_status->mutable_action_status() = status.action_status();
+        }
+        return response;
+      },
+      [](const auto &) { return succeed<schema::AttachLidarSensorResponse>("attach"); },
+      [](const auto &) { return succeed<schema::AttachDetectionSensorResponse>("attach"); },
+      [](const auto &) { return succeed<schema::AttachOccupancyGridSensorResponse>("attach"); },
+      [](const auto &) {
+        return succeed<schema::UpdateTrafficLightsResponse>("update_traffic_lights");
+      },
+      [](const auto &) { return succeed<schema::FollowPolylineTrajectoryResponse>("follow"); },
+      [](const auto &) {
+        return succeed<schema::AttachPseudoTrafficLightDetectorResponse>("attach");
+      });
+  }
+
+  auto TearDown() -> void override
+  {
+    rclcpp::shutdown();
+    server_.reset();
+  }
+
+private:
+  std::unique_ptr<zeromq::MultiServer> server_;
+};
+
+auto makeEntityStatusRequest(std::size_t entity_count)
+  -> simulation_api_schema::UpdateEntityStatusRequest
+{
+  simulation_api_schema::UpdateEntityStatusRequest request;
+  request.set_npc_logic_started(true);
+  for (std::size_t i = 0; i < entity_count; ++i) {
+    auto status = request.add_status();
+    status->set_name("entity" + std::to_string(i));
+    status->mutable_pose()->mutable_position()->set_x(static_cast<double>(i));
+  }
+  return request;
+}
+
+auto makeTrafficLightsRequest() -> simulation_api_schema::UpdateTrafficLightsRequest
+{
+  simulation_api_schema::UpdateTrafficLightsRequest request;
+  request.add_states()->set_id(34802);
+  return request;
+}
+
+TEST(FrameTransaction, SameOrderAsSeparateRequests)
+{
+  zeromq::MultiClient client(simulation_interface::protocol, "localhost", port);
+  handled.clear();
+
+  simulation_api_schema::FrameTransactionRequest request;
+  *request.mutable_update_traffic_lights() = makeTrafficLightsRequest();
+  request.mutable_update_frame()->set_current_simulation_time(1.0);
+  *request.mutable_update_entity_status() = makeEntityStatusRequest(3);
+  const auto response = client.call(request);
+
+  EXPECT_TRUE(response.result().success());
+  EXPECT_EQ(
+    handled,
+    (std::vector<std::string>{"update_traffic_lights", "update_frame", "update_entity_status"}));
+  ASSERT_EQ(response.update_entity_status().status_size(), 3);
+  EXPECT_EQ(response.update_entity_status().status(2).name(), "entity2");
+}
+
+TEST(FrameTransaction, SkipsRequestsNotSet)
+{
+  zeromq::MultiClient client(simulation_interface::protocol, "localhost", port);
+  handled.clear();
+
+  simulation_api_schema::FrameTransactionRequest request;
+  *request.mutable_update_entity_status() = makeEntityStatusRequest(1);
+  EXPECT_TRUE(client.call(request).result().success());
+  EXPECT_EQ(handled, (std::vector<std::string>{"update_entity_status"}));
+}
+
+/// @brief Time per frame of one FrameTransactionRequest and of the three requests it replaces.
+TEST(FrameTransaction, DISABLED_Latency)
+{
+  zeromq::MultiClient client(simulation_interface::protocol, "localhost", port);
+  constexpr int frame_count = 1000;
+
+  for (const std::size_t entity_count : {1, 10, 100}) {
+    const auto entity_status_request = makeEntityStatusRequest(entity_count);
+    const auto traffic_lights_request = makeTrafficLightsRequest();
+    simulation_api_schema::UpdateFrameRequest update_frame_request;
+
+    auto measure = [&](auto && frame) {
+      const auto begin = std::chrono::steady_clock::now();
+      for (int i = 0; i < frame_count; ++i) {
+        frame();
+      }
+      return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin)
+               .count() /
+             frame_count;
+    };
+
+    const auto separate = measure([&]() {
+      EXPECT_TRUE(client.call(entity_status_request).result().success());
+      EXPECT_TRUE(client.call(traffic_lights_request).result().success());
+      EXPECT_TRUE(client.call(update_frame_request).result().success());
+    });
+
+    simulation_api_schema::FrameTransactionRequest transaction_request;
+    *transaction_request.mutable_update_traffic_lights() = traffic_lights_request;
+    *transaction_request.mutable_update_frame() = update_frame_request;
+    *transaction_request.mutable_update_entity_status() = entity_status_request;
+    const auto transaction = measure(
+      [&]() { EXPECT_TRUE(client.call(transaction_request).result().success()); });
+
+    std::cout << entity_count << " entities: " << separate << " us per frame in 3 requests, "
+              << transaction << " us per frame in 1 request" << std::endl;
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+  testing::InitGoogleTest(&argc, argv);
+  testing::AddGlobalTestEnvironment(new Server());
+  return RUN_ALL_TESTS();
+}
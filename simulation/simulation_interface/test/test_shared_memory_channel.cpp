@@ -0,0 +1,265 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <rclcpp/rclcpp.hpp>
+#include <scenario_simulator_exception/exception.hpp>
+#include <simulation_interface/shared_memory_channel.hpp>
+#include <simulation_interface/zmq_multi_client.hpp>
+#include <simulation_interface/zmq_multi_server.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+using simulation_interface::SharedMemoryChannel;
+using simulation_interface::TransportProtocol;
+
+constexpr unsigned int port = 5562;
+
+/**
+ * @brief One server for each transport, echoing the entity status it is sent. Shut down with
+ * rclcpp after the last test, since MultiServer polls until rclcpp::ok() is false.
+ */
+class Servers : public testing::Environment
+{
+public:
+  auto SetUp() -> void override
+  {
+    for (const auto protocol : {TransportProtocol::TCP, TransportProtocol::SHARED_MEMORY}) {
+      servers_.push_back(makeServer(protocol));
+    }
+  }
+
+  auto TearDown() -> void override
+  {
+    rclcpp::shutdown();
+    servers_.clear();
+  }
+
+private:
+  static auto makeServer(const TransportProtocol protocol) -> std::unique_ptr<zeromq::MultiServer>
+  {
+    namespace schema = simulation_api_schema;
+    return std::make_unique<zeromq::MultiServer>(
+      protocol, simulation_interface::HostName::ANY, port,
+      [](const auto &) { return schema::InitializeResponse(); },
+      [](const auto &) { return schema::UpdateFrameResponse(); },
+      [](const auto &) { return schema::SpawnVehicleEntityResponse(); },
+      [](const auto &) { return schema::SpawnPedestrianEntityResponse(); },
+      [](const auto &) { return schema::SpawnMiscObjectEntityResponse(); },
+      [](const auto &) { return schema::DespawnEntityResponse(); },
+      [](const schema::UpdateEntityStatusRequest & request) {
+        schema::UpdateEntityStatusResponse response;
+        response.mutable_result()->set_success(true);
+        for (const auto & status : request.status()) {
+          auto updated_status = response.add_status();
+          updated_status->set_name(status.name());
+          *updated_status->mutable_pose() = status.pose();
+        }
+        return response;
+      },
+      [](const auto &) { return schema::AttachLidarSensorResponse(); },
+      [](const auto &) { return schema::AttachDetectionSensorResponse(); },
+      [](const auto &) { return schema::AttachOccupancyGridSensorResponse(); },
+      [](const auto &) { return schema::UpdateTrafficLightsResponse(); },
+      [](const auto &) { return schema::FollowPolylineTrajectoryResponse(); },
+      [](const auto &) { return schema::AttachPseudoTrafficLightDetectorResponse(); });
+  }
+
+  std::vector<std::unique_ptr<zeromq::MultiServer>> servers_;
+};
+
+auto makeEntityStatusRequest(std::size_t entity_count)
+  -> simulation_api_schema::UpdateEntityStatusRequest
+{
+  simulation_api_schema::UpdateEntityStatusRequest request;
+  for (std::size_t i = 0; i < entity_count; ++i) {
+    auto status = request.add_status();
+    status->set_name("entity" + std::to_string(i));
+    status->mutable_pose()->mutable_position()->set_x(static_cast<double>(i));
+  }
+  return request;
+}
+
+TEST(SharedMemoryChannel, StreamsMessagesLargerThanTheRing)
+{
+  const std::string name = "/simulation_interface_test_shared_memory_channel";
+  /// @note The client waits for the server to create the segment.
+  std::thread client([&]() {
+    SharedMemoryChannel channel(name, SharedMemoryChannel::Side::CLIENT);
+    std::string message;
+    for (const std::size_t size : {0, 1, 4 << 20, 3}) {
+      channel.send(std::string(size, 'a'));
+      channel.receive(message);
+      EXPECT_EQ(message, std::string(size, 'b'));
+    }
+  });
+  SharedMemoryChannel channel(name, SharedMemoryChannel::Side::SERVER);
+  std::string message;
+  for (int i = 0; i < 4; ++i) {
+    channel.receive(message);
+    channel.send(std::string(message.size(), 'b'));
+  }
+  client.join();
+}
+
+TEST(SharedMemoryChannel, SameResponseAsZeroMQ)
+{
+  zeromq::MultiClient tcp_client(TransportProtocol::TCP, "localhost", port);
+  zeromq::MultiClient shared_memory_client(TransportProtocol::SHARED_MEMORY, "localhost", port);
+  const auto request = makeEntityStatusRequest(100);
+  EXPECT_EQ(
+    tcp_client.call(request).SerializeAsString(),
+    shared_memory_client.call(request).SerializeAsString());
+}
+
+TEST(SharedMemoryChannel, RejectsSecondClient)
+{
+  const auto request = makeEntityStatusRequest(1);
+  auto first_client =
+    std::make_unique<zeromq::MultiClient>(TransportProtocol::SHARED_MEMORY, "localhost", port);
+  first_client->call(request);
+  {
+    zeromq::MultiClient second_client(TransportProtocol::SHARED_MEMORY, "localhost", port);
+    EXPECT_THROW(second_client.call(request), common::SimulationError);
+    /// @note The first client keeps its claim.
+    EXPECT_EQ(first_client->call(request).status_size(), 1);
+  }
+  first_client.reset();
+  zeromq::MultiClient next_client(TransportProtocol::SHARED_MEMORY, "localhost", port);
+  EXPECT_EQ(next_client.call(request).status_size(), 1);
+}
+
+/// @brief Server side of a segment, echoing each message on its own thread until destruction.
+class EchoServer
+{
+public:
+  explicit EchoServer(const std::string & name)
+  : channel_(name, SharedMemoryChannel::Side::SERVER), thread_([this]() {
+      std::string message;
+      while (running_) {
+        if (channel_.receive(message, std::chrono::milliseconds(10))) {
+          channel_.send(message);
+        }
+      }
+    })
+  {
+  }
+
+  ~EchoServer()
+  {
+    running_ = false;
+    thread_.join();
+  }
+
+private:
+  std::atomic<bool> running_ = true;
+
+  SharedMemoryChannel channel_;
+
+  std::thread thread_;
+};
+
+auto roundTrip(SharedMemoryChannel & client, const std::string & request) -> std::string
+{
+  std::string message;
+  client.send(request);
+  client.receive(message);
+  return message;
+}
+
+TEST(SharedMemoryChannel, ReopensSegmentOfRestartedServer)
+{
+  const std::string name = "/simulation_interface_test_restarted_server";
+  auto server = std::make_unique<EchoServer>(name);
+  SharedMemoryChannel client(name, SharedMemoryChannel::Side::CLIENT);
+  EXPECT_EQ(roundTrip(client, "a"), "a");
+  EXPECT_FALSE(client.reopen());
+
+  /// @note A server which did not shut down, like a crashed one, is detected by its session id.
+  auto crashed_server = std::move(server);
+  server = std::make_unique<EchoServer>(name);
+  EXPECT_TRUE(client.reopen());
+  EXPECT_FALSE(client.reopen());
+  EXPECT_EQ(roundTrip(client, "b"), "b");
+
+  /// @note The previous server does not remove the segment of the new one.
+  crashed_server.reset();
+  EXPECT_FALSE(client.reopen());
+  EXPECT_EQ(roundTrip(client, "c"), "c");
+
+  /// @note A server which shut down is detected on the next send.
+  server.reset();
+  server = std::make_unique<EchoServer>(name);
+  EXPECT_EQ(roundTrip(client, "d"), "d");
+}
+
+TEST(SharedMemoryChannel, TakesOverClaimOfDeadClient)
+{
+  const std::string name = "/simulation_interface_test_dead_client";
+  EchoServer server(name);
+  /// @note The child dies without reading the response, which stays in the ring.
+  const auto child = fork();
+  if (child == 0) {
+    SharedMemoryChannel client(name, SharedMemoryChannel::Side::CLIENT);
+    client.send("a");
+    _exit(0);
+  }
+  ASSERT_GT(child, 0);
+  ASSERT_EQ(waitpid(child, nullptr, 0), child);
+  SharedMemoryChannel client(name, SharedMemoryChannel::Side::CLIENT);
+  EXPECT_EQ(roundTrip(client, "b"), "b");
+  EXPECT_EQ(roundTrip(client, "c"), "c");
+}
+
+/// @brief Round trip latency and entity status throughput of each transport.
+TEST(SharedMemoryChannel, DISABLED_LatencyAndThroughput)
+{
+  for (const auto protocol : {TransportProtocol::TCP, TransportProtocol::SHARED_MEMORY}) {
+    zeromq::MultiClient client(protocol, "localhost", port);
+
+    auto measure = [&](const auto & request, int count) {
+      const auto begin = std::chrono::steady_clock::now();
+      for (int i = 0; i < count; ++i) {
+        client.call(request);
+      }
+      return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count() /
+             count;
+    };
+
+    const auto latency = measure(simulation_api_schema::UpdateFrameRequest(), 10000);
+    const auto request = makeEntityStatusRequest(1000);
+    const auto bytes = 2.0 * request.ByteSizeLong();
+    const auto time = measure(request, 200);
+
+    std::cout << simulation_interface::enumToString(protocol) << ": " << latency * 1e6
+              << " us per round trip, " << bytes / time / (1 << 20)
+              << " MiB/s with 1000 entities" << std::endl;
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+  testing::InitGoogleTest(&argc, argv);
+  testing::AddGlobalTestEnvironment(new Servers());
+  return RUN_ALL_TESTS();
+}
@@ -21,15 +21,18 @@
 #include <autoware_auto_vehicle_msgs/msg/vehicle_state_command.hpp>
 #include <boost/variant.hpp>
 #include <cassert>
+#include <future>
 #include <memory>
 #include <optional>
 #include <rclcpp/rclcpp.hpp>
 #include <rosgraph_msgs/msg/clock.hpp>
 #include <simulation_interface/conversions.hpp>
+#include <simulation_interface/entity_status_delta.hpp>
 #include <simulation_interface/zmq_multi_client.hpp>
 #include <stdexcept>
 #include <string>
 #include <traffic_simulator/api/configuration.hpp>
+#include <traffic_simulator/data_type/entity_handle.hpp>
 #include <traffic_simulator/data_type/entity_status.hpp>
 #include <traffic_simulator/data_type/lane_change.hpp>
 #include <traffic_simulator/data_type/lanelet_pose.hpp>
@@ -76,7 +79,7 @@ public:
       node, "debug_marker", rclcpp::QoS(100), rclcpp::PublisherOptionsWithAllocator<AllocatorT>())),
     clock_(std::forward<decltype(xs)>(xs)...),
     zeromq_client_(
-      simulation_interface::protocol, configuration.simulator_host, getZMQSocketPort(*node))
+      getTransportProtocol(*node), configuration.simulator_host, getZMQSocketPort(*node))
   {
     setVerbose(configuration.verbose);
 
@@ -101,7 +104,20 @@ public:
     return node.get_parameter("port").as_int();
   }
 
-  void closeZMQConnection() { zeromq_client_.closeConnection(); }
+  /// @note "shm" connects to a simulator on the same host through shared memory.
+  template <typename Node>
+  auto getTransportProtocol(Node & node) -> simulation_interface::TransportProtocol
+  {
+    if (!node.has_parameter("transport_protocol")) {
+      node.template declare_parameter<std::string>("transport_protocol", "tcp");
+    }
+    return simulation_interface::stringToTransportProtocol(
+      node.get_parameter("transport_protocol").as_string());
+  }
+
+  ~API();
+
+  void closeZMQConnection();
 
   void setVerbose(const bool verbose);
 
@@ -114,9 +130,10 @@ public:
   {
     auto register_to_entity_manager = [&]() {
       if (behavior == VehicleBehavior::autoware()) {
-        return entity_manager_ptr_->entityExists(name) or
-               entity_manager_ptr_->spawnEntity<entity::EgoEntity>(
-                 name, pose, parameters, configuration);
+        return entity_manager_ptr_->entityExists(name)
+                 ? entity_manager_ptr_->getEntityHandle(name)
+                 : entity_manager_ptr_->spawnEntity<entity::EgoEntity>(
+                     name, pose, parameters, configuration);
       } else {
         return entity_manager_ptr_->spawnEntity<entity::VehicleEntity>(
           name, pose, parameters, behavior);
@@ -135,11 +152,11 @@ public:
         req.set_is_ego(behavior == VehicleBehavior::autoware());
         /// @todo Should be filled from function API
         req.set_initial_speed(0.0);
-        return zeromq_client_.call(req).result().success();
+        return call(req).result().success();
       }
     };
 
-    return register_to_entity_manager() and register_to_environment_simulator();
+    return spawned(register_to_entity_manager(), register_to_environment_simulator);
   }
 
   geometry_msgs::msg::Pose toMapPose(const geometry_msgs::msg::Pose & pose) { return pose; }
@@ -170,11 +187,11 @@ public:
         req.mutable_parameters()->set_name(name);
         req.set_asset_key(model3d);
         simulation_interface::toProto(toMapPose(pose), *req.mutable_pose());
-        return zeromq_client_.call(req).result().success();
+        return call(req).result().success();
       }
     };
 
-    return register_to_entity_manager() and register_to_environment_simulator();
+    return spawned(register_to_entity_manager(), register_to_environment_simulator);
   }
 
   template <typename Pose>
@@ -196,11 +213,11 @@ public:
         req.mutable_parameters()->set_name(name);
         req.set_asset_key(model3d);
         simulation_interface::toProto(toMapPose(pose), *req.mutable_pose());
-        return zeromq_client_.call(req).result().success();
+        return call(req).result().success();
       }
     };
 
-    return register_to_entity_manager() and register_to_environment_simulator();
+    return spawned(register_to_entity_manager(), register_to_environment_simulator);
   }
 
   bool despawn(const std::string & name);
@@ -291,6 +308,7 @@ public:
   FORWARD_TO_ENTITY_MANAGER(cancelRequest);
   FORWARD_TO_ENTITY_MANAGER(checkCollision);
   FORWARD_TO_ENTITY_MANAGER(entityExists);
+  FORWARD_TO_ENTITY_MANAGER(forEachEntity);
   FORWARD_TO_ENTITY_MANAGER(getBehaviorParameter);
   FORWARD_TO_ENTITY_MANAGER(getBoundingBox);
   FORWARD_TO_ENTITY_MANAGER(getBoundingBoxDistance);
@@ -304,6 +322,8 @@ public:
   FORWARD_TO_ENTITY_MANAGER(getDistanceToLeftLaneBound);
   FORWARD_TO_ENTITY_MANAGER(getDistanceToRightLaneBound);
   FORWARD_TO_ENTITY_MANAGER(getEgoName);
+  FORWARD_TO_ENTITY_MANAGER(getEntityHandle);
+  FORWARD_TO_ENTITY_MANAGER(getEntityName);
   FORWARD_TO_ENTITY_MANAGER(getEntityNames);
   FORWARD_TO_ENTITY_MANAGER(getEntityStatus);
   FORWARD_TO_ENTITY_MANAGER(getEntityStatusBeforeUpdate);
@@ -356,8 +376,55 @@ private:
 
   bool updateEntitiesStatusInSim();
 
+  bool receiveEntitiesStatusInSim();
+
   bool updateTrafficLightsInSim();
 
+  /// @note The handle is returned only when the environment simulator spawned the entity too.
+  template <typename RegisterToEnvironmentSimulator>
+  static auto spawned(
+    const EntityHandle handle, RegisterToEnvironmentSimulator && register_to_environment_simulator)
+    -> std::optional<EntityHandle>
+  {
+    if (register_to_environment_simulator()) {
+      return handle;
+    } else {
+      return std::nullopt;
+    }
+  }
+
+  /// @note With Configuration::frame_transaction, the traffic lights and the time of a frame wait
+  /// for the entity status of the next frame, see updateEntitiesStatusInSim. They are sent alone
+  /// if anything else is sent to the simulator first.
+  bool flushFrameTransaction();
+
+  /// @note Any request other than the ones of a frame, sent after the rest of the last frame.
+  template <typename Request>
+  auto call(const Request & request)
+  {
+    if (not flushFrameTransaction()) {
+      decltype(zeromq_client_.call(request)) response;
+      response.mutable_result()->set_success(false);
+      response.mutable_result()->set_description("Failed to update the previous frame");
+      return response;
+    }
+    return zeromq_client_.call(request);
+  }
+
+  /// @note Sent without waiting for the response if the frame is pipelined, otherwise sent on the
+  /// calling thread when the response is taken.
+  template <typename Request>
+  auto callInFrame(Request && request)
+  {
+    if (configuration.pipelined_update_frame) {
+      return zeromq_client_.callAsync(request);
+    } else {
+      return std::async(std::launch::deferred, [this, request = std::forward<Request>(request)]() {
+        return zeromq_client_.call(request);
+      });
+    }
+  }
+
   const Configuration configuration;
 
   const std::shared_ptr<entity::EntityManager> entity_manager_ptr_;
@@ -371,6 +438,16 @@ private:
   SimulationClock clock_;
 
   zeromq::MultiClient zeromq_client_;
+
+  simulation_api_schema::FrameTransactionRequest frame_transaction_;
+
+  simulation_interface::EntityStatusDeltaEncoder entity_status_encoder_;
+
+  std::future<simulation_api_schema::UpdateEntityStatusResponse> entity_status_response_;
+
+  std::future<simulation_api_schema::UpdateTrafficLightsResponse> traffic_lights_response_;
+
+  std::future<simulation_api_schema::UpdateFrameResponse> update_frame_response_;
 };
 }  // namespace traffic_simulator
 
@@ -20,6 +20,7 @@
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/operations.hpp>
 #include <boost/range/iterator_range.hpp>
+#include <cstddef>
 #include <iomanip>
 #include <scenario_simulator_exception/exception.hpp>
 #include <string>
@@ -44,6 +45,52 @@ struct Configuration
 
   double v2i_traffic_light_publish_rate = 10.0;
 
+  /// @note 0 disables the precomputed lanelet distance table of getLongitudinalDistance.
+  std::size_t lanelet_distance_table_hop_limit = 0;
+
+  std::size_t lanelet_distance_table_max_entries = 1 << 24;
+
+  /// @note Directory of the precompiled map, see hdmap_utils::MapCache. Empty disables it, for
+  /// example hdmap_utils::MapCache::defaultDirectory() enables it.
+  Pathname map_cache_directory = "";
+
+  /// @note Share one instance of the map with the other users of it, see HdMapUtils::shared.
+  bool share_map = false;
+
+  /// @note Threads updating the NPCs, 1 updates them one after another on the calling thread.
+  std::size_t npc_update_thread_count = 1;
+
+  /// @note Send the traffic lights and the time of a frame with the entity status of the next
+  /// frame in one FrameTransactionRequest, instead of sending them in three requests. They are
+  /// sent alone before any other request and when the connection is closed.
+  bool frame_transaction = false;
+
+  /// @note Send the status of an entity in full once, then only its dynamic fields which changed,
+  /// see simulation_interface::EntityStatusDeltaEncoder.
+  bool delta_entity_status = false;
+
+  /// @note Send only the traffic lights which changed, instead of all of them when any changed.
+  bool delta_traffic_lights = false;
+
+  /// @note Send the requests of a frame without waiting for the responses, so that the simulator
+  /// updates the sensors of a frame while the entities of the next frame are updated. The status
+  /// the simulator answers for the ego is applied one frame later, see API::updateFrame.
+  bool pipelined_update_frame = false;
+
+  /// @note Maximum rate of the transform of each entity, 0 broadcasts it every frame.
+  double entity_transform_publish_rate = 0.0;
+
+  /// @note Broadcast the transform of the ego only, instead of the transforms of every entity.
+  bool ego_transform_only = false;
+
+  /// @note Send the entity transforms of a frame in one message from a background thread, instead
+  /// of one message per entity from the frame loop.
+  bool batched_entity_transform = false;
+
+  /// @note Maximum rate of the entity/status topic, 0 publishes it every frame. It is not
+  /// published at all while nobody subscribes to it.
+  double entity_status_publish_rate = 0.0;
+
   /* ---- NOTE -----------------------------------------------------------------
    *
    *  This setting comes from the argument of the same name (= `map_path`) in
@@ -20,6 +20,7 @@
 #include <traffic_simulator/behavior/follow_trajectory.hpp>
 #include <traffic_simulator/data_type/behavior.hpp>
 #include <traffic_simulator/data_type/entity_status.hpp>
+#include <traffic_simulator/data_type/entity_status_snapshot.hpp>
 #include <traffic_simulator/hdmap_utils/hdmap_utils.hpp>
 #include <traffic_simulator/traffic_lights/traffic_light_manager.hpp>
 #include <traffic_simulator_msgs/msg/behavior_parameter.hpp>
@@ -34,8 +35,7 @@
 namespace entity_behavior
 {
 using EntityTypeDict = std::unordered_map<std::string, traffic_simulator_msgs::msg::EntityType>;
-using EntityStatusDict =
-  std::unordered_map<std::string, traffic_simulator::CanonicalizedEntityStatus>;
+using EntityStatusDict = traffic_simulator::OtherEntityStatusView;
 
 class BehaviorPluginBase
 {
@@ -0,0 +1,70 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TRAFFIC_SIMULATOR__DATA_TYPE__ENTITY_HANDLE_HPP_
+#define TRAFFIC_SIMULATOR__DATA_TYPE__ENTITY_HANDLE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace traffic_simulator
+{
+/**
+ * @brief Dense integer id of an entity, given by EntityManager::spawnEntity in the order of
+ * spawning. It stays valid for the lifetime of the EntityManager, because the name of a despawned
+ * entity is never reused.
+ */
+class EntityHandle
+{
+  std::uint32_t index_;
+
+public:
+  constexpr explicit EntityHandle(std::size_t index) noexcept
+  : index_(static_cast<std::uint32_t>(index))
+  {
+  }
+
+  constexpr auto index() const noexcept -> std::size_t { return index_; }
+
+  friend constexpr auto operator==(EntityHandle lhs, EntityHandle rhs) noexcept -> bool
+  {
+    return lhs.index_ == rhs.index_;
+  }
+
+  friend constexpr auto operator!=(EntityHandle lhs, EntityHandle rhs) noexcept -> bool
+  {
+    return lhs.index_ != rhs.index_;
+  }
+
+  friend constexpr auto operator<(EntityHandle lhs, EntityHandle rhs) noexcept -> bool
+  {
+    return lhs.index_ < rhs.index_;
+  }
+};
+}  // namespace traffic_simulator
+
+namespace std
+{
+template <>
+struct hash<traffic_simulator::EntityHandle>
+{
+  auto operator()(traffic_simulator::EntityHandle handle) const noexcept -> std::size_t
+  {
+    return handle.index();
+  }
+};
+}  // namespace std
+
+#endif  // TRAFFIC_SIMULATOR__DATA_TYPE__ENTITY_HANDLE_HPP_
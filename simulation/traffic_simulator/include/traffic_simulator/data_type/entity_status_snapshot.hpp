@@ -0,0 +1,178 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TRAFFIC_SIMULATOR__DATA_TYPE__ENTITY_STATUS_SNAPSHOT_HPP_
+#define TRAFFIC_SIMULATOR__DATA_TYPE__ENTITY_STATUS_SNAPSHOT_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <traffic_simulator/data_type/entity_status.hpp>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace traffic_simulator
+{
+inline namespace entity_status
+{
+/**
+ * @brief Read-only statuses of every entity at one frame, shared by all entities.
+ * Statuses are stored contiguously and indexed by a dense id, which is the order in which the
+ * statuses were given to the constructor.
+ */
+class EntityStatusSnapshot
+{
+public:
+  using value_type = std::pair<const std::string, CanonicalizedEntityStatus>;
+
+  using const_iterator = std::vector<value_type>::const_iterator;
+
+  EntityStatusSnapshot() = default;
+
+  explicit EntityStatusSnapshot(std::uint64_t frame, std::vector<value_type> && statuses);
+
+  auto frame() const noexcept -> std::uint64_t { return frame_; }
+
+  auto size() const noexcept -> std::size_t { return statuses_.size(); }
+
+  auto begin() const noexcept -> const_iterator { return statuses_.begin(); }
+
+  auto end() const noexcept -> const_iterator { return statuses_.end(); }
+
+  auto operator[](std::size_t id) const -> const value_type & { return statuses_[id]; }
+
+  auto findId(const std::string & name) const -> std::optional<std::size_t>;
+
+private:
+  std::uint64_t frame_ = 0;
+
+  std::vector<value_type> statuses_;
+
+  std::unordered_map<std::string, std::size_t> ids_;
+};
+
+/**
+ * @brief Statuses of every entity in a snapshot except one, copied in constant time.
+ * Provides the lookup and iteration interface of
+ * std::unordered_map<std::string, CanonicalizedEntityStatus> it replaces.
+ */
+class OtherEntityStatusView
+{
+public:
+  using key_type = std::string;
+
+  using mapped_type = CanonicalizedEntityStatus;
+
+  using value_type = EntityStatusSnapshot::value_type;
+
+  class const_iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = EntityStatusSnapshot::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type *;
+    using reference = const value_type &;
+
+    const_iterator() = default;
+
+    explicit const_iterator(
+      EntityStatusSnapshot::const_iterator iterator, EntityStatusSnapshot::const_iterator skipped,
+      EntityStatusSnapshot::const_iterator end)
+    : iterator_(iterator), skipped_(skipped), end_(end)
+    {
+      skip();
+    }
+
+    auto operator*() const -> reference { return *iterator_; }
+
+    auto operator->() const -> pointer { return &*iterator_; }
+
+    auto operator++() -> const_iterator &
+    {
+      ++iterator_;
+      skip();
+      return *this;
+    }
+
+    auto operator++(int) -> const_iterator
+    {
+      auto copy = *this;
+      ++*this;
+      return copy;
+    }
+
+    auto operator==(const const_iterator & other) const -> bool
+    {
+      return iterator_ == other.iterator_;
+    }
+
+    auto operator!=(const const_iterator & other) const -> bool { return not(*this == other); }
+
+  private:
+    auto skip() -> void
+    {
+      if (iterator_ != end_ and iterator_ == skipped_) {
+        ++iterator_;
+      }
+    }
+
+    EntityStatusSnapshot::const_iterator iterator_;
+
+    EntityStatusSnapshot::const_iterator skipped_;
+
+    EntityStatusSnapshot::const_iterator end_;
+  };
+
+  using iterator = const_iterator;
+
+  OtherEntityStatusView() = default;
+
+  explicit OtherEntityStatusView(
+    const std::shared_ptr<const EntityStatusSnapshot> &, const std::string & excluded_name);
+
+  auto frame() const noexcept -> std::uint64_t { return snapshot_ ? snapshot_->frame() : 0; }
+
+  auto begin() const -> const_iterator;
+
+  auto end() const -> const_iterator;
+
+  auto find(const std::string & name) const -> const_iterator;
+
+  auto at(const std::string & name) const -> const CanonicalizedEntityStatus &;
+
+  auto count(const std::string & name) const -> std::size_t { return find(name) != end(); }
+
+  auto size() const noexcept -> std::size_t;
+
+  auto empty() const noexcept -> bool { return size() == 0; }
+
+private:
+  static constexpr auto none = std::numeric_limits<std::size_t>::max();
+
+  auto skipped() const -> EntityStatusSnapshot::const_iterator;
+
+  std::shared_ptr<const EntityStatusSnapshot> snapshot_;
+
+  std::size_t excluded_id_ = none;
+};
+}  // namespace entity_status
+}  // namespace traffic_simulator
+
+#endif  // TRAFFIC_SIMULATOR__DATA_TYPE__ENTITY_STATUS_SNAPSHOT_HPP_
@@ -18,6 +18,7 @@
 #include <iostream>
 #include <scenario_simulator_exception/exception.hpp>
 #include <traffic_simulator/data_type/entity_status.hpp>
+#include <traffic_simulator/data_type/entity_status_snapshot.hpp>
 
 namespace traffic_simulator
 {
@@ -60,8 +61,7 @@ struct RelativeTargetSpeed
   {
   }
   double getAbsoluteValue(
-    const CanonicalizedEntityStatus & status,
-    const std::unordered_map<std::string, CanonicalizedEntityStatus> & other_status) const;
+    const CanonicalizedEntityStatus & status, const OtherEntityStatusView & other_status) const;
   std::string reference_entity_name;
   Type type;
   double value;
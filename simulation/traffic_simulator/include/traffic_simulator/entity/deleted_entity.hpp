@@ -42,8 +42,11 @@ public:
 
   auto getEntityType() const -> const traffic_simulator_msgs::msg::EntityType & override
   {
-    static traffic_simulator_msgs::msg::EntityType type;
-    type.type = ENTITY_TYPE_ID;  // Dummy ID for internal use
+    static const auto type = []() {
+      traffic_simulator_msgs::msg::EntityType type;
+      type.type = ENTITY_TYPE_ID;  // Dummy ID for internal use
+      return type;
+    }();
     return type;
   }
 
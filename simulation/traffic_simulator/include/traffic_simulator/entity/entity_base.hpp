@@ -25,6 +25,7 @@
 #include <traffic_simulator/behavior/follow_trajectory.hpp>
 #include <traffic_simulator/behavior/longitudinal_speed_planning.hpp>
 #include <traffic_simulator/data_type/entity_status.hpp>
+#include <traffic_simulator/data_type/entity_status_snapshot.hpp>
 #include <traffic_simulator/data_type/lane_change.hpp>
 #include <traffic_simulator/data_type/speed_change.hpp>
 #include <traffic_simulator/hdmap_utils/hdmap_utils.hpp>
@@ -202,7 +203,7 @@ public:
   /*   */ void setEntityTypeList(
     const std::unordered_map<std::string, traffic_simulator_msgs::msg::EntityType> &);
 
-  /*   */ void setOtherStatus(const std::unordered_map<std::string, CanonicalizedEntityStatus> &);
+  /*   */ void setOtherStatus(const std::shared_ptr<const EntityStatusSnapshot> &);
 
   virtual auto setStatus(const CanonicalizedEntityStatus &) -> void;
 
@@ -248,7 +249,7 @@ protected:
   double stand_still_duration_ = 0.0;
   double traveled_distance_ = 0.0;
 
-  std::unordered_map<std::string, CanonicalizedEntityStatus> other_status_;
+  OtherEntityStatusView other_status_;
   std::unordered_map<std::string, traffic_simulator_msgs::msg::EntityType> entity_type_list_;
 
   std::optional<double> target_speed_;
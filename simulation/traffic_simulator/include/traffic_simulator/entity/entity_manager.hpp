@@ -20,6 +20,8 @@
 #include <tf2_ros/transform_broadcaster.h>
 
 #include <autoware_perception_msgs/msg/traffic_signal_array.hpp>
+#include <cstdint>
+#include <iostream>
 #include <memory>
 #include <optional>
 #include <rclcpp/node_interfaces/get_node_topics_interface.hpp>
@@ -30,15 +32,20 @@
 #include <string>
 #include <tf2_geometry_msgs/tf2_geometry_msgs.hpp>
 #include <traffic_simulator/api/configuration.hpp>
+#include <traffic_simulator/data_type/entity_handle.hpp>
+#include <traffic_simulator/data_type/entity_status_snapshot.hpp>
 #include <traffic_simulator/data_type/lane_change.hpp>
 #include <traffic_simulator/data_type/speed_change.hpp>
 #include <traffic_simulator/entity/deleted_entity.hpp>
 #include <traffic_simulator/entity/ego_entity.hpp>
 #include <traffic_simulator/entity/entity_base.hpp>
+#include <traffic_simulator/entity/entity_status_array_publisher.hpp>
+#include <traffic_simulator/entity/entity_transform_broadcaster.hpp>
 #include <traffic_simulator/entity/misc_object_entity.hpp>
 #include <traffic_simulator/entity/pedestrian_entity.hpp>
 #include <traffic_simulator/entity/vehicle_entity.hpp>
 #include <traffic_simulator/hdmap_utils/hdmap_utils.hpp>
+#include <traffic_simulator/helper/worker_pool.hpp>
 #include <traffic_simulator/traffic/traffic_sink.hpp>
 #include <traffic_simulator/traffic_lights/configurable_rate_updater.hpp>
 #include <traffic_simulator/traffic_lights/traffic_light_marker_publisher.hpp>
@@ -90,19 +97,32 @@ class EntityManager
   tf2_ros::StaticTransformBroadcaster broadcaster_;
   tf2_ros::TransformBroadcaster base_link_broadcaster_;
 
+  EntityTransformBroadcaster entity_transform_broadcaster_;
+
   const rclcpp::Clock::SharedPtr clock_ptr_;
 
   std::unordered_map<std::string, std::unique_ptr<traffic_simulator::entity::EntityBase>> entities_;
 
+  /// @note Indexed by EntityHandle. The elements of entities_ are never erased (a despawned entity
+  /// is replaced by a DeletedEntity), so these pointers stay valid.
+  std::vector<decltype(entities_)::value_type *> entity_slots_;
+
+  std::unordered_map<std::string, EntityHandle> entity_handles_;
+
   double step_time_;
 
   double current_time_;
 
   bool npc_logic_started_;
 
+  /// @note Incremented for each snapshot of the entity statuses shared with the entities.
+  std::uint64_t entity_status_frame_ = 0;
+
+  helper::WorkerPool npc_update_pool_;
+
   using EntityStatusWithTrajectoryArray =
     traffic_simulator_msgs::msg::EntityStatusWithTrajectoryArray;
-  const rclcpp::Publisher<EntityStatusWithTrajectoryArray>::SharedPtr entity_status_array_pub_ptr_;
+  EntityStatusArrayPublisher entity_status_array_publisher_;
 
   using MarkerArray = visualization_msgs::msg::MarkerArray;
   const rclcpp::Publisher<MarkerArray>::SharedPtr lanelet_marker_pub_ptr_;
@@ -115,14 +135,25 @@ class EntityManager
   const std::shared_ptr<TrafficLightMarkerPublisher>
     conventional_traffic_light_marker_publisher_ptr_;
 
+  /// @note The conventional traffic lights as last sent to the simulator.
+  TrafficLightManager::ChangeTracker conventional_traffic_lights_sent_;
+
   const std::shared_ptr<TrafficLightManager> v2i_traffic_light_manager_ptr_;
   const std::shared_ptr<TrafficLightMarkerPublisher> v2i_traffic_light_marker_publisher_ptr_;
   const std::shared_ptr<TrafficLightPublisherBase> v2i_traffic_light_publisher_ptr_;
   ConfigurableRateUpdater v2i_traffic_light_updater_, conventional_traffic_light_updater_;
 
+  auto getEntity(const EntityHandle) const -> EntityBase &;
+
+  static auto isDeleted(const EntityBase & entity) -> bool
+  {
+    return entity.getEntityType().type == DeletedEntity::ENTITY_TYPE_ID;
+  }
+
 public:
+  /// @note Also used by the other users of a shared map, which must key it by the same origin.
   template <typename Node>
-  auto getOrigin(Node & node) const
+  static auto getOrigin(Node & node)
   {
     geographic_msgs::msg::GeoPoint origin;
     {
@@ -161,17 +192,28 @@ public:
     node_topics_interface(rclcpp::node_interfaces::get_node_topics_interface(node)),
     broadcaster_(node),
     base_link_broadcaster_(node),
+    entity_transform_broadcaster_(
+      broadcaster_, EntityTransformBroadcaster::Policy{
+              configuration.entity_transform_publish_rate, configuration.ego_transform_only,
+              configuration.batched_entity_transform}),
     clock_ptr_(node->get_clock()),
     current_time_(std::numeric_limits<double>::quiet_NaN()),
     npc_logic_started_(false),
-    entity_status_array_pub_ptr_(rclcpp::create_publisher<EntityStatusWithTrajectoryArray>(
-      node, "entity/status", EntityMarkerQoS(),
-      rclcpp::PublisherOptionsWithAllocator<AllocatorT>())),
+    npc_update_pool_(configuration.npc_update_thread_count),
+    entity_status_array_publisher_(
+      rclcpp::create_publisher<EntityStatusWithTrajectoryArray>(
+        node, "entity/status", EntityMarkerQoS(),
+        rclcpp::PublisherOptionsWithAllocator<AllocatorT>()),
+      configuration.entity_status_publish_rate),
     lanelet_marker_pub_ptr_(rclcpp::create_publisher<MarkerArray>(
       node, "lanelet/marker", LaneletMarkerQoS(),
       rclcpp::PublisherOptionsWithAllocator<AllocatorT>())),
-    hdmap_utils_ptr_(std::make_shared<hdmap_utils::HdMapUtils>(
-      configuration.lanelet2_map_path(), getOrigin(*node))),
+    hdmap_utils_ptr_(
+      configuration.share_map
+        ? hdmap_utils::HdMapUtils::shared(configuration.lanelet2_map_path(), getOrigin(*node))
+        : std::make_shared<hdmap_utils::HdMapUtils>(
+            configuration.lanelet2_map_path(), getOrigin(*node),
+            configuration.map_cache_directory)),
     markers_raw_(hdmap_utils_ptr_->generateMarker()),
     conventional_traffic_light_manager_ptr_(
       std::make_shared<TrafficLightManager>(hdmap_utils_ptr_)),
@@ -192,6 +234,15 @@ public:
     conventional_traffic_light_updater_(
       node, [this]() { conventional_traffic_light_marker_publisher_ptr_->publish(); })
   {
+    if (configuration.lanelet_distance_table_hop_limit > 0) {
+      const auto & table = hdmap_utils_ptr_->buildLaneletDistanceTable(
+        configuration.lanelet_distance_table_hop_limit,
+        configuration.lanelet_distance_table_max_entries);
+      if (configuration.verbose) {
+        std::cout << "lanelet distance table : " << table.size() << " entries, "
+                  << table.memoryUsage() << " bytes" << std::endl;
+      }
+    }
     updateHdmapMarker();
   }
 
@@ -217,9 +268,11 @@ public:
 
 #undef FORWARD_GETTER_TO_TRAFFIC_LIGHT_MANAGER
 
+  /// @note Only called when trafficLightsChanged, and takes the changes.
   auto generateUpdateRequestForConventionalTrafficLights()
   {
-    return conventional_traffic_light_manager_ptr_->generateUpdateTrafficLightsRequest();
+    return conventional_traffic_light_manager_ptr_->generateUpdateTrafficLightsRequest(
+      conventional_traffic_lights_sent_, configuration.delta_traffic_lights);
   }
 
   auto resetConventionalTrafficLightPublishRate(double rate) -> void
@@ -235,7 +288,7 @@ public:
   auto setConventionalTrafficLightConfidence(lanelet::Id id, double confidence) -> void
   {
     for (auto & traffic_light : conventional_traffic_light_manager_ptr_->getTrafficLights(id)) {
-      traffic_light.get().confidence = confidence;
+      traffic_light.get().setConfidence(confidence);
     }
   }
 
@@ -273,6 +326,11 @@ public:
   } catch (const std::out_of_range &) {                                          \
     THROW_SEMANTIC_ERROR("entity : ", name, "does not exist");                   \
   }                                                                              \
+  template <typename... Ts>                                                      \
+  decltype(auto) IDENTIFIER(const EntityHandle handle, Ts &&... xs) __VA_ARGS__  \
+  {                                                                              \
+    return getEntity(handle).IDENTIFIER(std::forward<decltype(xs)>(xs)...);      \
+  }                                                                              \
   static_assert(true, "")
   // clang-format on
 
@@ -336,10 +394,13 @@ public:
     const speed_change::Transition transition, const speed_change::Constraint constraint,
     const bool continuous);
 
+  auto makeEntityStatusSnapshot() -> std::shared_ptr<const EntityStatusSnapshot>;
+
+  /// @note The verbose output of the update goes to verbose_output, which only this call writes to.
   auto updateNpcLogic(
     const std::string & name,
-    const std::unordered_map<std::string, traffic_simulator_msgs::msg::EntityType> & type_list)
-    -> const CanonicalizedEntityStatus &;
+    const std::unordered_map<std::string, traffic_simulator_msgs::msg::EntityType> & type_list,
+    std::ostream & verbose_output) -> const CanonicalizedEntityStatus &;
 
   void broadcastEntityTransform();
 
@@ -355,6 +416,9 @@ public:
   auto getBoundingBoxDistance(const std::string & from, const std::string & to)
     -> std::optional<double>;
 
+  auto getBoundingBoxDistance(const EntityHandle from, const EntityHandle to)
+    -> std::optional<double>;
+
   auto getCurrentTime() const noexcept -> double;
 
   auto getDistanceToCrosswalk(const std::string & name, const lanelet::Id target_crosswalk_id)
@@ -365,8 +429,28 @@ public:
 
   auto getEntityNames() const -> const std::vector<std::string>;
 
+  auto getEntityHandle(const std::string & name) const -> EntityHandle;
+
+  auto getEntityName(const EntityHandle) const -> const std::string &;
+
+  /**
+   * @brief Call f(handle, name) for each entity except the despawned ones, in the order of
+   * spawning. Unlike getEntityNames, this does not allocate.
+   */
+  template <typename F>
+  auto forEachEntity(F && f) const -> void
+  {
+    for (std::size_t index = 0; index < entity_slots_.size(); ++index) {
+      if (const auto & [name, entity] = *entity_slots_[index]; not isDeleted(*entity)) {
+        f(EntityHandle(index), name);
+      }
+    }
+  }
+
   auto getEntityStatus(const std::string & name) const -> CanonicalizedEntityStatus;
 
+  auto getEntityStatus(const EntityHandle) const -> CanonicalizedEntityStatus;
+
   auto getEntityTypeList() const
     -> const std::unordered_map<std::string, traffic_simulator_msgs::msg::EntityType>;
 
@@ -395,11 +479,14 @@ public:
   auto getLateralDistance(const CanonicalizedLaneletPose &, const std::string &,              double matching_distance) const -> std::optional<double>;
   auto getLateralDistance(const std::string &,              const CanonicalizedLaneletPose &, double matching_distance) const -> std::optional<double>;
   auto getLateralDistance(const std::string &,              const std::string &,              double matching_distance) const -> std::optional<double>;
+  auto getLateralDistance(const EntityHandle,               const EntityHandle)                                         const -> std::optional<double>;
+  auto getLateralDistance(const EntityHandle,               const EntityHandle,               double matching_distance) const -> std::optional<double>;
 
   auto getLongitudinalDistance(const CanonicalizedLaneletPose &, const CanonicalizedLaneletPose &, bool include_adjacent_lanelet = false, bool include_opposite_direction = true) -> std::optional<double>;
   auto getLongitudinalDistance(const CanonicalizedLaneletPose &, const std::string &,              bool include_adjacent_lanelet = false, bool include_opposite_direction = true) -> std::optional<double>;
   auto getLongitudinalDistance(const std::string &,              const CanonicalizedLaneletPose &, bool include_adjacent_lanelet = false, bool include_opposite_direction = true) -> std::optional<double>;
   auto getLongitudinalDistance(const std::string &,              const std::string &,              bool include_adjacent_lanelet = false, bool include_opposite_direction = true) -> std::optional<double>;
+  auto getLongitudinalDistance(const EntityHandle,               const EntityHandle,               bool include_adjacent_lanelet = false, bool include_opposite_direction = true) -> std::optional<double>;
   // clang-format on
 
   auto getNumberOfEgo() const -> std::size_t;
@@ -416,6 +503,9 @@ public:
   auto getRelativePose(const CanonicalizedLaneletPose & from, const geometry_msgs::msg::Pose     & to) const -> geometry_msgs::msg::Pose;
   auto getRelativePose(const std::string                  & from, const CanonicalizedLaneletPose & to) const -> geometry_msgs::msg::Pose;
   auto getRelativePose(const CanonicalizedLaneletPose & from, const std::string                  & to) const -> geometry_msgs::msg::Pose;
+  auto getRelativePose(const geometry_msgs::msg::Pose     & from, const EntityHandle                   to) const -> geometry_msgs::msg::Pose;
+  auto getRelativePose(const EntityHandle                   from, const geometry_msgs::msg::Pose     & to) const -> geometry_msgs::msg::Pose;
+  auto getRelativePose(const EntityHandle                   from, const EntityHandle                   to) const -> geometry_msgs::msg::Pose;
   // clang-format on
 
   auto getStepTime() const noexcept -> double;
@@ -476,6 +566,7 @@ public:
   template <typename Entity, typename Pose, typename Parameters, typename... Ts>
   auto spawnEntity(
     const std::string & name, const Pose & pose, const Parameters & parameters, Ts &&... xs)
+    -> EntityHandle
   {
     auto makeEntityStatus = [&]() {
       EntityStatus entity_status;
@@ -537,7 +628,10 @@ public:
       if (npc_logic_started_ && not isEgo(name)) {
         iter->second->startNpcLogic();
       }
-      return success;
+      const EntityHandle handle(entity_slots_.size());
+      entity_slots_.push_back(&*iter);
+      entity_handles_.emplace(name, handle);
+      return handle;
     } else {
       THROW_SEMANTIC_ERROR("Entity ", std::quoted(name), " is already exists.");
     }
@@ -0,0 +1,79 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TRAFFIC_SIMULATOR__ENTITY__ENTITY_STATUS_ARRAY_PUBLISHER_HPP_
+#define TRAFFIC_SIMULATOR__ENTITY__ENTITY_STATUS_ARRAY_PUBLISHER_HPP_
+
+#include <cstddef>
+#include <rclcpp/rclcpp.hpp>
+#include <traffic_simulator/helper/rate_limiter.hpp>
+#include <traffic_simulator_msgs/msg/entity_status_with_trajectory_array.hpp>
+#include <utility>
+
+namespace traffic_simulator
+{
+namespace entity
+{
+/**
+ * @brief Publishes the EntityStatusWithTrajectoryArray of a frame, at most at the publish rate and
+ * only while the topic has subscribers. The message is filled in place: in a loaned message where
+ * the middleware supports it, otherwise in one message kept from frame to frame, whose elements
+ * keep the capacity of their strings and arrays.
+ */
+class EntityStatusArrayPublisher
+{
+public:
+  using Message = traffic_simulator_msgs::msg::EntityStatusWithTrajectoryArray;
+
+  /// @note A publish rate of 0 publishes every frame.
+  explicit EntityStatusArrayPublisher(
+    const rclcpp::Publisher<Message>::SharedPtr & publisher, double publish_rate);
+
+  /**
+   * @brief Call fill(message) with a message of size elements and publish it, if it is due at
+   * the scenario time and someone subscribes. The elements are not cleared before.
+   * @return Whether the message was published.
+   */
+  template <typename Fill>
+  auto publish(double time, std::size_t size, Fill && fill) -> bool
+  {
+    if (not hasSubscribers() or not rate_limiter_.isDue(time)) {
+      return false;
+    } else if (publisher_->can_loan_messages()) {
+      auto loaned_message = publisher_->borrow_loaned_message();
+      loaned_message.get().data.resize(size);
+      fill(loaned_message.get());
+      publisher_->publish(std::move(loaned_message));
+      return true;
+    } else {
+      message_.data.resize(size);
+      fill(message_);
+      publisher_->publish(message_);
+      return true;
+    }
+  }
+
+private:
+  auto hasSubscribers() const -> bool;
+
+  const rclcpp::Publisher<Message>::SharedPtr publisher_;
+
+  helper::RateLimiter rate_limiter_;
+
+  Message message_;
+};
+}  // namespace entity
+}  // namespace traffic_simulator
+
+#endif  // TRAFFIC_SIMULATOR__ENTITY__ENTITY_STATUS_ARRAY_PUBLISHER_HPP_
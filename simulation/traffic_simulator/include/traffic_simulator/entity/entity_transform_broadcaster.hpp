@@ -0,0 +1,97 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TRAFFIC_SIMULATOR__ENTITY__ENTITY_TRANSFORM_BROADCASTER_HPP_
+#define TRAFFIC_SIMULATOR__ENTITY__ENTITY_TRANSFORM_BROADCASTER_HPP_
+
+#include <tf2_ros/static_transform_broadcaster.h>
+
+#include <condition_variable>
+#include <geometry_msgs/msg/transform_stamped.hpp>
+#include <mutex>
+#include <thread>
+#include <traffic_simulator/data_type/entity_handle.hpp>
+#include <traffic_simulator/helper/rate_limiter.hpp>
+#include <vector>
+
+namespace traffic_simulator
+{
+namespace entity
+{
+/**
+ * @brief Broadcasts the transforms from the map to the entities according to a Policy, on a
+ * broadcaster shared with the other static transforms of the node.
+ * By default, the transform of every entity is sent in its own message every frame.
+ */
+class EntityTransformBroadcaster
+{
+public:
+  struct Policy
+  {
+    /// @note Maximum rate of the transform of each entity, 0 sends it every frame.
+    double publish_rate = 0.0;
+
+    bool ego_only = false;
+
+    /// @note Send the transforms of a frame in one message from a background thread.
+    bool batched = false;
+  };
+
+  explicit EntityTransformBroadcaster(
+    tf2_ros::StaticTransformBroadcaster & broadcaster, const Policy & policy);
+
+  ~EntityTransformBroadcaster();
+
+  EntityTransformBroadcaster(const EntityTransformBroadcaster &) = delete;
+
+  EntityTransformBroadcaster & operator=(const EntityTransformBroadcaster &) = delete;
+
+  /// @note Whether the transform of the entity is to be sent at the scenario time.
+  auto isDue(const EntityHandle, bool is_ego, double time) -> bool;
+
+  auto broadcast(std::vector<geometry_msgs::msg::TransformStamped> &&) -> void;
+
+  /// @note Send one transform now, whatever the policy.
+  auto sendTransform(const geometry_msgs::msg::TransformStamped &) -> void;
+
+private:
+  auto run() -> void;
+
+  const Policy policy_;
+
+  tf2_ros::StaticTransformBroadcaster & broadcaster_;
+
+  /// @note Guards broadcaster_, which the batched thread sends on.
+  std::mutex broadcaster_mutex_;
+
+  /// @note Indexed by EntityHandle.
+  std::vector<helper::RateLimiter> rate_limiters_;
+
+  std::thread thread_;
+
+  std::mutex mutex_;
+
+  std::condition_variable requested_;
+
+  /// @note Appended to while the transforms of the previous frame are being sent.
+  std::vector<geometry_msgs::msg::TransformStamped> pending_;
+
+  std::vector<geometry_msgs::msg::TransformStamped> sending_;
+
+  bool stop_requested_ = false;
+};
+}  // namespace entity
+}  // namespace traffic_simulator
+
+#endif  // TRAFFIC_SIMULATOR__ENTITY__ENTITY_TRANSFORM_BROADCASTER_HPP_
@@ -15,121 +15,311 @@
 #ifndef TRAFFIC_SIMULATOR__HDMAP_UTILS__CACHE_HPP_
 #define TRAFFIC_SIMULATOR__HDMAP_UTILS__CACHE_HPP_
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <geometry/spline/catmull_rom_spline.hpp>
+#include <geometry/spline/hermite_curve.hpp>
 #include <geometry_msgs/msg/point.hpp>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <scenario_simulator_exception/exception.hpp>
+#include <shared_mutex>
+#include <traffic_simulator/data_type/lane_change.hpp>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace hdmap_utils
 {
-class RouteCache
+/**
+ * @brief Read-mostly cache with a capacity bound and least-recently-used eviction.
+ * Lookups hash the key once and only take a shared lock, the recency of an entry is
+ * recorded in an atomic stamp so that hits never have to take the exclusive lock.
+ * Only inserting takes the exclusive lock, and evicts the least recently used entries when full.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache
 {
 public:
-  auto exists(lanelet::Id from, lanelet::Id to)
+  explicit LruCache(std::size_t capacity) : capacity_(capacity)
   {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::pair<lanelet::Id, lanelet::Id> key;
-    key.first = from;
-    key.second = to;
-    return data_.find(key) != data_.end();
+    if (capacity_ == 0) {
+      THROW_SIMULATION_ERROR("capacity of the cache should be greater than 0.");
+    }
   }
 
-  auto getRoute(lanelet::Id from, lanelet::Id to) -> decltype(auto)
+  /// @note Calls the given function with the cached value while holding the shared lock.
+  template <typename Function>
+  auto visit(const Key & key, Function && function) const
+    -> std::optional<std::invoke_result_t<Function, const Value &>>
   {
-    if (!exists(from, to)) {
-      THROW_SIMULATION_ERROR(
-        "route from : ", from, " to : ", to, " does not exists on route cache.");
-    } else {
-      std::lock_guard<std::mutex> lock(mutex_);
-      return data_.at({from, to});
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (const auto entry = data_.find(key); entry != data_.end()) {
+      entry->second.last_access.store(tick(), std::memory_order_relaxed);
+      hits_.fetch_add(1, std::memory_order_relaxed);
+      return function(entry->second.value);
     }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return std::nullopt;
   }
 
-  auto appendData(lanelet::Id from, lanelet::Id to, const lanelet::Ids & route) -> void
+  auto find(const Key & key) const -> std::optional<Value>
   {
-    std::lock_guard<std::mutex> lock(mutex_);
-    data_[{from, to}] = route;
+    return visit(key, [](const Value & value) { return value; });
   }
 
+  /// @note If another thread inserted the same key first, the value already in the cache is kept.
+  auto insert(const Key & key, const Value & value) -> void
+  {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (data_.find(key) != data_.end()) {
+      return;
+    }
+    if (data_.size() >= capacity_) {
+      evict();
+    }
+    data_.try_emplace(key, value, tick());
+  }
+
+  auto capacity() const noexcept { return capacity_; }
+
+  auto size() const
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return data_.size();
+  }
+
+  auto hits() const noexcept -> std::uint64_t { return hits_.load(std::memory_order_relaxed); }
+
+  auto misses() const noexcept -> std::uint64_t { return misses_.load(std::memory_order_relaxed); }
+
 private:
-  std::unordered_map<std::pair<lanelet::Id, lanelet::Id>, lanelet::Ids> data_;
+  struct Entry
+  {
+    Entry(const Value & value, std::uint64_t last_access) : value(value), last_access(last_access)
+    {
+    }
+
+    const Value value;
+
+    mutable std::atomic<std::uint64_t> last_access;
+  };
+
+  auto tick() const noexcept -> std::uint64_t
+  {
+    return clock_.fetch_add(1, std::memory_order_relaxed);
+  }
 
-  std::mutex mutex_;
+  /**
+   * @note Evict the least recently used eighth of the entries at once, so that the linear scan
+   * over the stamps is amortized over the following insertions.
+   * Must be called with the exclusive lock.
+   */
+  auto evict() -> void
+  {
+    std::vector<std::uint64_t> stamps;
+    stamps.reserve(data_.size());
+    for (const auto & [key, entry] : data_) {
+      stamps.push_back(entry.last_access.load(std::memory_order_relaxed));
+    }
+    const auto count = std::max<std::size_t>(1, stamps.size() / 8);
+    std::nth_element(stamps.begin(), stamps.begin() + (count - 1), stamps.end());
+    const auto threshold = stamps[count - 1];
+    for (auto entry = data_.begin(); entry != data_.end();) {
+      if (entry->second.last_access.load(std::memory_order_relaxed) <= threshold) {
+        entry = data_.erase(entry);
+      } else {
+        ++entry;
+      }
+    }
+  }
+
+  const std::size_t capacity_;
+
+  std::unordered_map<Key, Entry, Hash> data_;
+
+  mutable std::shared_mutex mutex_;
+
+  mutable std::atomic<std::uint64_t> clock_{0};
+
+  mutable std::atomic<std::uint64_t> hits_{0};
+
+  mutable std::atomic<std::uint64_t> misses_{0};
 };
 
-class CenterPointsCache
+class RouteCache
 {
 public:
-  auto exists(lanelet::Id lanelet_id) -> bool
+  explicit RouteCache(std::size_t capacity = 65536) : data_(capacity) {}
+
+  auto getRoute(lanelet::Id from, lanelet::Id to) const -> std::optional<lanelet::Ids>
   {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return data_.find(lanelet_id) != data_.end();
+    return data_.find({from, to});
   }
 
-  auto getCenterPoints(lanelet::Id lanelet_id) -> decltype(auto)
+  auto appendData(lanelet::Id from, lanelet::Id to, const lanelet::Ids & route) -> void
   {
-    if (!exists(lanelet_id)) {
-      THROW_SIMULATION_ERROR("center point of : ", lanelet_id, " does not exists on route cache.");
-    }
-    std::lock_guard<std::mutex> lock(mutex_);
-    return data_.at(lanelet_id);
+    data_.insert({from, to}, route);
+  }
+
+  auto hits() const noexcept { return data_.hits(); }
+
+  auto misses() const noexcept { return data_.misses(); }
+
+private:
+  LruCache<std::pair<lanelet::Id, lanelet::Id>, lanelet::Ids> data_;
+};
+
+class CenterPointsCache
+{
+public:
+  explicit CenterPointsCache(std::size_t capacity = 16384) : data_(capacity) {}
+
+  auto getCenterPoints(lanelet::Id lanelet_id) const
+    -> std::optional<std::vector<geometry_msgs::msg::Point>>
+  {
+    return data_.visit(lanelet_id, [](const auto & entry) { return entry.first; });
   }
 
-  auto getCenterPointsSpline(lanelet::Id lanelet_id) -> decltype(auto)
+  auto getCenterPointsSpline(lanelet::Id lanelet_id) const
+    -> std::optional<std::shared_ptr<math::geometry::CatmullRomSpline>>
   {
-    if (!exists(lanelet_id)) {
-      THROW_SIMULATION_ERROR("center point of : ", lanelet_id, " does not exists on route cache.");
-    }
-    std::lock_guard<std::mutex> lock(mutex_);
-    return splines_[lanelet_id];
+    return data_.visit(lanelet_id, [](const auto & entry) { return entry.second; });
   }
 
   auto appendData(lanelet::Id lanelet_id, const std::vector<geometry_msgs::msg::Point> & route)
+    -> void
   {
-    std::lock_guard<std::mutex> lock(mutex_);
-    data_[lanelet_id] = route;
-    splines_[lanelet_id] = std::make_shared<math::geometry::CatmullRomSpline>(route);
+    data_.insert(
+      lanelet_id, {route, std::make_shared<math::geometry::CatmullRomSpline>(route)});
   }
 
-private:
-  std::unordered_map<lanelet::Id, std::vector<geometry_msgs::msg::Point>> data_;
+  auto hits() const noexcept { return data_.hits(); }
 
-  std::unordered_map<lanelet::Id, std::shared_ptr<math::geometry::CatmullRomSpline>> splines_;
+  auto misses() const noexcept { return data_.misses(); }
 
-  std::mutex mutex_;
+private:
+  LruCache<
+    lanelet::Id, std::pair<
+                   std::vector<geometry_msgs::msg::Point>,
+                   std::shared_ptr<math::geometry::CatmullRomSpline>>>
+    data_;
 };
 
 class LaneletLengthCache
 {
 public:
-  auto exists(lanelet::Id lanelet_id)
+  explicit LaneletLengthCache(std::size_t capacity = 16384) : data_(capacity) {}
+
+  auto getLength(lanelet::Id lanelet_id) const -> std::optional<double>
   {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return data_.find(lanelet_id) != data_.end();
+    return data_.find(lanelet_id);
   }
 
-  auto getLength(lanelet::Id lanelet_id)
+  auto appendData(lanelet::Id lanelet_id, double length) -> void
   {
-    if (!exists(lanelet_id)) {
-      THROW_SIMULATION_ERROR("length of : ", lanelet_id, " does not exists on route cache.");
-    }
-    std::lock_guard<std::mutex> lock(mutex_);
-    return data_[lanelet_id];
+    data_.insert(lanelet_id, length);
   }
 
-  auto appendData(lanelet::Id lanelet_id, double length)
+  auto hits() const noexcept { return data_.hits(); }
+
+  auto misses() const noexcept { return data_.misses(); }
+
+private:
+  LruCache<lanelet::Id, double> data_;
+};
+
+/**
+ * @brief Key of a lane change trajectory search.
+ * The start pose is quantized, so that nearby requests share the same result.
+ */
+struct LaneChangeTrajectoryKey
+{
+  lanelet::Id from;
+  lanelet::Id to;
+  std::int64_t s;
+  std::int64_t offset;
+  std::int64_t roll;
+  std::int64_t pitch;
+  std::int64_t yaw;
+  traffic_simulator::lane_change::TrajectoryShape trajectory_shape;
+  double maximum_curvature_threshold;
+  double target_trajectory_length;
+  double forward_distance_threshold;
+
+  auto operator==(const LaneChangeTrajectoryKey & other) const -> bool
   {
-    std::lock_guard<std::mutex> lock(mutex_);
-    data_[lanelet_id] = length;
+    return from == other.from and to == other.to and s == other.s and offset == other.offset and
+           roll == other.roll and pitch == other.pitch and yaw == other.yaw and
+           trajectory_shape == other.trajectory_shape and
+           maximum_curvature_threshold == other.maximum_curvature_threshold and
+           target_trajectory_length == other.target_trajectory_length and
+           forward_distance_threshold == other.forward_distance_threshold;
   }
+};
 
-private:
-  std::unordered_map<lanelet::Id, double> data_;
+struct LaneChangeTrajectoryKeyHash
+{
+  auto operator()(const LaneChangeTrajectoryKey & key) const noexcept -> std::size_t
+  {
+    std::size_t seed = 0;
+    const auto combine = [&seed](auto value) {
+      seed ^= std::hash<decltype(value)>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    };
+    combine(key.from);
+    combine(key.to);
+    combine(key.s);
+    combine(key.offset);
+    combine(key.roll);
+    combine(key.pitch);
+    combine(key.yaw);
+    combine(static_cast<int>(key.trajectory_shape));
+    combine(key.maximum_curvature_threshold);
+    combine(key.target_trajectory_length);
+    combine(key.forward_distance_threshold);
+    return seed;
+  }
+};
+
+/**
+ * @brief Result of a lane change trajectory search, from which the curve is built again from the
+ * exact start pose.
+ */
+struct LaneChangeTarget
+{
+  /// @note s of the goal on the target lanelet.
+  double s;
+  double tangent_vector_size;
+};
+
+class LaneChangeTrajectoryCache
+{
+public:
+  /// @note std::nullopt if no trajectory is feasible.
+  using Target = std::optional<LaneChangeTarget>;
 
-  std::mutex mutex_;
+  explicit LaneChangeTrajectoryCache(std::size_t capacity = 4096) : data_(capacity) {}
+
+  auto getTarget(const LaneChangeTrajectoryKey & key) const -> std::optional<Target>
+  {
+    return data_.find(key);
+  }
+
+  auto appendData(const LaneChangeTrajectoryKey & key, const Target & target) -> void
+  {
+    data_.insert(key, target);
+  }
+
+  auto hits() const noexcept { return data_.hits(); }
+
+  auto misses() const noexcept { return data_.misses(); }
+
+private:
+  LruCache<LaneChangeTrajectoryKey, Target, LaneChangeTrajectoryKeyHash> data_;
 };
 }  // namespace hdmap_utils
 
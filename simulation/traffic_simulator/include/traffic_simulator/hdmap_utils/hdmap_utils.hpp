@@ -28,8 +28,10 @@
 #include <lanelet2_traffic_rules/TrafficRulesFactory.h>
 #include <tf2/LinearMath/Matrix3x3.h>
 
+#include <atomic>
 #include <autoware_auto_mapping_msgs/msg/had_map_bin.hpp>
 #include <boost/filesystem.hpp>
+#include <functional>
 #include <geographic_msgs/msg/geo_point.hpp>
 #include <geometry/spline/catmull_rom_spline.hpp>
 #include <geometry/spline/catmull_rom_spline_interface.hpp>
@@ -40,12 +42,18 @@
 #include <lanelet2_extension/utility/utilities.hpp>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <rclcpp/rclcpp.hpp>
 #include <string>
 #include <tf2_geometry_msgs/tf2_geometry_msgs.hpp>
 #include <traffic_simulator/data_type/lane_change.hpp>
 #include <traffic_simulator/hdmap_utils/cache.hpp>
+#include <traffic_simulator/hdmap_utils/lanelet_distance_table.hpp>
+#include <traffic_simulator/hdmap_utils/lanelet_id_table.hpp>
+#include <traffic_simulator/hdmap_utils/lanelet_spatial_index.hpp>
+#include <traffic_simulator/hdmap_utils/map_cache.hpp>
+#include <traffic_simulator/hdmap_utils/stop_line_index.hpp>
 #include <traffic_simulator_msgs/msg/bounding_box.hpp>
 #include <traffic_simulator_msgs/msg/entity_status.hpp>
 #include <tuple>
@@ -61,7 +69,29 @@ enum class LaneletType { LANE, CROSSWALK };
 class HdMapUtils
 {
 public:
-  explicit HdMapUtils(const boost::filesystem::path &, const geographic_msgs::msg::GeoPoint &);
+  /**
+   * @param map_cache_directory Directory of the precompiled map cache, an empty path disables it.
+   */
+  explicit HdMapUtils(
+    const boost::filesystem::path &, const geographic_msgs::msg::GeoPoint &,
+    const boost::filesystem::path & map_cache_directory = "");
+
+  /**
+   * @brief Get the instance of the map shared by every user of it.
+   * Instances alive in this process are reused for the same map and origin. Otherwise the map is
+   * attached from the precompiled map in MapCache::sharedMemoryDirectory(), which the first
+   * process compiles for every other process on the same host.
+   */
+  static auto shared(const boost::filesystem::path &, const geographic_msgs::msg::GeoPoint &)
+    -> std::shared_ptr<HdMapUtils>;
+
+  /**
+   * @brief Precompute the lanelet distances used by getLongitudinalDistance.
+   * @note The table is built once per instance, later calls return it whatever their limits.
+   * Safe to call while other threads, or other users of a shared instance, query distances.
+   */
+  auto buildLaneletDistanceTable(std::size_t hop_limit, std::size_t max_entries)
+    -> const LaneletDistanceTable &;
 
   auto canChangeLane(lanelet::Id from, lanelet::Id to) const -> bool;
 
@@ -104,12 +134,27 @@ public:
 
   auto getConflictingCrosswalkIds(const lanelet::Ids &) const -> lanelet::Ids;
 
+  /// @note Returns a view into a table built at map load, valid as long as this HdMapUtils.
+  auto getConflictingCrosswalkIds(lanelet::Id) const -> LaneletIdTable::Range;
+
   auto getConflictingLaneIds(const lanelet::Ids &) const -> lanelet::Ids;
 
+  /// @note Returns a view into a table built at map load, valid as long as this HdMapUtils.
+  auto getConflictingLaneIds(lanelet::Id) const -> LaneletIdTable::Range;
+
   auto getDistanceToStopLine(
     const lanelet::Ids & route_lanelets,
     const math::geometry::CatmullRomSplineInterface & spline) const -> std::optional<double>;
 
+  /**
+   * @brief Distance from the lanelet pose to the first stop line along the route lanelets, from
+   * the stop line index built at map load, without intersecting a spline with the stop lines.
+   * @throw common::SemanticError if the lanelet of the pose is not one of the route lanelets.
+   */
+  auto getDistanceToStopLine(
+    const lanelet::Ids & route_lanelets, const traffic_simulator_msgs::msg::LaneletPose & from,
+    double maximum_distance) const -> std::optional<double>;
+
   auto getDistanceToStopLine(
     const lanelet::Ids & route_lanelets,
     const std::vector<geometry_msgs::msg::Point> & waypoints) const -> std::optional<double>;
@@ -130,6 +175,15 @@ public:
     const std::vector<geometry_msgs::msg::Point> & waypoints,
     const lanelet::Id traffic_light_id) const -> std::optional<double>;
 
+  /// @note Index based version of getDistanceToTrafficLightStopLine, see getDistanceToStopLine.
+  auto getDistanceToTrafficLightStopLine(
+    const lanelet::Ids & route_lanelets, const traffic_simulator_msgs::msg::LaneletPose & from,
+    double maximum_distance) const -> std::optional<double>;
+
+  auto getDistanceToTrafficLightStopLine(
+    const lanelet::Ids & route_lanelets, const traffic_simulator_msgs::msg::LaneletPose & from,
+    double maximum_distance, const lanelet::Id traffic_light_id) const -> std::optional<double>;
+
   auto getFollowingLanelets(
     lanelet::Id, const lanelet::Ids & candidate_lanelet_ids, double distance = 100,
     bool include_self = true) const -> lanelet::Ids;
@@ -139,6 +193,12 @@ public:
 
   auto getHeight(const traffic_simulator_msgs::msg::LaneletPose &) const -> double;
 
+  /**
+   * @brief Find the goal s on the 1 m grid of the target lanelet whose trajectory is feasible and
+   * closest to target_trajectory_length, by bisection on the forward distance, the curvature and
+   * the length of the trajectory, which all grow along the target lanelet.
+   * Falls back to sampleLaneChangeTrajectory if the end of the target lanelet is not feasible.
+   */
   auto getLaneChangeTrajectory(
     const geometry_msgs::msg::Pose & from,
     const traffic_simulator::lane_change::Parameter & lane_change_parameter,
@@ -151,6 +211,19 @@ public:
     const traffic_simulator::lane_change::Parameter & lane_change_parameter) const
     -> std::optional<std::pair<math::geometry::HermiteCurve, double>>;
 
+  /**
+   * @brief Same search as the overload taking a map pose, from the quantized lanelet pose.
+   * The goal and tangent found are cached by the from and to lanelets, the quantized pose and the
+   * thresholds. The curve itself is always built from the exact pose, and searched again from the
+   * exact pose without the cache if it breaks the curvature or the forward distance threshold.
+   */
+  auto getLaneChangeTrajectory(
+    const traffic_simulator_msgs::msg::LaneletPose & from,
+    const traffic_simulator::lane_change::Parameter & lane_change_parameter,
+    double maximum_curvature_threshold, double target_trajectory_length,
+    double forward_distance_threshold) const
+    -> std::optional<std::pair<math::geometry::HermiteCurve, double>>;
+
   auto getLaneChangeableLaneletId(lanelet::Id, traffic_simulator::lane_change::Direction) const
     -> std::optional<lanelet::Id>;
 
@@ -162,6 +235,8 @@ public:
 
   auto getLaneletLength(lanelet::Id) const -> double;
 
+  auto getLaneletMap() const -> lanelet::LaneletMapConstPtr { return lanelet_map_ptr_; }
+
   auto getLaneletPolygon(lanelet::Id) const -> std::vector<geometry_msgs::msg::Point>;
 
   auto getLateralDistance(
@@ -178,6 +253,14 @@ public:
     const traffic_simulator_msgs::msg::LaneletPose & from,
     const traffic_simulator_msgs::msg::LaneletPose & to) const -> std::optional<double>;
 
+  /**
+   * @brief Candidate lanelets of a point, evaluated on the indexed centerlines in one pass.
+   * @note The s of each match is measured along the centerline polyline, see LaneletMatch.
+   */
+  auto getNearbyLaneletMatches(
+    const geometry_msgs::msg::Point &, double distance_threshold, bool include_crosswalk) const
+    -> std::vector<LaneletMatch>;
+
   auto getNearbyLaneletIds(
     const geometry_msgs::msg::Point &, double distance_threshold, bool include_crosswalk,
     std::size_t search_count = 5) const -> lanelet::Ids;
@@ -243,6 +326,11 @@ public:
   auto getTrafficLightStopLinesPoints(lanelet::Id traffic_light_id) const
     -> std::vector<std::vector<geometry_msgs::msg::Point>>;
 
+  auto getVehicleRoutingGraph() const -> lanelet::routing::RoutingGraphConstPtr
+  {
+    return vehicle_routing_graph_ptr_;
+  }
+
   auto insertMarkerArray(
     visualization_msgs::msg::MarkerArray &, const visualization_msgs::msg::MarkerArray &) const
     -> void;
@@ -259,6 +347,17 @@ public:
     const geometry_msgs::msg::Pose &, const traffic_simulator_msgs::msg::BoundingBox &,
     bool include_crosswalk, double reduction_ratio = 0.8) const -> std::optional<lanelet::Id>;
 
+  /**
+   * @brief Evaluate every goal s on the 1 m grid of the target lanelet, and pick the feasible
+   * trajectory closest to target_trajectory_length. Reference for getLaneChangeTrajectory.
+   */
+  auto sampleLaneChangeTrajectory(
+    const geometry_msgs::msg::Pose & from,
+    const traffic_simulator::lane_change::Parameter & lane_change_parameter,
+    double maximum_curvature_threshold, double target_trajectory_length,
+    double forward_distance_threshold) const
+    -> std::optional<std::pair<math::geometry::HermiteCurve, double>>;
+
   auto toLaneletPose(
     const geometry_msgs::msg::Pose &, bool include_crosswalk, double matching_distance = 1.0) const
     -> std::optional<traffic_simulator_msgs::msg::LaneletPose>;
@@ -296,6 +395,7 @@ private:
   mutable RouteCache route_cache_;
   mutable CenterPointsCache center_points_cache_;
   mutable LaneletLengthCache lanelet_length_cache_;
+  mutable LaneChangeTrajectoryCache lane_change_trajectory_cache_;
   // @}
 
   lanelet::LaneletMapPtr lanelet_map_ptr_;
@@ -304,6 +404,17 @@ private:
   lanelet::routing::RoutingGraphConstPtr pedestrian_routing_graph_ptr_;
   lanelet::traffic_rules::TrafficRulesPtr traffic_rules_pedestrian_ptr_;
   lanelet::ConstLanelets shoulder_lanelets_;
+  std::unordered_map<lanelet::Id, lanelet::Ids> next_lanelet_ids_;
+  std::unordered_map<lanelet::Id, lanelet::Ids> previous_lanelet_ids_;
+  LaneletSpatialIndex lanelet_spatial_index_;
+  std::once_flag lanelet_distance_table_built_;
+  LaneletDistanceTable lanelet_distance_table_;
+  /// @note Null until lanelet_distance_table_ is built, so that no query reads it half built.
+  std::atomic<const LaneletDistanceTable *> lanelet_distance_table_ptr_ = nullptr;
+  LaneletIdTable conflicting_lane_ids_;
+  LaneletIdTable conflicting_crosswalk_ids_;
+  StopLineIndex stop_line_index_;
+  StopLineIndex traffic_light_stop_line_index_;
 
   template <typename Lanelet>
   auto getLaneletIds(const std::vector<Lanelet> & lanelets) const -> lanelet::Ids
@@ -340,6 +451,12 @@ private:
   auto generateFineCenterline(const lanelet::ConstLanelet &, const double resolution) const
     -> lanelet::LineString3d;
 
+  auto getDistanceToIndexedStopLine(
+    const StopLineIndex &, const lanelet::Ids & route_lanelets,
+    const traffic_simulator_msgs::msg::LaneletPose & from, double maximum_distance,
+    const std::function<bool(const StopLineIndex::Position &)> & predicate) const
+    -> std::optional<double>;
+
   auto getLaneChangeTrajectory(
     const geometry_msgs::msg::Pose & from, const traffic_simulator_msgs::msg::LaneletPose & to,
     const traffic_simulator::lane_change::TrajectoryShape, double tangent_vector_size = 100) const
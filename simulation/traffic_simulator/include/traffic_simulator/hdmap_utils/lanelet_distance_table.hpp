@@ -0,0 +1,73 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TRAFFIC_SIMULATOR__HDMAP_UTILS__LANELET_DISTANCE_TABLE_HPP_
+#define TRAFFIC_SIMULATOR__HDMAP_UTILS__LANELET_DISTANCE_TABLE_HPP_
+
+#include <lanelet2_core/LaneletMap.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace hdmap_utils
+{
+/**
+ * @brief Hop bounded shortest route distances between lanelets, stored in compressed sparse rows.
+ * The distance between two lanelets is the total length of the lanelets strictly between them
+ * along the shortest route, which is what getLongitudinalDistance sums along getRoute.
+ * Only exact distances are stored, a pair missing from the table has to be routed as before.
+ */
+class LaneletDistanceTable
+{
+public:
+  LaneletDistanceTable() = default;
+
+  /**
+   * @param following_lanelet_ids Successors of each lanelet in the routing graph.
+   * @param hop_limit Maximum number of lanelet transitions of a stored route.
+   * @param max_entries Maximum number of stored pairs, shared evenly between the source lanelets.
+   * @note Rows are computed in parallel, one Dijkstra search per source lanelet.
+   */
+  explicit LaneletDistanceTable(
+    const std::unordered_map<lanelet::Id, lanelet::Ids> & following_lanelet_ids,
+    const std::unordered_map<lanelet::Id, double> & lanelet_lengths, std::size_t hop_limit,
+    std::size_t max_entries);
+
+  auto getDistanceBetween(lanelet::Id from, lanelet::Id to) const -> std::optional<double>;
+
+  auto empty() const noexcept { return targets_.empty(); }
+
+  auto size() const noexcept { return targets_.size(); }
+
+  /// @return Approximate number of bytes used by the table.
+  auto memoryUsage() const -> std::size_t;
+
+private:
+  using Index = std::uint32_t;
+
+  std::unordered_map<lanelet::Id, Index> indices_;
+
+  /// @note Row i is [offsets_[i], offsets_[i + 1]) in targets_ and distances_, sorted by target.
+  std::vector<std::size_t> offsets_;
+
+  std::vector<Index> targets_;
+
+  std::vector<double> distances_;
+};
+}  // namespace hdmap_utils
+
+#endif  // TRAFFIC_SIMULATOR__HDMAP_UTILS__LANELET_DISTANCE_TABLE_HPP_
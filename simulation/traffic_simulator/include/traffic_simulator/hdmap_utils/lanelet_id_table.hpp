@@ -0,0 +1,66 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TRAFFIC_SIMULATOR__HDMAP_UTILS__LANELET_ID_TABLE_HPP_
+#define TRAFFIC_SIMULATOR__HDMAP_UTILS__LANELET_ID_TABLE_HPP_
+
+#include <lanelet2_core/LaneletMap.h>
+
+#include <boost/range/iterator_range.hpp>
+#include <cstddef>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hdmap_utils
+{
+/**
+ * @brief Immutable lanelet id to lanelet ids table, all rows stored in one contiguous array.
+ * Lookups return a view into the table and never allocate.
+ */
+class LaneletIdTable
+{
+public:
+  using Range = boost::iterator_range<lanelet::Ids::const_iterator>;
+
+  LaneletIdTable() = default;
+
+  explicit LaneletIdTable(const std::vector<std::pair<lanelet::Id, lanelet::Ids>> & rows)
+  {
+    rows_.reserve(rows.size());
+    for (const auto & [lanelet_id, ids] : rows) {
+      rows_.emplace(lanelet_id, std::make_pair(ids_.size(), ids_.size() + ids.size()));
+      ids_.insert(ids_.end(), ids.begin(), ids.end());
+    }
+  }
+
+  /// @return std::nullopt if the lanelet is not in the table, which is not the same as no ids.
+  auto find(lanelet::Id lanelet_id) const -> std::optional<Range>
+  {
+    if (const auto row = rows_.find(lanelet_id); row != rows_.end()) {
+      return boost::make_iterator_range(
+        ids_.begin() + row->second.first, ids_.begin() + row->second.second);
+    }
+    return std::nullopt;
+  }
+
+private:
+  std::unordered_map<lanelet::Id, std::pair<std::size_t, std::size_t>> rows_;
+
+  lanelet::Ids ids_;
+};
+}  // namespace hdmap_utils
+
+#endif  // TRAFFIC_SIMULATOR__HDMAP_UTILS__LANELET_ID_TABLE_HPP_
@@ -0,0 +1,115 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TRAFFIC_SIMULATOR__HDMAP_UTILS__LANELET_SPATIAL_INDEX_HPP_
+#define TRAFFIC_SIMULATOR__HDMAP_UTILS__LANELET_SPATIAL_INDEX_HPP_
+
+#include <lanelet2_core/LaneletMap.h>
+
+#include <boost/geometry.hpp>
+#include <boost/geometry/geometries/box.hpp>
+#include <boost/geometry/geometries/point_xy.hpp>
+#include <boost/geometry/geometries/polygon.hpp>
+#include <boost/geometry/index/rtree.hpp>
+#include <cstddef>
+#include <geometry_msgs/msg/point.hpp>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hdmap_utils
+{
+/**
+ * @brief Result of projecting a point onto the centerline of a lanelet.
+ * s is the 2D arc length along the centerline polyline, offset is positive on the left side of it.
+ * @note s is not the s of a LaneletPose, which is measured along the Catmull-Rom spline through the
+ * centerline points in 3D. The two are equal at the first point, and differ by the length the
+ * spline gains over the chords and the slope, a few centimeters on the refined centerlines. Use
+ * toLaneletPose(pose, lanelet_match.lanelet_id) where a LaneletPose is needed.
+ */
+struct LaneletMatch
+{
+  lanelet::Id lanelet_id;
+  double s;
+  double offset;
+  double yaw;
+  /// @note True if the projection is not clamped to the start or the end of the centerline.
+  bool inside;
+};
+
+/**
+ * @brief Persistent R-tree of lanelet polygons and centerline segments.
+ * Built once from the lanelet map, so that lanelet matching does not have to
+ * walk the lanelet layer and evaluate splines for every candidate.
+ */
+class LaneletSpatialIndex
+{
+public:
+  using Point = boost::geometry::model::d2::point_xy<double>;
+  using Box = boost::geometry::model::box<Point>;
+  using Polygon = boost::geometry::model::polygon<Point, false>;
+
+  LaneletSpatialIndex() = default;
+
+  explicit LaneletSpatialIndex(const lanelet::LaneletMap &);
+
+  /**
+   * @brief Get the lanelets whose polygon is within the distance_threshold from the given polygon.
+   * @return lanelet ids and polygon distance, sorted by distance.
+   */
+  auto getNearbyLanelets(const Polygon &, double distance_threshold) const
+    -> std::vector<std::pair<lanelet::Id, double>>;
+
+  /**
+   * @brief Project the point onto every centerline segment within distance_threshold in one pass.
+   * @return one match per lanelet (the closest centerline segment), sorted by absolute offset.
+   */
+  auto getNearbyLaneletMatches(const geometry_msgs::msg::Point &, double distance_threshold) const
+    -> std::vector<LaneletMatch>;
+
+  /**
+   * @brief Project the point onto the closest centerline segment of the given lanelet.
+   */
+  auto getLaneletMatch(const geometry_msgs::msg::Point &, lanelet::Id) const
+    -> std::optional<LaneletMatch>;
+
+private:
+  struct Segment
+  {
+    lanelet::Id lanelet_id;
+    Point start;
+    Point end;
+    double s;
+    bool first;
+    bool last;
+  };
+
+  auto project(const geometry_msgs::msg::Point &, const Segment &) const -> LaneletMatch;
+
+  boost::geometry::index::rtree<std::pair<Box, std::size_t>, boost::geometry::index::rstar<16>>
+    polygon_rtree_;
+
+  boost::geometry::index::rtree<std::pair<Box, std::size_t>, boost::geometry::index::rstar<16>>
+    segment_rtree_;
+
+  std::vector<std::pair<lanelet::Id, Polygon>> polygons_;
+
+  std::vector<Segment> segments_;
+
+  std::unordered_map<lanelet::Id, std::pair<std::size_t, std::size_t>> segment_ranges_;
+};
+}  // namespace hdmap_utils
+
+#endif  // TRAFFIC_SIMULATOR__HDMAP_UTILS__LANELET_SPATIAL_INDEX_HPP_
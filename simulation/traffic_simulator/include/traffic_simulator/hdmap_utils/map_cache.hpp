@@ -0,0 +1,81 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TRAFFIC_SIMULATOR__HDMAP_UTILS__MAP_CACHE_HPP_
+#define TRAFFIC_SIMULATOR__HDMAP_UTILS__MAP_CACHE_HPP_
+
+#include <lanelet2_core/LaneletMap.h>
+
+#include <boost/filesystem.hpp>
+#include <cstdint>
+#include <geographic_msgs/msg/geo_point.hpp>
+#include <optional>
+#include <unordered_map>
+
+namespace hdmap_utils
+{
+/**
+ * @brief Everything HdMapUtils derives from the lanelet2 map file at startup.
+ * lanelet_map already contains the refined centerlines.
+ */
+struct MapCacheData
+{
+  lanelet::LaneletMapPtr lanelet_map;
+  std::unordered_map<lanelet::Id, double> lanelet_lengths;
+  std::unordered_map<lanelet::Id, lanelet::Ids> next_lanelet_ids;
+  std::unordered_map<lanelet::Id, lanelet::Ids> previous_lanelet_ids;
+  lanelet::Ids shoulder_lanelet_ids;
+};
+
+/**
+ * @brief Versioned binary cache of MapCacheData, written once and memory-mapped on later loads.
+ * The cache file is keyed by a hash of the contents of the lanelet2 map file and of the origin,
+ * so editing the map or changing the origin never loads a stale cache.
+ * An empty cache directory disables the cache.
+ * @note The cache files belong to no process, they are left for the next one. Saving a cache
+ * removes the other caches of the same map file, found by a hash of its canonical path in the file
+ * name, so that one file per map file is kept. Files in sharedMemoryDirectory() take memory until
+ * they are removed or the host restarts.
+ */
+class MapCache
+{
+public:
+  /// @note Bump whenever the layout of the cache file or the content of MapCacheData changes.
+  static constexpr std::uint32_t version = 1;
+
+  explicit MapCache(
+    const boost::filesystem::path & lanelet2_map_path, const geographic_msgs::msg::GeoPoint &,
+    const boost::filesystem::path & cache_directory);
+
+  static auto defaultDirectory() -> boost::filesystem::path;
+
+  /// @note Directory on tmpfs, so that processes attach to the precompiled map without disk I/O.
+  static auto sharedMemoryDirectory() -> boost::filesystem::path;
+
+  auto path() const -> const boost::filesystem::path & { return path_; }
+
+  /// @return std::nullopt if the cache file is missing, or written for another map or version.
+  auto load() const -> std::optional<MapCacheData>;
+
+  /// @note Failing to write the cache is not an error, the map is simply loaded cold next time.
+  auto save(const MapCacheData &) const -> void;
+
+private:
+  std::uint64_t key_ = 0;
+
+  boost::filesystem::path path_;
+};
+}  // namespace hdmap_utils
+
+#endif  // TRAFFIC_SIMULATOR__HDMAP_UTILS__MAP_CACHE_HPP_
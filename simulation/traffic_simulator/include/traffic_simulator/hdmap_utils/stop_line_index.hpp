@@ -0,0 +1,69 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TRAFFIC_SIMULATOR__HDMAP_UTILS__STOP_LINE_INDEX_HPP_
+#define TRAFFIC_SIMULATOR__HDMAP_UTILS__STOP_LINE_INDEX_HPP_
+
+#include <lanelet2_core/LaneletMap.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+namespace hdmap_utils
+{
+/**
+ * @brief Positions of the stop lines crossing the centerline of each lanelet, sorted by s.
+ */
+class StopLineIndex
+{
+public:
+  struct Position
+  {
+    double s;
+    lanelet::Id stop_line_id;
+    /// @note Lanelet referring to the stop sign, or id of the traffic light.
+    lanelet::Id owner_id;
+  };
+
+  auto insert(lanelet::Id lanelet_id, const Position & position) -> void
+  {
+    auto & positions = positions_[lanelet_id];
+    if (std::none_of(positions.begin(), positions.end(), [&](const auto & other) {
+          return other.stop_line_id == position.stop_line_id and
+                 other.owner_id == position.owner_id;
+        })) {
+      positions.insert(
+        std::upper_bound(
+          positions.begin(), positions.end(), position,
+          [](const auto & lhs, const auto & rhs) { return lhs.s < rhs.s; }),
+        position);
+    }
+  }
+
+  auto find(lanelet::Id lanelet_id) const -> const std::vector<Position> &
+  {
+    static const std::vector<Position> empty;
+    if (const auto positions = positions_.find(lanelet_id); positions != positions_.end()) {
+      return positions->second;
+    }
+    return empty;
+  }
+
+private:
+  std::unordered_map<lanelet::Id, std::vector<Position>> positions_;
+};
+}  // namespace hdmap_utils
+
+#endif  // TRAFFIC_SIMULATOR__HDMAP_UTILS__STOP_LINE_INDEX_HPP_
@@ -0,0 +1,57 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TRAFFIC_SIMULATOR__HELPER__RATE_LIMITER_HPP_
+#define TRAFFIC_SIMULATOR__HELPER__RATE_LIMITER_HPP_
+
+#include <limits>
+
+namespace traffic_simulator
+{
+namespace helper
+{
+/**
+ * @brief Decides whether something sent at most at a given rate is due at a scenario time.
+ */
+class RateLimiter
+{
+public:
+  /// @note A rate of 0 makes every time due.
+  explicit RateLimiter(double rate = 0.0) : rate_(rate) {}
+
+  auto isDue(double time) -> bool
+  {
+    if (rate_ <= 0.0) {
+      return true;
+    } else if (time >= next_due_time_ - tolerance) {
+      next_due_time_ = time + 1.0 / rate_;
+      return true;
+    } else {
+      return false;
+    }
+  }
+
+private:
+  /// @note Keeps a period which is a multiple of the step time from being missed by a rounding
+  /// error.
+  static constexpr double tolerance = 1e-6;
+
+  double rate_;
+
+  double next_due_time_ = -std::numeric_limits<double>::infinity();
+};
+}  // namespace helper
+}  // namespace traffic_simulator
+
+#endif  // TRAFFIC_SIMULATOR__HELPER__RATE_LIMITER_HPP_
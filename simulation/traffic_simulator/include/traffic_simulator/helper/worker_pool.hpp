@@ -0,0 +1,92 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TRAFFIC_SIMULATOR__HELPER__WORKER_POOL_HPP_
+#define TRAFFIC_SIMULATOR__HELPER__WORKER_POOL_HPP_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace traffic_simulator
+{
+namespace helper
+{
+/**
+ * @brief Fixed number of threads, started once, running the iterations of a loop in parallel.
+ * The iterations are split into contiguous chunks, one per thread, and the calling thread runs
+ * the first chunk. Which thread runs an iteration depends only on the iteration count and on
+ * the thread count.
+ */
+class WorkerPool
+{
+public:
+  /// @note A thread count of 0 or 1 runs every iteration on the calling thread.
+  explicit WorkerPool(std::size_t thread_count);
+
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool &) = delete;
+
+  WorkerPool & operator=(const WorkerPool &) = delete;
+
+  auto threadCount() const noexcept -> std::size_t { return workers_.size() + 1; }
+
+  /**
+   * @brief Call function(i) for every i in [0, size) and wait for all the calls to return.
+   * A chunk stops at the first exception thrown in it. The exception thrown at the smallest i is
+   * rethrown once every chunk is done.
+   */
+  auto parallelFor(std::size_t size, const std::function<void(std::size_t)> & function) -> void;
+
+private:
+  struct Chunk
+  {
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    std::exception_ptr thrown;
+  };
+
+  auto run(Chunk &) const -> void;
+
+  auto work(std::size_t chunk_index) -> void;
+
+  std::vector<std::thread> workers_;
+
+  std::vector<Chunk> chunks_;
+
+  const std::function<void(std::size_t)> * function_ = nullptr;
+
+  std::mutex mutex_;
+
+  std::condition_variable started_;
+
+  std::condition_variable finished_;
+
+  std::uint64_t generation_ = 0;
+
+  std::size_t running_ = 0;
+
+  bool stop_requested_ = false;
+};
+}  // namespace helper
+}  // namespace traffic_simulator
+
+#endif  // TRAFFIC_SIMULATOR__HELPER__WORKER_POOL_HPP_
@@ -16,6 +16,7 @@
 #define TRAFFIC_SIMULATOR__TRAFFIC_LIGHTS__TRAFFIC_LIGHT_HPP_
 
 #include <color_names/color_names.hpp>
+#include <cstddef>
 #include <cstdint>
 #include <geometry_msgs/msg/point.hpp>
 #include <iostream>
@@ -322,6 +323,7 @@ struct TrafficLight
 
   const lanelet::Id way_id;
 
+  /// @note Set with setConfidence, so that the change is counted in generation.
   double confidence = 1.0;
 
   std::set<Bulb> bulbs;
@@ -330,7 +332,11 @@ struct TrafficLight
 
   explicit TrafficLight(const lanelet::Id, hdmap_utils::HdMapUtils &);
 
-  auto clear() { bulbs.clear(); }
+  auto clear()
+  {
+    bulbs.clear();
+    ++generation_;
+  }
 
   auto contains(const Bulb & bulb) const { return bulbs.find(bulb) != std::end(bulbs); }
 
@@ -377,10 +383,20 @@ struct TrafficLight
   auto emplace(Ts &&... xs)
   {
     bulbs.emplace(std::forward<decltype(xs)>(xs)...);
+    ++generation_;
   }
 
   auto empty() const { return bulbs.empty(); }
 
+  /// @note Incremented by every change of the bulbs or the confidence, even to the same value.
+  auto generation() const noexcept { return generation_; }
+
+  auto setConfidence(const double given)
+  {
+    confidence = given;
+    ++generation_;
+  }
+
   auto set(const std::string & states) -> void;
 
   friend auto operator<<(std::ostream & os, const TrafficLight & traffic_light) -> std::ostream &;
@@ -397,6 +413,9 @@ struct TrafficLight
     }
     return traffic_signal_proto;
   }
+
+private:
+  std::size_t generation_ = 0;
 };
 }  // namespace traffic_simulator
 
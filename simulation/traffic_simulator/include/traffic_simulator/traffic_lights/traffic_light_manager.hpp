@@ -15,8 +15,10 @@
 #ifndef TRAFFIC_SIMULATOR__TRAFFIC_LIGHTS__TRAFFIC_LIGHT_MANAGER_BASE_HPP_
 #define TRAFFIC_SIMULATOR__TRAFFIC_LIGHTS__TRAFFIC_LIGHT_MANAGER_BASE_HPP_
 
+#include <cstddef>
 #include <iomanip>
 #include <memory>
+#include <mutex>
 #include <rclcpp/rclcpp.hpp>
 #include <simulation_interface/conversions.hpp>
 #include <stdexcept>  // std::out_of_range
@@ -37,9 +39,37 @@ protected:
 
   TrafficLightMap traffic_lights_;
 
+  /// @note getTrafficLight inserts lazily and is called by NPCs updated in parallel.
+  std::mutex traffic_lights_mutex_;
+
   const std::shared_ptr<hdmap_utils::HdMapUtils> hdmap_;
 
 public:
+  /**
+   * @brief The state of the traffic lights as one consumer of them last took it.
+   * @note A traffic light whose generation did not move since is not compared. Otherwise its bulbs
+   * and confidence are, since setting the same state again (clear then set) moves the generation.
+   */
+  class ChangeTracker
+  {
+    struct Taken
+    {
+      std::size_t generation;
+
+      std::vector<TrafficLight::Bulb::Hash> bulbs;
+
+      double confidence;
+    };
+
+    std::unordered_map<lanelet::Id, Taken> taken_;
+
+  public:
+    auto changed(const lanelet::Id, const TrafficLight &) const -> bool;
+
+    /// @return Whether the traffic light changed since it was last taken.
+    auto take(const lanelet::Id, const TrafficLight &) -> bool;
+  };
+
   explicit TrafficLightManager(const std::shared_ptr<hdmap_utils::HdMapUtils> & hdmap);
 
   auto getTrafficLight(const lanelet::Id traffic_light_id) -> TrafficLight &;
@@ -51,9 +81,14 @@ public:
   auto getTrafficLights(const lanelet::Id lanelet_id)
     -> std::vector<std::reference_wrapper<TrafficLight>>;
 
-  auto hasAnyLightChanged() -> bool;
+  auto hasAnyLightChanged(const ChangeTracker &) -> bool;
 
   auto generateUpdateTrafficLightsRequest() -> simulation_api_schema::UpdateTrafficLightsRequest;
+
+  /// @note Takes every traffic light, and puts only the changed ones in the request if
+  /// only_changed.
+  auto generateUpdateTrafficLightsRequest(ChangeTracker &, bool only_changed)
+    -> simulation_api_schema::UpdateTrafficLightsRequest;
 };
 }  // namespace traffic_simulator
 #endif  // TRAFFIC_SIMULATOR__TRAFFIC_LIGHTS__TRAFFIC_LIGHT_MANAGER_BASE_HPP_
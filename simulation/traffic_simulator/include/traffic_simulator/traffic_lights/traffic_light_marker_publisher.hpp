@@ -26,6 +26,8 @@ class TrafficLightMarkerPublisher
   const rclcpp::Clock::SharedPtr clock_ptr_;
   const std::shared_ptr<TrafficLightManager> traffic_light_manager_;
 
+  TrafficLightManager::ChangeTracker drawn_;
+
   auto deleteAllMarkers() const -> void;
   auto drawMarkers() const -> void;
 
@@ -22,21 +22,36 @@
 #include <stdexcept>
 #include <string>
 #include <traffic_simulator/api/api.hpp>
+#include <utility>
 
 namespace traffic_simulator
 {
+/// @note The traffic lights and the time of the last frame, unless closeZMQConnection sent them.
+API::~API() { flushFrameTransaction(); }
+
+void API::closeZMQConnection()
+{
+  flushFrameTransaction();
+  zeromq_client_.closeConnection();
+}
+
 void API::setVerbose(const bool verbose) { entity_manager_ptr_->setVerbose(verbose); }
 
 bool API::despawn(const std::string & name)
 {
+  /// @note A pending response may still refer to the entity, see receiveEntitiesStatusInSim.
+  if (not configuration.standalone_mode and not receiveEntitiesStatusInSim()) {
+    return false;
+  }
   const auto result = entity_manager_ptr_->despawnEntity(name);
   if (!result) {
     return false;
   }
   if (not configuration.standalone_mode) {
+    entity_status_encoder_.erase(name);
     simulation_api_schema::DespawnEntityRequest req;
     req.set_name(name);
-    return zeromq_client_.call(req).result().success();
+    return call(req).result().success();
   }
   return true;
 }
@@ -141,7 +156,7 @@ bool API::attachPseudoTrafficLightDetector(
 {
   simulation_api_schema::AttachPseudoTrafficLightDetectorRequest req;
   *req.mutable_configuration() = configuration;
-  return zeromq_client_.call(req).result().success();
+  return call(req).result().success();
 }
 
 bool API::attachDetectionSensor(
@@ -152,7 +167,7 @@ bool API::attachDetectionSensor(
   } else {
     simulation_api_schema::AttachDetectionSensorRequest req;
     *req.mutable_configuration() = sensor_configuration;
-    return zeromq_client_.call(req).result().success();
+    return call(req).result().success();
   }
 }
 
@@ -175,7 +190,7 @@ bool API::attachOccupancyGridSensor(
   } else {
     simulation_api_schema::AttachOccupancyGridSensorRequest req;
     *req.mutable_configuration() = sensor_configuration;
-    return zeromq_client_.call(req).result().success();
+    return call(req).result().success();
   }
 }
 
@@ -186,7 +201,7 @@ bool API::attachLidarSensor(const simulation_api_schema::LidarConfiguration & li
   } else {
     simulation_api_schema::AttachLidarSensorRequest req;
     *req.mutable_configuration() = lidar_configuration;
-    return zeromq_client_.call(req).result().success();
+    return call(req).result().success();
   }
 }
 
@@ -199,6 +214,18 @@ bool API::attachLidarSensor(
     lidar_sensor_delay));
 }
 
+bool API::flushFrameTransaction()
+{
+  if (
+    not frame_transaction_.has_update_traffic_lights() and
+    not frame_transaction_.has_update_frame()) {
+    return true;
+  }
+  simulation_api_schema::FrameTransactionRequest request;
+  request.Swap(&frame_transaction_);
+  return zeromq_client_.call(request).result().success();
+}
+
 bool API::updateTimeInSim()
 {
   simulation_api_schema::UpdateFrameRequest request;
@@ -206,14 +233,37 @@ bool API::updateTimeInSim()
   request.set_current_scenario_time(getCurrentTime());
   simulation_interface::toProto(
     clock_.getCurrentRosTimeAsMsg().clock, *request.mutable_current_ros_time());
-  return zeromq_client_.call(request).result().success();
+  if (configuration.frame_transaction) {
+    /// @note Sent with the entity status of the next frame, see flushFrameTransaction.
+    *frame_transaction_.mutable_update_frame() = std::move(request);
+    return true;
+  }
+  /// @note Pipelined, the response of the previous frame is only checked here, so that the
+  /// entities of this frame were updated while the simulator updated its sensors.
+  if (update_frame_response_.valid() and not update_frame_response_.get().result().success()) {
+    return false;
+  }
+  update_frame_response_ = callInFrame(std::move(request));
+  return configuration.pipelined_update_frame or update_frame_response_.get().result().success();
 }
 
 bool API::updateTrafficLightsInSim()
 {
   if (entity_manager_ptr_->trafficLightsChanged()) {
     auto req = entity_manager_ptr_->generateUpdateRequestForConventionalTrafficLights();
-    return zeromq_client_.call(req).result().success();
+    if (configuration.frame_transaction) {
+      /// @note Sent with the entity status of the next frame, see flushFrameTransaction.
+      *frame_transaction_.mutable_update_traffic_lights() = std::move(req);
+      return true;
+    }
+    if (
+      traffic_lights_response_.valid() and
+      not traffic_lights_response_.get().result().success()) {
+      return false;
+    }
+    traffic_lights_response_ = callInFrame(std::move(req));
+    return configuration.pipelined_update_frame or
+           traffic_lights_response_.get().result().success();
   }
   /// @todo handle response
   return simulation_api_schema::UpdateTrafficLightsResponse().result().success();
@@ -221,20 +271,64 @@ bool API::updateTrafficLightsInSim()
 
 bool API::updateEntitiesStatusInSim()
 {
+  if (not receiveEntitiesStatusInSim()) {
+    return false;
+  }
+
   simulation_api_schema::UpdateEntityStatusRequest req;
   req.set_npc_logic_started(entity_manager_ptr_->isNpcLogicStarted());
   for (const auto & entity_name : entity_manager_ptr_->getEntityNames()) {
     auto entity_status = entity_manager_ptr_->getEntityStatus(entity_name);
-    simulation_interface::toProto(static_cast<EntityStatus>(entity_status), *req.add_status());
+    if (configuration.delta_entity_status) {
+      /// @note The ego is always sent, since the simulator updates it when it is sent.
+      entity_status_encoder_.encode(
+        static_cast<EntityStatus>(entity_status), req, entity_manager_ptr_->isEgo(entity_name));
+    } else {
+      simulation_interface::toProto(static_cast<EntityStatus>(entity_status), *req.add_status());
+    }
   }
 
-  simulation_api_schema::UpdateEntityStatusResponse res;
-  if (auto res = zeromq_client_.call(req); res.result().success()) {
-    for (const auto & res_status : res.status()) {
-      auto name = res_status.name();
+  if (configuration.frame_transaction) {
+    /// @note The simulator applies the traffic lights and the time of the previous frame before
+    /// this entity status, in the order the separate requests would have been sent in.
+    *frame_transaction_.mutable_update_entity_status() = std::move(req);
+    entity_status_response_ = std::async(
+      std::launch::deferred,
+      [response = callInFrame(std::move(frame_transaction_))]() mutable {
+        auto transaction_response = response.get();
+        *transaction_response.mutable_update_entity_status()->mutable_result() =
+          transaction_response.result();
+        return std::move(*transaction_response.mutable_update_entity_status());
+      });
+    frame_transaction_.Clear();
+  } else {
+    entity_status_response_ = callInFrame(std::move(req));
+  }
+  /// @note Pipelined, the response is received at the start of the next frame.
+  return configuration.pipelined_update_frame or receiveEntitiesStatusInSim();
+}
+
+bool API::receiveEntitiesStatusInSim()
+{
+  if (not entity_status_response_.valid()) {
+    return true;
+  }
+  const auto res = entity_status_response_.get();
+  if (res.result().success()) {
+    /// @note A delta only has the fields which the simulator changed.
+    auto set_updated_status = [&](const std::string & name, const auto & updated, bool delta) {
+      /// @note Pipelined, the response answers the status sent before the entities of the
+      /// previous frame were updated, so only the ego, which the simulator updates, is taken.
+      if (configuration.pipelined_update_frame and not entity_manager_ptr_->isEgo(name)) {
+        return;
+      }
       auto entity_status = static_cast<EntityStatus>(entity_manager_ptr_->getEntityStatus(name));
-      simulation_interface::toMsg(res_status.pose(), entity_status.pose);
-      simulation_interface::toMsg(res_status.action_status(), entity_status.action_status);
+      if (not delta or updated.has_pose()) {
+        simulation_interface::toMsg(updated.pose(), entity_status.pose);
+      }
+      if (not delta or updated.has_action_status()) {
+        simulation_interface::toMsg(updated.action_status(), entity_status.action_status);
+      }
 
       if (entity_manager_ptr_->isEgo(name)) {
         // temporarily deinitialize lanelet pose as it should be correctly filled from here
@@ -247,12 +341,29 @@ bool API::updateEntitiesStatusInSim()
       } else {
         setEntityStatus(name, canonicalize(entity_status));
       }
+    };
+    for (const auto & res_status : res.status()) {
+      set_updated_status(res_status.name(), res_status, false);
+    }
+    for (const auto & status_delta : res.status_delta()) {
+      set_updated_status(entity_status_encoder_.decode(status_delta), status_delta, true);
     }
     return true;
   }
   return false;
 }
 
+/**
+ * @note With Configuration::pipelined_update_frame, the requests of a frame are sent without
+ * waiting for the responses. The simulator receives the same requests in the same order as
+ * otherwise, so the sensors of a frame see the entities of that frame. Only this side changes:
+ * - The response to the entity status of a frame is applied at the start of the next frame, so
+ *   the entities of a frame are updated with the ego of the previous frame. Only the ego is taken
+ *   from it, since the other entities were updated after the status was sent.
+ * - A failed response makes the next updateFrame return false instead of this one.
+ * - At most the requests of one frame are in flight when updateFrame returns. The other requests
+ *   to the simulator (spawn, despawn, attaching sensors, ...) are sent after them.
+ */
 bool API::updateFrame()
 {
   if (configuration.standalone_mode && entity_manager_ptr_->isEgoSpawned()) {
@@ -296,7 +407,7 @@ auto API::requestFollowTrajectory(
     auto request = simulation_api_schema::FollowPolylineTrajectoryRequest();
     *request.mutable_name() = name;
     *request.mutable_trajectory() = simulation_interface::toProtobufMessage(*trajectory);
-    return zeromq_client_.call(request).result().success();
+    return call(request).result().success();
   } else {
     entity_manager_ptr_->requestFollowTrajectory(name, trajectory);
     return true;
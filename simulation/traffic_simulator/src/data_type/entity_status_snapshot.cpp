@@ -0,0 +1,93 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdexcept>
+#include <traffic_simulator/data_type/entity_status_snapshot.hpp>
+
+namespace traffic_simulator
+{
+inline namespace entity_status
+{
+EntityStatusSnapshot::EntityStatusSnapshot(
+  std::uint64_t frame, std::vector<value_type> && statuses)
+: frame_(frame), statuses_(std::move(statuses))
+{
+  ids_.reserve(statuses_.size());
+  for (std::size_t id = 0; id < statuses_.size(); ++id) {
+    ids_.emplace(statuses_[id].first, id);
+  }
+}
+
+auto EntityStatusSnapshot::findId(const std::string & name) const -> std::optional<std::size_t>
+{
+  if (const auto id = ids_.find(name); id != ids_.end()) {
+    return id->second;
+  }
+  return std::nullopt;
+}
+
+OtherEntityStatusView::OtherEntityStatusView(
+  const std::shared_ptr<const EntityStatusSnapshot> & snapshot, const std::string & excluded_name)
+: snapshot_(snapshot), excluded_id_(snapshot_->findId(excluded_name).value_or(none))
+{
+}
+
+auto OtherEntityStatusView::begin() const -> const_iterator
+{
+  if (not snapshot_) {
+    return const_iterator();
+  }
+  return const_iterator(snapshot_->begin(), skipped(), snapshot_->end());
+}
+
+auto OtherEntityStatusView::end() const -> const_iterator
+{
+  if (not snapshot_) {
+    return const_iterator();
+  }
+  return const_iterator(snapshot_->end(), snapshot_->end(), snapshot_->end());
+}
+
+auto OtherEntityStatusView::find(const std::string & name) const -> const_iterator
+{
+  if (snapshot_) {
+    if (const auto id = snapshot_->findId(name); id and id.value() != excluded_id_) {
+      return const_iterator(snapshot_->begin() + id.value(), skipped(), snapshot_->end());
+    }
+  }
+  return end();
+}
+
+auto OtherEntityStatusView::at(const std::string & name) const -> const CanonicalizedEntityStatus &
+{
+  if (const auto iterator = find(name); iterator != end()) {
+    return iterator->second;
+  }
+  throw std::out_of_range("OtherEntityStatusView::at: no entity named " + name);
+}
+
+auto OtherEntityStatusView::skipped() const -> EntityStatusSnapshot::const_iterator
+{
+  return excluded_id_ == none ? snapshot_->end() : snapshot_->begin() + excluded_id_;
+}
+
+auto OtherEntityStatusView::size() const noexcept -> std::size_t
+{
+  if (not snapshot_) {
+    return 0;
+  }
+  return snapshot_->size() - (excluded_id_ == none ? 0 : 1);
+}
+}  // namespace entity_status
+}  // namespace traffic_simulator
@@ -675,28 +675,15 @@ void EntityBase::setEntityTypeList(
   entity_type_list_ = entity_type_list;
 }
 
-void EntityBase::setOtherStatus(
-  const std::unordered_map<std::string, CanonicalizedEntityStatus> & status)
-{
-  other_status_.clear();
-  for (const auto & [other_name, other_status] : status) {
-    if (other_name != name) {
-      /*
-         The following filtering is the code written for the purpose of
-         reducing the calculation load, but it is commented out experimentally
-         because it adversely affects "processing that needs to identify other
-         entities regardless of distance" such as RelativeTargetSpeed of
-         requestSpeedChange.
-      */
-      // const auto p0 = other_status.pose.position;
-      // const auto p1 = status_.pose.position;
-      // if (const auto distance = std::hypot(p0.x - p1.x, p0.y - p1.y, p0.z - p1.z); distance <
-      // 30)
-      // {
-      other_status_.emplace(other_name, other_status);
-      // }
-    }
-  }
+void EntityBase::setOtherStatus(const std::shared_ptr<const EntityStatusSnapshot> & snapshot)
+{
+  /*
+     Filtering the other entities by distance was tried here to reduce the
+     calculation load, but it adversely affects "processing that needs to
+     identify other entities regardless of distance" such as
+     RelativeTargetSpeed of requestSpeedChange.
+  */
+  other_status_ = OtherEntityStatusView(snapshot, name);
 }
 
 auto EntityBase::setStatus(const CanonicalizedEntityStatus & status) -> void
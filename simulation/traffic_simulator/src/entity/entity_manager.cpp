@@ -29,40 +29,56 @@
 #include <traffic_simulator/helper/helper.hpp>
 #include <traffic_simulator/helper/stop_watch.hpp>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace traffic_simulator
 {
 namespace entity
 {
+namespace
+{
+auto toTransformStamped(const geometry_msgs::msg::PoseStamped & pose)
+  -> geometry_msgs::msg::TransformStamped
+{
+  geometry_msgs::msg::TransformStamped transform_stamped;
+  transform_stamped.header.stamp = pose.header.stamp;
+  transform_stamped.header.frame_id = "map";
+  transform_stamped.child_frame_id = pose.header.frame_id;
+  transform_stamped.transform.translation.x = pose.pose.position.x;
+  transform_stamped.transform.translation.y = pose.pose.position.y;
+  transform_stamped.transform.translation.z = pose.pose.position.z;
+  transform_stamped.transform.rotation = pose.pose.orientation;
+  return transform_stamped;
+}
+}  // namespace
+
 void EntityManager::broadcastEntityTransform()
 {
-  std::vector<std::string> names = getEntityNames();
-  for (const auto & name : names) {
-    geometry_msgs::msg::PoseStamped pose;
-    pose.pose = getMapPose(name);
-    pose.header.stamp = clock_ptr_->now();
-    pose.header.frame_id = name;
-    broadcastTransform(pose);
-  }
+  using traffic_simulator_msgs::msg::EntityType;
+  const auto stamp = clock_ptr_->now();
+  std::vector<geometry_msgs::msg::TransformStamped> transforms;
+  forEachEntity([&](const auto handle, const auto & name) {
+    if (entity_transform_broadcaster_.isDue(
+          handle, getEntityType(handle).type == EntityType::EGO, current_time_)) {
+      geometry_msgs::msg::PoseStamped pose;
+      pose.pose = getMapPose(handle);
+      pose.header.stamp = stamp;
+      pose.header.frame_id = name;
+      transforms.push_back(toTransformStamped(pose));
+    }
+  });
+  entity_transform_broadcaster_.broadcast(std::move(transforms));
 }
 
 void EntityManager::broadcastTransform(
   const geometry_msgs::msg::PoseStamped & pose, const bool static_transform)
 {
-  geometry_msgs::msg::TransformStamped transform_stamped;
-  {
-    transform_stamped.header.stamp = pose.header.stamp;
-    transform_stamped.header.frame_id = "map";
-    transform_stamped.child_frame_id = pose.header.frame_id;
-    transform_stamped.transform.translation.x = pose.pose.position.x;
-    transform_stamped.transform.translation.y = pose.pose.position.y;
-    transform_stamped.transform.translation.z = pose.pose.position.z;
-    transform_stamped.transform.rotation = pose.pose.orientation;
-  }
+  const auto transform_stamped = toTransformStamped(pose);
 
   if (static_transform) {
-    broadcaster_.sendTransform(transform_stamped);
+    /// @note broadcaster_ is shared with the thread of a batched entity_transform_broadcaster_.
+    entity_transform_broadcaster_.sendTransform(transform_stamped);
   } else {
     base_link_broadcaster_.sendTransform(transform_stamped);
   }
@@ -107,6 +123,13 @@ auto EntityManager::getBoundingBoxDistance(const std::string & from, const std::
     getMapPose(from), getBoundingBox(from), getMapPose(to), getBoundingBox(to));
 }
 
+auto EntityManager::getBoundingBoxDistance(const EntityHandle from, const EntityHandle to)
+  -> std::optional<double>
+{
+  return math::geometry::getPolygonDistance(
+    getMapPose(from), getBoundingBox(from), getMapPose(to), getBoundingBox(to));
+}
+
 auto EntityManager::getCurrentTime() const noexcept -> double { return current_time_; }
 
 auto EntityManager::getDistanceToCrosswalk(
@@ -140,29 +163,50 @@ auto EntityManager::getDistanceToStopLine(
 auto EntityManager::getEntityNames() const -> const std::vector<std::string>
 {
   std::vector<std::string> names{};
-  for (const auto & each : entities_) {
-    // Add filter for DeletedEntity because this list is used on SimpleSensorSimulator which do not
-    // know DeletedEntity.
-    if (each.second->getEntityType().type != DeletedEntity::ENTITY_TYPE_ID) {
-      names.push_back(each.first);
-    }
-  }
+  // Add filter for DeletedEntity because this list is used on SimpleSensorSimulator which do not
+  // know DeletedEntity.
+  forEachEntity([&](const auto, const auto & name) { names.push_back(name); });
   return names;
 }
 
-auto EntityManager::getEntityStatus(const std::string & name) const -> CanonicalizedEntityStatus
+auto EntityManager::getEntity(const EntityHandle handle) const -> EntityBase &
 {
-  if (const auto iter = entities_.find(name); iter == entities_.end()) {
+  if (handle.index() < entity_slots_.size()) {
+    return *entity_slots_[handle.index()]->second;
+  } else {
+    THROW_SEMANTIC_ERROR("entity handle ", handle.index(), " does not exist.");
+  }
+}
+
+auto EntityManager::getEntityHandle(const std::string & name) const -> EntityHandle
+{
+  if (const auto iter = entity_handles_.find(name); iter == entity_handles_.end()) {
     THROW_SEMANTIC_ERROR("entity ", std::quoted(name), " does not exist.");
   } else {
-    auto entity_status = static_cast<EntityStatus>(iter->second->getStatus());
-    assert(entity_status.name == name && "The entity name in status is different from key!");
-    entity_status.action_status.current_action = getCurrentAction(name);
-    entity_status.time = current_time_;
-    return CanonicalizedEntityStatus(entity_status, hdmap_utils_ptr_);
+    return iter->second;
   }
 }
 
+auto EntityManager::getEntityName(const EntityHandle handle) const -> const std::string &
+{
+  return getEntity(handle).name;
+}
+
+auto EntityManager::getEntityStatus(const std::string & name) const -> CanonicalizedEntityStatus
+{
+  return getEntityStatus(getEntityHandle(name));
+}
+
+auto EntityManager::getEntityStatus(const EntityHandle handle) const -> CanonicalizedEntityStatus
+{
+  const auto & entity = getEntity(handle);
+  auto entity_status = static_cast<EntityStatus>(entity.getStatus());
+  assert(entity_status.name == entity.name && "The entity name in status is different from key!");
+  entity_status.action_status.current_action = entity.getCurrentAction();
+  entity_status.time = current_time_;
+  return CanonicalizedEntityStatus(entity_status, hdmap_utils_ptr_);
+}
+
 auto EntityManager::getEntityTypeList() const
   -> const std::unordered_map<std::string, traffic_simulator_msgs::msg::EntityType>
 {
@@ -329,6 +373,12 @@ auto EntityManager::getLateralDistance(
 
 auto EntityManager::getLateralDistance(const std::string & from, const std::string & to) const
   -> std::optional<double>
+{
+  return getLateralDistance(getEntityHandle(from), getEntityHandle(to));
+}
+
+auto EntityManager::getLateralDistance(const EntityHandle from, const EntityHandle to) const
+  -> std::optional<double>
 {
   const auto from_pose = getLaneletPose(from);
   const auto to_pose = getLaneletPose(to);
@@ -373,6 +423,13 @@ auto EntityManager::getLateralDistance(
 auto EntityManager::getLateralDistance(
   const std::string & from, const std::string & to, double matching_distance) const
   -> std::optional<double>
+{
+  return getLateralDistance(getEntityHandle(from), getEntityHandle(to), matching_distance);
+}
+
+auto EntityManager::getLateralDistance(
+  const EntityHandle from, const EntityHandle to, double matching_distance) const
+  -> std::optional<double>
 {
   const auto from_pose = getLaneletPose(from, matching_distance);
   const auto to_pose = getLaneletPose(to, matching_distance);
@@ -480,6 +537,15 @@ auto EntityManager::getLongitudinalDistance(
 auto EntityManager::getLongitudinalDistance(
   const std::string & from, const std::string & to, bool include_adjacent_lanelet,
   bool include_opposite_direction) -> std::optional<double>
+{
+  return getLongitudinalDistance(
+    getEntityHandle(from), getEntityHandle(to), include_adjacent_lanelet,
+    include_opposite_direction);
+}
+
+auto EntityManager::getLongitudinalDistance(
+  const EntityHandle from, const EntityHandle to, bool include_adjacent_lanelet,
+  bool include_opposite_direction) -> std::optional<double>
 {
   const auto from_lanelet_pose = getLaneletPose(from);
   const auto to_lanelet_pose = getLaneletPose(to);
@@ -503,11 +569,14 @@ auto EntityManager::getNumberOfEgo() const -> std::size_t
 
 const std::string EntityManager::getEgoName() const
 {
-  const auto names = getEntityNames();
-  for (const auto & name : names) {
-    if (isEgo(name)) {
-      return name;
+  std::optional<std::string> ego_name;
+  forEachEntity([&](const auto, const auto & name) {
+    if (not ego_name and isEgo(name)) {
+      ego_name = name;
     }
+  });
+  if (ego_name) {
+    return ego_name.value();
   }
   THROW_SEMANTIC_ERROR(
     "const std::string EntityManager::getEgoName(const std::string & name) function was called, "
@@ -574,6 +643,24 @@ auto EntityManager::getRelativePose(
   return getRelativePose(toMapPose(from), getMapPose(to));
 }
 
+auto EntityManager::getRelativePose(
+  const geometry_msgs::msg::Pose & from, const EntityHandle to) const -> geometry_msgs::msg::Pose
+{
+  return getRelativePose(from, getMapPose(to));
+}
+
+auto EntityManager::getRelativePose(
+  const EntityHandle from, const geometry_msgs::msg::Pose & to) const -> geometry_msgs::msg::Pose
+{
+  return getRelativePose(getMapPose(from), to);
+}
+
+auto EntityManager::getRelativePose(const EntityHandle from, const EntityHandle to) const
+  -> geometry_msgs::msg::Pose
+{
+  return getRelativePose(getMapPose(from), getMapPose(to));
+}
+
 auto EntityManager::getStepTime() const noexcept -> double { return step_time_; }
 
 auto EntityManager::getWaypoints(const std::string & name)
@@ -594,12 +681,9 @@ bool EntityManager::isEgo(const std::string & name) const
 
 bool EntityManager::isEgoSpawned() const
 {
-  for (const auto & name : getEntityNames()) {
-    if (isEgo(name)) {
-      return true;
-    }
-  }
-  return false;
+  bool ego_spawned = false;
+  forEachEntity([&](const auto, const auto & name) { ego_spawned = ego_spawned or isEgo(name); });
+  return ego_spawned;
 }
 
 bool EntityManager::isInLanelet(
@@ -666,8 +750,9 @@ void EntityManager::requestLaneChange(
 
 bool EntityManager::trafficLightsChanged()
 {
-  return conventional_traffic_light_manager_ptr_->hasAnyLightChanged() or
-         v2i_traffic_light_manager_ptr_->hasAnyLightChanged();
+  /// @note Only the conventional traffic lights are sent to the simulator.
+  return conventional_traffic_light_manager_ptr_->hasAnyLightChanged(
+    conventional_traffic_lights_sent_);
 }
 
 void EntityManager::requestSpeedChange(
@@ -747,17 +832,29 @@ auto EntityManager::toMapPose(const CanonicalizedLaneletPose & lanelet_pose) con
   return static_cast<geometry_msgs::msg::Pose>(lanelet_pose);
 }
 
+auto EntityManager::makeEntityStatusSnapshot() -> std::shared_ptr<const EntityStatusSnapshot>
+{
+  std::vector<EntityStatusSnapshot::value_type> statuses;
+  statuses.reserve(entities_.size());
+  for (const auto & [name, entity] : entities_) {
+    statuses.emplace_back(name, entity->getStatus());
+  }
+  return std::make_shared<const EntityStatusSnapshot>(++entity_status_frame_, std::move(statuses));
+}
+
 auto EntityManager::updateNpcLogic(
   const std::string & name,
-  const std::unordered_map<std::string, traffic_simulator_msgs::msg::EntityType> & type_list)
-  -> const CanonicalizedEntityStatus &
+  const std::unordered_map<std::string, traffic_simulator_msgs::msg::EntityType> & type_list,
+  std::ostream & verbose_output) -> const CanonicalizedEntityStatus &
 {
   if (configuration.verbose) {
-    std::cout << "update " << name << " behavior" << std::endl;
+    verbose_output << "update " << name << " behavior" << std::endl;
   }
-  entities_[name]->setEntityTypeList(type_list);
-  entities_[name]->onUpdate(current_time_, step_time_);
-  return entities_[name]->getStatus();
+  /// @note Use at instead of operator[], which is not safe to call from several threads.
+  const auto & entity = entities_.at(name);
+  entity->setEntityTypeList(type_list);
+  entity->onUpdate(current_time_, step_time_);
+  return entity->getStatus();
 }
 
 void EntityManager::update(const double current_time, const double step_time)
@@ -773,39 +870,69 @@ void EntityManager::update(const double current_time, const double step_time)
     v2i_traffic_light_updater_.createTimer(configuration.v2i_traffic_light_publish_rate);
   }
   auto type_list = getEntityTypeList();
-  std::unordered_map<std::string, CanonicalizedEntityStatus> all_status;
-  for (auto && [name, entity] : entities_) {
-    all_status.emplace(name, entity->getStatus());
-  }
-  for (auto && [name, entity] : entities_) {
-    entity->setOtherStatus(all_status);
-  }
-  all_status.clear();
-  for (auto && [name, entity] : entities_) {
-    all_status.emplace(name, updateNpcLogic(name, type_list));
-  }
+  /// @note Every entity references the same snapshot, instead of copying the others' statuses.
+  const auto status_before_update = makeEntityStatusSnapshot();
   for (auto && [name, entity] : entities_) {
-    entity->setOtherStatus(all_status);
-  }
-  traffic_simulator_msgs::msg::EntityStatusWithTrajectoryArray status_array_msg;
-  for (auto && [name, status] : all_status) {
-    traffic_simulator_msgs::msg::EntityStatusWithTrajectory status_with_trajectory;
-    status_with_trajectory.waypoint = getWaypoints(name);
-    for (const auto & goal : getGoalPoses<geometry_msgs::msg::Pose>(name)) {
-      status_with_trajectory.goal_pose.push_back(goal);
+    entity->setOtherStatus(status_before_update);
+  }
+  if (npc_update_pool_.threadCount() > 1) {
+    /// @note Entities only read each other from the snapshot, so the update order does not matter.
+    std::vector<std::string> npc_names;
+    for (auto && [name, entity] : entities_) {
+      if (isEgo(name)) {
+        updateNpcLogic(name, type_list, std::cout);
+      } else {
+        npc_names.push_back(name);
+      }
     }
-    if (const auto obstacle = getObstacle(name); obstacle) {
-      status_with_trajectory.obstacle = obstacle.value();
-      status_with_trajectory.obstacle_find = true;
-    } else {
-      status_with_trajectory.obstacle_find = false;
+    /// @note The worker threads do not print, the output of each NPC is printed in order after.
+    std::vector<std::ostringstream> verbose_outputs(npc_names.size());
+    const auto print_verbose_outputs = [&]() {
+      for (const auto & verbose_output : verbose_outputs) {
+        std::cout << verbose_output.str();
+      }
+      std::cout << std::flush;
+    };
+    try {
+      npc_update_pool_.parallelFor(npc_names.size(), [&](std::size_t i) {
+        updateNpcLogic(npc_names[i], type_list, verbose_outputs[i]);
+      });
+    } catch (...) {
+      print_verbose_outputs();
+      throw;
+    }
+    print_verbose_outputs();
+  } else {
+    for (auto && [name, entity] : entities_) {
+      updateNpcLogic(name, type_list, std::cout);
     }
-    status_with_trajectory.status = static_cast<EntityStatus>(status);
-    status_with_trajectory.name = name;
-    status_with_trajectory.time = current_time + step_time;
-    status_array_msg.data.emplace_back(status_with_trajectory);
   }
-  entity_status_array_pub_ptr_->publish(status_array_msg);
+  const auto status_after_update = makeEntityStatusSnapshot();
+  for (auto && [name, entity] : entities_) {
+    entity->setOtherStatus(status_after_update);
+  }
+  entity_status_array_publisher_.publish(
+    current_time, status_after_update->size(), [&](auto & status_array_msg) {
+      auto status_with_trajectory = status_array_msg.data.begin();
+      for (auto && [name, status] : *status_after_update) {
+        status_with_trajectory->waypoint = getWaypoints(name);
+        status_with_trajectory->goal_pose.clear();
+        for (const auto & goal : getGoalPoses<geometry_msgs::msg::Pose>(name)) {
+          status_with_trajectory->goal_pose.push_back(goal);
+        }
+        if (const auto obstacle = getObstacle(name); obstacle) {
+          status_with_trajectory->obstacle = obstacle.value();
+          status_with_trajectory->obstacle_find = true;
+        } else {
+          status_with_trajectory->obstacle = traffic_simulator_msgs::msg::Obstacle();
+          status_with_trajectory->obstacle_find = false;
+        }
+        status_with_trajectory->status = static_cast<EntityStatus>(status);
+        status_with_trajectory->name = name;
+        status_with_trajectory->time = current_time + step_time;
+        ++status_with_trajectory;
+      }
+    });
   stop_watch_update.stop();
   if (configuration.verbose) {
     stop_watch_update.print();
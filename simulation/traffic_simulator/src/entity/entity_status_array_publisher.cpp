@@ -0,0 +1,33 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <traffic_simulator/entity/entity_status_array_publisher.hpp>
+
+namespace traffic_simulator
+{
+namespace entity
+{
+EntityStatusArrayPublisher::EntityStatusArrayPublisher(
+  const rclcpp::Publisher<Message>::SharedPtr & publisher, double publish_rate)
+: publisher_(publisher), rate_limiter_(publish_rate)
+{
+}
+
+auto EntityStatusArrayPublisher::hasSubscribers() const -> bool
+{
+  return publisher_->get_subscription_count() + publisher_->get_intra_process_subscription_count() >
+         0;
+}
+}  // namespace entity
+}  // namespace traffic_simulator
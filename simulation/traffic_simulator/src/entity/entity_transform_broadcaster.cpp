@@ -0,0 +1,105 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iterator>
+#include <traffic_simulator/entity/entity_transform_broadcaster.hpp>
+#include <utility>
+
+namespace traffic_simulator
+{
+namespace entity
+{
+EntityTransformBroadcaster::EntityTransformBroadcaster(
+  tf2_ros::StaticTransformBroadcaster & broadcaster, const Policy & policy)
+: policy_(policy), broadcaster_(broadcaster)
+{
+  if (policy_.batched) {
+    thread_ = std::thread([this]() { run(); });
+  }
+}
+
+EntityTransformBroadcaster::~EntityTransformBroadcaster()
+{
+  if (thread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_requested_ = true;
+    }
+    requested_.notify_one();
+    thread_.join();
+  }
+}
+
+auto EntityTransformBroadcaster::isDue(const EntityHandle handle, bool is_ego, double time) -> bool
+{
+  if (policy_.ego_only and not is_ego) {
+    return false;
+  } else if (policy_.publish_rate <= 0.0) {
+    return true;
+  } else {
+    if (rate_limiters_.size() <= handle.index()) {
+      rate_limiters_.resize(handle.index() + 1, helper::RateLimiter(policy_.publish_rate));
+    }
+    return rate_limiters_[handle.index()].isDue(time);
+  }
+}
+
+auto EntityTransformBroadcaster::broadcast(
+  std::vector<geometry_msgs::msg::TransformStamped> && transforms) -> void
+{
+  if (transforms.empty()) {
+    return;
+  } else if (policy_.batched) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      pending_.insert(
+        pending_.end(), std::make_move_iterator(transforms.begin()),
+        std::make_move_iterator(transforms.end()));
+    }
+    requested_.notify_one();
+  } else {
+    std::lock_guard<std::mutex> lock(broadcaster_mutex_);
+    for (const auto & transform : transforms) {
+      broadcaster_.sendTransform(transform);
+    }
+  }
+}
+
+auto EntityTransformBroadcaster::sendTransform(
+  const geometry_msgs::msg::TransformStamped & transform) -> void
+{
+  std::lock_guard<std::mutex> lock(broadcaster_mutex_);
+  broadcaster_.sendTransform(transform);
+}
+
+auto EntityTransformBroadcaster::run() -> void
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    requested_.wait(lock, [this]() { return not pending_.empty() or stop_requested_; });
+    if (pending_.empty()) {
+      return;
+    }
+    std::swap(pending_, sending_);
+    lock.unlock();
+    {
+      std::lock_guard<std::mutex> broadcaster_lock(broadcaster_mutex_);
+      broadcaster_.sendTransform(sending_);
+    }
+    sending_.clear();
+    lock.lock();
+  }
+}
+}  // namespace entity
+}  // namespace traffic_simulator
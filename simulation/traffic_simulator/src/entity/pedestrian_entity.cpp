@@ -95,11 +95,14 @@ std::string PedestrianEntity::getCurrentAction() const
 auto PedestrianEntity::getDefaultDynamicConstraints() const
   -> const traffic_simulator_msgs::msg::DynamicConstraints &
 {
-  static auto default_dynamic_constraints = traffic_simulator_msgs::msg::DynamicConstraints();
-  default_dynamic_constraints.max_acceleration = 1.0;
-  default_dynamic_constraints.max_acceleration_rate = 1.0;
-  default_dynamic_constraints.max_deceleration = 1.0;
-  default_dynamic_constraints.max_deceleration_rate = 1.0;
+  static const auto default_dynamic_constraints = []() {
+    auto dynamic_constraints = traffic_simulator_msgs::msg::DynamicConstraints();
+    dynamic_constraints.max_acceleration = 1.0;
+    dynamic_constraints.max_acceleration_rate = 1.0;
+    dynamic_constraints.max_deceleration = 1.0;
+    dynamic_constraints.max_deceleration_rate = 1.0;
+    return dynamic_constraints;
+  }();
   return default_dynamic_constraints;
 }
 
@@ -161,8 +164,11 @@ void PedestrianEntity::cancelRequest()
 
 auto PedestrianEntity::getEntityType() const -> const traffic_simulator_msgs::msg::EntityType &
 {
-  static traffic_simulator_msgs::msg::EntityType type;
-  type.type = traffic_simulator_msgs::msg::EntityType::PEDESTRIAN;
+  static const auto type = []() {
+    traffic_simulator_msgs::msg::EntityType type;
+    type.type = traffic_simulator_msgs::msg::EntityType::PEDESTRIAN;
+    return type;
+  }();
   return type;
 }
 
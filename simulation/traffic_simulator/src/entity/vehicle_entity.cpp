@@ -78,8 +78,11 @@ auto VehicleEntity::getBehaviorParameter() const -> traffic_simulator_msgs::msg:
 
 auto VehicleEntity::getEntityType() const -> const traffic_simulator_msgs::msg::EntityType &
 {
-  static traffic_simulator_msgs::msg::EntityType type;
-  type.type = traffic_simulator_msgs::msg::EntityType::VEHICLE;
+  static const auto type = []() {
+    traffic_simulator_msgs::msg::EntityType type;
+    type.type = traffic_simulator_msgs::msg::EntityType::VEHICLE;
+    return type;
+  }();
   return type;
 }
 
@@ -26,7 +26,9 @@
 #include <boost/geometry/geometries/box.hpp>
 #include <boost/geometry/geometries/point_xy.hpp>
 #include <boost/geometry/geometries/polygon.hpp>
+#include <cmath>
 #include <deque>
+#include <functional>
 #include <geometry/linear_algebra.hpp>
 #include <geometry/spline/catmull_rom_spline.hpp>
 #include <geometry/spline/hermite_curve.hpp>
@@ -37,7 +39,9 @@
 #include <lanelet2_extension/utility/query.hpp>
 #include <lanelet2_extension/utility/utilities.hpp>
 #include <lanelet2_extension/visualization/visualization.hpp>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <scenario_simulator_exception/exception.hpp>
 #include <set>
@@ -45,6 +49,7 @@
 #include <traffic_simulator/color_utils/color_utils.hpp>
 #include <traffic_simulator/hdmap_utils/hdmap_utils.hpp>
 #include <traffic_simulator/helper/helper.hpp>
+#include <tuple>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -52,24 +57,32 @@
 namespace hdmap_utils
 {
 HdMapUtils::HdMapUtils(
-  const boost::filesystem::path & lanelet2_map_path, const geographic_msgs::msg::GeoPoint &)
-{
-  lanelet::projection::MGRSProjector projector;
+  const boost::filesystem::path & lanelet2_map_path, const geographic_msgs::msg::GeoPoint & origin,
+  const boost::filesystem::path & map_cache_directory)
+{
+  const MapCache map_cache(lanelet2_map_path, origin, map_cache_directory);
+  auto cached = map_cache.load();
+  if (cached) {
+    /// @note The cached map already contains the refined centerlines.
+    lanelet_map_ptr_ = cached->lanelet_map;
+  } else {
+    lanelet::projection::MGRSProjector projector;
 
-  lanelet::ErrorMessages errors;
+    lanelet::ErrorMessages errors;
 
-  lanelet_map_ptr_ = lanelet::load(lanelet2_map_path.string(), projector, &errors);
+    lanelet_map_ptr_ = lanelet::load(lanelet2_map_path.string(), projector, &errors);
 
-  if (not errors.empty()) {
-    std::stringstream ss;
-    const auto * separator = "";
-    for (const auto & error : errors) {
-      ss << separator << error;
-      separator = "\n";
+    if (not errors.empty()) {
+      std::stringstream ss;
+      const auto * separator = "";
+      for (const auto & error : errors) {
+        ss << separator << error;
+        separator = "\n";
+      }
+      THROW_SIMULATION_ERROR("Failed to load lanelet map (", ss.str(), ")");
     }
-    THROW_SIMULATION_ERROR("Failed to load lanelet map (", ss.str(), ")");
+    overwriteLaneletsCenterline();
   }
-  overwriteLaneletsCenterline();
   traffic_rules_vehicle_ptr_ = lanelet::traffic_rules::TrafficRulesFactory::create(
     lanelet::Locations::Germany, lanelet::Participants::Vehicle);
   vehicle_routing_graph_ptr_ =
@@ -81,8 +94,125 @@ HdMapUtils::HdMapUtils(
   std::vector<lanelet::routing::RoutingGraphConstPtr> all_graphs;
   all_graphs.push_back(vehicle_routing_graph_ptr_);
   all_graphs.push_back(pedestrian_routing_graph_ptr_);
-  shoulder_lanelets_ =
-    lanelet::utils::query::shoulderLanelets(lanelet::utils::query::laneletLayer(lanelet_map_ptr_));
+  if (cached) {
+    for (const auto lanelet_id : cached->shoulder_lanelet_ids) {
+      shoulder_lanelets_.push_back(lanelet_map_ptr_->laneletLayer.get(lanelet_id));
+    }
+    for (const auto & [lanelet_id, length] : cached->lanelet_lengths) {
+      lanelet_length_cache_.appendData(lanelet_id, length);
+    }
+    next_lanelet_ids_ = std::move(cached->next_lanelet_ids);
+    previous_lanelet_ids_ = std::move(cached->previous_lanelet_ids);
+  } else {
+    shoulder_lanelets_ = lanelet::utils::query::shoulderLanelets(
+      lanelet::utils::query::laneletLayer(lanelet_map_ptr_));
+    MapCacheData data;
+    data.lanelet_map = lanelet_map_ptr_;
+    data.shoulder_lanelet_ids = getLaneletIds(shoulder_lanelets_);
+    for (const auto & lanelet : lanelet_map_ptr_->laneletLayer) {
+      data.lanelet_lengths.emplace(lanelet.id(), getLaneletLength(lanelet.id()));
+      data.next_lanelet_ids.emplace(lanelet.id(), getNextLaneletIds(lanelet.id()));
+      data.previous_lanelet_ids.emplace(lanelet.id(), getPreviousLaneletIds(lanelet.id()));
+    }
+    next_lanelet_ids_ = data.next_lanelet_ids;
+    previous_lanelet_ids_ = data.previous_lanelet_ids;
+    map_cache.save(data);
+  }
+  {
+    lanelet::routing::RoutingGraphContainer container(all_graphs);
+    std::vector<std::pair<lanelet::Id, lanelet::Ids>> conflicting_lane_ids;
+    std::vector<std::pair<lanelet::Id, lanelet::Ids>> conflicting_crosswalk_ids;
+    for (const auto & lanelet : lanelet_map_ptr_->laneletLayer) {
+      conflicting_lane_ids.emplace_back(
+        lanelet.id(),
+        getLaneletIds(lanelet::utils::getConflictingLanelets(vehicle_routing_graph_ptr_, lanelet)));
+      /// @note 1 is the pedestrian routing graph in all_graphs, 4 is the height clearance.
+      conflicting_crosswalk_ids.emplace_back(
+        lanelet.id(), getLaneletIds(container.conflictingInGraph(lanelet, 1, 4)));
+    }
+    conflicting_lane_ids_ = LaneletIdTable(conflicting_lane_ids);
+    conflicting_crosswalk_ids_ = LaneletIdTable(conflicting_crosswalk_ids);
+  }
+  for (const auto & lanelet : lanelet_map_ptr_->laneletLayer) {
+    /// @note A stop line at the end of a lanelet may only cross the centerline of the next one.
+    lanelet::Ids crossing_lanelet_ids = {lanelet.id()};
+    for (const auto & following_lanelet : vehicle_routing_graph_ptr_->following(lanelet)) {
+      crossing_lanelet_ids.push_back(following_lanelet.id());
+    }
+    const auto insert = [&](
+                          StopLineIndex & index, const lanelet::ConstLineString3d & stop_line,
+                          lanelet::Id owner_id) {
+      std::vector<geometry_msgs::msg::Point> stop_line_points;
+      for (const auto & point : stop_line) {
+        geometry_msgs::msg::Point p;
+        p.x = point.x();
+        p.y = point.y();
+        p.z = point.z();
+        stop_line_points.emplace_back(p);
+      }
+      for (const auto crossing_lanelet_id : crossing_lanelet_ids) {
+        if (const auto s =
+              getCenterPointsSpline(crossing_lanelet_id)->getCollisionPointIn2D(stop_line_points)) {
+          index.insert(crossing_lanelet_id, {s.value(), stop_line.id(), owner_id});
+        }
+      }
+    };
+    for (const auto & stop_line : getStopLinesOnPath({lanelet.id()})) {
+      insert(stop_line_index_, stop_line, lanelet.id());
+    }
+    for (const auto & traffic_light : getTrafficLightRegElementsOnPath({lanelet.id()})) {
+      if (const auto stop_line = traffic_light->stopLine()) {
+        for (auto light_string : traffic_light->lightBulbs()) {
+          if (light_string.hasAttribute("traffic_light_id")) {
+            if (auto id = light_string.attribute("traffic_light_id").asId(); id) {
+              insert(traffic_light_stop_line_index_, stop_line.value(), id.value());
+            }
+          }
+        }
+      }
+    }
+  }
+  /// @note Must be built after overwriteLaneletsCenterline, it indexes the refined centerlines.
+  lanelet_spatial_index_ = LaneletSpatialIndex(*lanelet_map_ptr_);
+}
+
+auto HdMapUtils::shared(
+  const boost::filesystem::path & lanelet2_map_path, const geographic_msgs::msg::GeoPoint & origin)
+  -> std::shared_ptr<HdMapUtils>
+{
+  using Key = std::tuple<std::string, double, double, double>;
+  static std::mutex mutex;
+  static std::map<Key, std::weak_ptr<HdMapUtils>> instances;
+  const Key key(
+    boost::filesystem::absolute(lanelet2_map_path).string(), origin.latitude, origin.longitude,
+    origin.altitude);
+  std::lock_guard<std::mutex> lock(mutex);
+  if (auto instance = instances[key].lock()) {
+    return instance;
+  }
+  auto instance =
+    std::make_shared<HdMapUtils>(lanelet2_map_path, origin, MapCache::sharedMemoryDirectory());
+  instances[key] = instance;
+  return instance;
+}
+
+auto HdMapUtils::buildLaneletDistanceTable(std::size_t hop_limit, std::size_t max_entries)
+  -> const LaneletDistanceTable &
+{
+  std::call_once(lanelet_distance_table_built_, [&]() {
+    /// @note Only the vehicle routing graph, getRoute does not route through road shoulders.
+    std::unordered_map<lanelet::Id, lanelet::Ids> following_lanelet_ids;
+    std::unordered_map<lanelet::Id, double> lanelet_lengths;
+    for (const auto & lanelet : lanelet_map_ptr_->laneletLayer) {
+      following_lanelet_ids.emplace(
+        lanelet.id(), getLaneletIds(vehicle_routing_graph_ptr_->following(lanelet)));
+      lanelet_lengths.emplace(lanelet.id(), getLaneletLength(lanelet.id()));
+    }
+    lanelet_distance_table_ =
+      LaneletDistanceTable(following_lanelet_ids, lanelet_lengths, hop_limit, max_entries);
+    lanelet_distance_table_ptr_.store(&lanelet_distance_table_, std::memory_order_release);
+  });
+  return lanelet_distance_table_;
 }
 
 auto HdMapUtils::getAllCanonicalizedLaneletPoses(
@@ -269,6 +399,25 @@ auto HdMapUtils::getNearbyLaneletIds(
   return lanelet_ids;
 }
 
+auto HdMapUtils::getNearbyLaneletMatches(
+  const geometry_msgs::msg::Point & point, double distance_threshold, bool include_crosswalk) const
+  -> std::vector<LaneletMatch>
+{
+  auto matches = lanelet_spatial_index_.getNearbyLaneletMatches(point, distance_threshold);
+  if (!include_crosswalk) {
+    matches.erase(
+      std::remove_if(
+        matches.begin(), matches.end(),
+        [this](const auto & match) {
+          return lanelet_map_ptr_->laneletLayer.get(match.lanelet_id)
+                   .attributeOr(lanelet::AttributeName::Subtype, "") ==
+                 std::string(lanelet::AttributeValueString::Crosswalk);
+        }),
+      matches.end());
+  }
+  return matches;
+}
+
 auto HdMapUtils::getNearbyLaneletIds(
   const geometry_msgs::msg::Point & point, double distance_thresh, bool include_crosswalk,
   std::size_t search_count) const -> lanelet::Ids
@@ -361,36 +510,38 @@ auto HdMapUtils::getConflictingLaneIds(const lanelet::Ids & lanelet_ids) const -
 {
   lanelet::Ids ids;
   for (const auto & lanelet_id : lanelet_ids) {
-    const auto lanelet = lanelet_map_ptr_->laneletLayer.get(lanelet_id);
-    const auto conflicting_lanelets =
-      lanelet::utils::getConflictingLanelets(vehicle_routing_graph_ptr_, lanelet);
-    for (const auto & conflicting_lanelet : conflicting_lanelets) {
-      ids.emplace_back(conflicting_lanelet.id());
-    }
+    const auto conflicting_lane_ids = getConflictingLaneIds(lanelet_id);
+    ids.insert(ids.end(), conflicting_lane_ids.begin(), conflicting_lane_ids.end());
   }
   return ids;
 }
 
+auto HdMapUtils::getConflictingLaneIds(lanelet::Id lanelet_id) const -> LaneletIdTable::Range
+{
+  if (const auto ids = conflicting_lane_ids_.find(lanelet_id)) {
+    return ids.value();
+  }
+  THROW_SEMANTIC_ERROR("lanelet id ", lanelet_id, " does not exist in the lanelet map.");
+}
+
 auto HdMapUtils::getConflictingCrosswalkIds(const lanelet::Ids & lanelet_ids) const -> lanelet::Ids
 {
   lanelet::Ids ids;
-  std::vector<lanelet::routing::RoutingGraphConstPtr> graphs;
-  graphs.emplace_back(vehicle_routing_graph_ptr_);
-  graphs.emplace_back(pedestrian_routing_graph_ptr_);
-  lanelet::routing::RoutingGraphContainer container(graphs);
   for (const auto & lanelet_id : lanelet_ids) {
-    const auto lanelet = lanelet_map_ptr_->laneletLayer.get(lanelet_id);
-    double height_clearance = 4;
-    size_t routing_graph_id = 1;
-    const auto conflicting_crosswalks =
-      container.conflictingInGraph(lanelet, routing_graph_id, height_clearance);
-    for (const auto & crosswalk : conflicting_crosswalks) {
-      ids.emplace_back(crosswalk.id());
-    }
+    const auto conflicting_crosswalk_ids = getConflictingCrosswalkIds(lanelet_id);
+    ids.insert(ids.end(), conflicting_crosswalk_ids.begin(), conflicting_crosswalk_ids.end());
   }
   return ids;
 }
 
+auto HdMapUtils::getConflictingCrosswalkIds(lanelet::Id lanelet_id) const -> LaneletIdTable::Range
+{
+  if (const auto ids = conflicting_crosswalk_ids_.find(lanelet_id)) {
+    return ids.value();
+  }
+  THROW_SEMANTIC_ERROR("lanelet id ", lanelet_id, " does not exist in the lanelet map.");
+}
+
 auto HdMapUtils::clipTrajectoryFromLaneletIds(
   lanelet::Id lanelet_id, double s, const lanelet::Ids & lanelet_ids, double forward_distance) const
   -> std::vector<geometry_msgs::msg::Point>
@@ -508,23 +659,41 @@ auto HdMapUtils::matchToLane(
         bbox.center.x - bbox.dimensions.x * 0.5 * reduction_ratio,
         bbox.center.y - bbox.dimensions.y * 0.5 * reduction_ratio}},
     obj.pose);
-  auto matches = lanelet::matching::getDeterministicMatches(*lanelet_map_ptr_, obj, 3.0);
-  if (!include_crosswalk) {
-    matches = lanelet::matching::removeNonRuleCompliantMatches(matches, traffic_rules_vehicle_ptr_);
-  }
-  if (matches.empty()) {
-    return std::nullopt;
+  LaneletSpatialIndex::Polygon hull;
+  for (const auto & point : obj.absoluteHull) {
+    hull.outer().emplace_back(point.x(), point.y());
   }
+  hull.outer().push_back(hull.outer().front());
+  const auto pose_yaw = quaternion_operation::convertQuaternionToEulerAngle(pose.orientation).z;
   std::vector<std::pair<lanelet::Id, double>> id_and_distance;
-  for (const auto & match : matches) {
+  /**
+   * @note Hard coded parameter. Matching threshold for lanelet.
+   */
+  for (const auto & [lanelet_id, distance] : lanelet_spatial_index_.getNearbyLanelets(hull, 1.0)) {
+    if (!include_crosswalk) {
+      const auto lanelet = lanelet_map_ptr_->laneletLayer.get(lanelet_id);
+      if (
+        !traffic_rules_vehicle_ptr_->canPass(lanelet) &&
+        !traffic_rules_vehicle_ptr_->canPass(lanelet.invert())) {
+        continue;
+      }
+    }
     /**
-     * @note Hard coded parameter. Matching threshold for lanelet.
+     * @note Same acceptance as toLaneletPose(pose, lanelet_id) with the default matching distance,
+     * but evaluated on the indexed centerline instead of constructing the spline.
      */
-    if (match.distance <= 1.0) {
-      auto lanelet_pose = toLaneletPose(pose, match.lanelet.id());
-      if (lanelet_pose) {
-        id_and_distance.emplace_back(lanelet_pose->lanelet_id, lanelet_pose->offset);
+    if (const auto match = lanelet_spatial_index_.getLaneletMatch(pose.position, lanelet_id);
+        match && match->inside && std::fabs(match->offset) <= 1.0) {
+      const auto yaw_diff =
+        std::fabs(std::atan2(std::sin(pose_yaw - match->yaw), std::cos(pose_yaw - match->yaw)));
+      /**
+       * @note Hard coded parameter
+       */
+      constexpr double yaw_threshold = 0.25;
+      if (M_PI * yaw_threshold < yaw_diff && yaw_diff < M_PI * (1 - yaw_threshold)) {
+        continue;
       }
+      id_and_distance.emplace_back(lanelet_id, match->offset);
     }
   }
   if (id_and_distance.empty()) {
@@ -844,8 +1013,8 @@ auto HdMapUtils::getFollowingLanelets(
 auto HdMapUtils::getRoute(lanelet::Id from_lanelet_id, lanelet::Id to_lanelet_id) const
   -> lanelet::Ids
 {
-  if (route_cache_.exists(from_lanelet_id, to_lanelet_id)) {
-    return route_cache_.getRoute(from_lanelet_id, to_lanelet_id);
+  if (const auto cached = route_cache_.getRoute(from_lanelet_id, to_lanelet_id)) {
+    return cached.value();
   }
   lanelet::Ids ids;
   const auto lanelet = lanelet_map_ptr_->laneletLayer.get(from_lanelet_id);
@@ -871,8 +1040,15 @@ auto HdMapUtils::getRoute(lanelet::Id from_lanelet_id, lanelet::Id to_lanelet_id
 auto HdMapUtils::getCenterPointsSpline(lanelet::Id lanelet_id) const
   -> std::shared_ptr<math::geometry::CatmullRomSpline>
 {
-  getCenterPoints(lanelet_id);
-  return center_points_cache_.getCenterPointsSpline(lanelet_id);
+  if (const auto cached = center_points_cache_.getCenterPointsSpline(lanelet_id)) {
+    return cached.value();
+  }
+  const auto center_points = getCenterPoints(lanelet_id);
+  /// @note Another thread may have evicted the entry right after getCenterPoints inserted it.
+  if (const auto cached = center_points_cache_.getCenterPointsSpline(lanelet_id)) {
+    return cached.value();
+  }
+  return std::make_shared<math::geometry::CatmullRomSpline>(center_points);
 }
 
 auto HdMapUtils::getCenterPoints(const lanelet::Ids & lanelet_ids) const
@@ -899,8 +1075,8 @@ auto HdMapUtils::getCenterPoints(lanelet::Id lanelet_id) const
   if (lanelet_map_ptr_->laneletLayer.empty()) {
     THROW_SIMULATION_ERROR("lanelet layer is empty");
   }
-  if (center_points_cache_.exists(lanelet_id)) {
-    return center_points_cache_.getCenterPoints(lanelet_id);
+  if (const auto cached = center_points_cache_.getCenterPoints(lanelet_id)) {
+    return cached.value();
   }
 
   const auto lanelet = lanelet_map_ptr_->laneletLayer.get(lanelet_id);
@@ -930,8 +1106,8 @@ auto HdMapUtils::getCenterPoints(lanelet::Id lanelet_id) const
 
 auto HdMapUtils::getLaneletLength(lanelet::Id lanelet_id) const -> double
 {
-  if (lanelet_length_cache_.exists(lanelet_id)) {
-    return lanelet_length_cache_.getLength(lanelet_id);
+  if (const auto cached = lanelet_length_cache_.getLength(lanelet_id)) {
+    return cached.value();
   }
   double ret = lanelet::utils::getLaneletLength2d(lanelet_map_ptr_->laneletLayer.get(lanelet_id));
   lanelet_length_cache_.appendData(lanelet_id, ret);
@@ -952,6 +1128,10 @@ auto HdMapUtils::getPreviousRoadShoulderLanelet(lanelet::Id lanelet_id) const ->
 
 auto HdMapUtils::getPreviousLaneletIds(lanelet::Id lanelet_id) const -> lanelet::Ids
 {
+  if (const auto cached = previous_lanelet_ids_.find(lanelet_id);
+      cached != previous_lanelet_ids_.end()) {
+    return cached->second;
+  }
   lanelet::Ids ids;
   const auto lanelet = lanelet_map_ptr_->laneletLayer.get(lanelet_id);
   for (const auto & llt : vehicle_routing_graph_ptr_->previous(lanelet)) {
@@ -1009,6 +1189,9 @@ auto HdMapUtils::getNextRoadShoulderLanelet(lanelet::Id lanelet_id) const -> lan
 
 auto HdMapUtils::getNextLaneletIds(lanelet::Id lanelet_id) const -> lanelet::Ids
 {
+  if (const auto cached = next_lanelet_ids_.find(lanelet_id); cached != next_lanelet_ids_.end()) {
+    return cached->second;
+  }
   lanelet::Ids ids;
   const auto lanelet = lanelet_map_ptr_->laneletLayer.get(lanelet_id);
   for (const auto & llt : vehicle_routing_graph_ptr_->following(lanelet)) {
@@ -1281,12 +1464,162 @@ auto HdMapUtils::getLaneChangeTrajectory(
   return std::make_pair(traj, collision_point.value());
 }
 
+auto HdMapUtils::getLaneChangeTrajectory(
+  const traffic_simulator_msgs::msg::LaneletPose & from_pose,
+  const traffic_simulator::lane_change::Parameter & lane_change_parameter,
+  double maximum_curvature_threshold, double target_trajectory_length,
+  double forward_distance_threshold) const
+  -> std::optional<std::pair<math::geometry::HermiteCurve, double>>
+{
+  constexpr double s_resolution = 0.1;
+  constexpr double offset_resolution = 0.1;
+  constexpr double angle_resolution = 0.01;
+  const LaneChangeTrajectoryKey key = {
+    from_pose.lanelet_id,
+    lane_change_parameter.target.lanelet_id,
+    std::llround(from_pose.s / s_resolution),
+    std::llround(from_pose.offset / offset_resolution),
+    std::llround(from_pose.rpy.x / angle_resolution),
+    std::llround(from_pose.rpy.y / angle_resolution),
+    std::llround(from_pose.rpy.z / angle_resolution),
+    lane_change_parameter.trajectory_shape,
+    maximum_curvature_threshold,
+    target_trajectory_length,
+    forward_distance_threshold};
+  const auto target = [&]() -> LaneChangeTrajectoryCache::Target {
+    if (const auto cached = lane_change_trajectory_cache_.getTarget(key)) {
+      return cached.value();
+    }
+    /// @note Search from the quantized pose, so that the target does not depend on cache hits.
+    const auto quantized_pose = toMapPose(traffic_simulator::helper::constructLaneletPose(
+                                            key.from, key.s * s_resolution,
+                                            key.offset * offset_resolution,
+                                            key.roll * angle_resolution,
+                                            key.pitch * angle_resolution,
+                                            key.yaw * angle_resolution))
+                                  .pose;
+    LaneChangeTrajectoryCache::Target target = std::nullopt;
+    if (const auto trajectory = getLaneChangeTrajectory(
+          quantized_pose, lane_change_parameter, maximum_curvature_threshold,
+          target_trajectory_length, forward_distance_threshold)) {
+      /// @note Same tangent as the search, half of the distance from the start to the goal.
+      const auto goal = toMapPose(traffic_simulator::helper::constructLaneletPose(
+                                    lane_change_parameter.target.lanelet_id, trajectory->second))
+                          .pose.position;
+      target = LaneChangeTarget{
+        trajectory->second, std::hypot(
+                              quantized_pose.position.x - goal.x,
+                              quantized_pose.position.y - goal.y,
+                              quantized_pose.position.z - goal.z) *
+                              0.5};
+    }
+    lane_change_trajectory_cache_.appendData(key, target);
+    return target;
+  }();
+  if (not target) {
+    return std::nullopt;
+  }
+  const auto from_pose_in_map = toMapPose(from_pose).pose;
+  const auto to_pose = traffic_simulator::helper::constructLaneletPose(
+    lane_change_parameter.target.lanelet_id, target->s);
+  auto curve = getLaneChangeTrajectory(
+    from_pose_in_map, to_pose, lane_change_parameter.trajectory_shape, target->tangent_vector_size);
+  /// @note The target was found from the quantized pose, the curve from the exact pose is checked
+  /// against the same constraints, and searched again without the cache if it fails them.
+  if (
+    curve.getMaximum2DCurvature() < maximum_curvature_threshold and
+    math::geometry::getRelativePose(from_pose_in_map, toMapPose(to_pose).pose).position.x >
+      forward_distance_threshold) {
+    return std::make_pair(curve, target->s);
+  } else {
+    return getLaneChangeTrajectory(
+      from_pose_in_map, lane_change_parameter, maximum_curvature_threshold,
+      target_trajectory_length, forward_distance_threshold);
+  }
+}
+
 auto HdMapUtils::getLaneChangeTrajectory(
   const geometry_msgs::msg::Pose & from_pose,
   const traffic_simulator::lane_change::Parameter & lane_change_parameter,
   double maximum_curvature_threshold, double target_trajectory_length,
   double forward_distance_threshold) const
   -> std::optional<std::pair<math::geometry::HermiteCurve, double>>
+{
+  struct Candidate
+  {
+    bool feasible;
+    std::optional<math::geometry::HermiteCurve> curve;
+  };
+  /// @note Same goal s values as sampleLaneChangeTrajectory, index * 1.0 below the lanelet length.
+  const auto size =
+    static_cast<std::size_t>(std::ceil(getLaneletLength(lane_change_parameter.target.lanelet_id)));
+  std::unordered_map<std::size_t, Candidate> candidates;
+  const auto evaluate = [&](std::size_t index) -> const Candidate & {
+    if (const auto candidate = candidates.find(index); candidate != candidates.end()) {
+      return candidate->second;
+    }
+    const auto to_pose = traffic_simulator::helper::constructLaneletPose(
+      lane_change_parameter.target.lanelet_id, static_cast<double>(index));
+    const auto goal_pose = toMapPose(to_pose);
+    if (
+      math::geometry::getRelativePose(from_pose, goal_pose.pose).position.x <=
+      forward_distance_threshold) {
+      return candidates.emplace(index, Candidate{false, std::nullopt}).first->second;
+    }
+    double start_to_goal_distance = std::sqrt(
+      std::pow(from_pose.position.x - goal_pose.pose.position.x, 2) +
+      std::pow(from_pose.position.y - goal_pose.pose.position.y, 2) +
+      std::pow(from_pose.position.z - goal_pose.pose.position.z, 2));
+    auto curve = getLaneChangeTrajectory(
+      from_pose, to_pose, lane_change_parameter.trajectory_shape, start_to_goal_distance * 0.5);
+    const bool feasible = curve.getMaximum2DCurvature() < maximum_curvature_threshold;
+    return candidates.emplace(index, Candidate{feasible, curve}).first->second;
+  };
+  /// @note First index in [first, last] satisfying the predicate, which must hold at last.
+  const auto bisect = [](std::size_t first, std::size_t last, const auto & predicate) {
+    while (first < last) {
+      if (const auto middle = first + (last - first) / 2; predicate(middle)) {
+        last = middle;
+      } else {
+        first = middle + 1;
+      }
+    }
+    return last;
+  };
+  if (size == 0) {
+    return std::nullopt;
+  }
+  if (not evaluate(size - 1).feasible) {
+    return sampleLaneChangeTrajectory(
+      from_pose, lane_change_parameter, maximum_curvature_threshold, target_trajectory_length,
+      forward_distance_threshold);
+  }
+  const auto length = [&](std::size_t index) { return evaluate(index).curve->getLength(); };
+  const auto first_feasible =
+    bisect(0, size - 1, [&](std::size_t index) { return evaluate(index).feasible; });
+  auto best = size - 1;
+  if (length(first_feasible) >= target_trajectory_length) {
+    best = first_feasible;
+  } else if (length(size - 1) > target_trajectory_length) {
+    best = bisect(first_feasible, size - 1, [&](std::size_t index) {
+      return length(index) >= target_trajectory_length;
+    });
+    /// @note On a tie, prefer the shorter one like std::min_element in sampleLaneChangeTrajectory.
+    if (
+      std::fabs(target_trajectory_length - length(best - 1)) <=
+      std::fabs(target_trajectory_length - length(best))) {
+      best = best - 1;
+    }
+  }
+  return std::make_pair(evaluate(best).curve.value(), static_cast<double>(best));
+}
+
+auto HdMapUtils::sampleLaneChangeTrajectory(
+  const geometry_msgs::msg::Pose & from_pose,
+  const traffic_simulator::lane_change::Parameter & lane_change_parameter,
+  double maximum_curvature_threshold, double target_trajectory_length,
+  double forward_distance_threshold) const
+  -> std::optional<std::pair<math::geometry::HermiteCurve, double>>
 {
   double to_length = getLaneletLength(lane_change_parameter.target.lanelet_id);
   std::vector<double> evaluation, target_s;
@@ -1452,6 +1785,11 @@ auto HdMapUtils::getLongitudinalDistance(
       return to.s - from.s;
     }
   }
+  if (const auto table = lanelet_distance_table_ptr_.load(std::memory_order_acquire); table) {
+    if (const auto distance = table->getDistanceBetween(from.lanelet_id, to.lanelet_id)) {
+      return getLaneletLength(from.lanelet_id) - from.s + distance.value() + to.s;
+    }
+  }
   const auto route = getRoute(from.lanelet_id, to.lanelet_id);
   if (route.empty()) {
     return std::nullopt;
@@ -1831,6 +2169,66 @@ auto HdMapUtils::getDistanceToTrafficLightStopLine(
   return std::nullopt;
 }
 
+auto HdMapUtils::getDistanceToTrafficLightStopLine(
+  const lanelet::Ids & route_lanelets, const traffic_simulator_msgs::msg::LaneletPose & from,
+  double maximum_distance) const -> std::optional<double>
+{
+  const auto traffic_light_ids = getTrafficLightIdsOnPath(route_lanelets);
+  return getDistanceToIndexedStopLine(
+    traffic_light_stop_line_index_, route_lanelets, from, maximum_distance,
+    [&](const auto & position) {
+      return std::find(traffic_light_ids.begin(), traffic_light_ids.end(), position.owner_id) !=
+             traffic_light_ids.end();
+    });
+}
+
+auto HdMapUtils::getDistanceToTrafficLightStopLine(
+  const lanelet::Ids & route_lanelets, const traffic_simulator_msgs::msg::LaneletPose & from,
+  double maximum_distance, const lanelet::Id traffic_light_id) const -> std::optional<double>
+{
+  return getDistanceToIndexedStopLine(
+    traffic_light_stop_line_index_, route_lanelets, from, maximum_distance,
+    [&](const auto & position) { return position.owner_id == traffic_light_id; });
+}
+
+auto HdMapUtils::getDistanceToStopLine(
+  const lanelet::Ids & route_lanelets, const traffic_simulator_msgs::msg::LaneletPose & from,
+  double maximum_distance) const -> std::optional<double>
+{
+  return getDistanceToIndexedStopLine(
+    stop_line_index_, route_lanelets, from, maximum_distance, [&](const auto & position) {
+      return std::find(route_lanelets.begin(), route_lanelets.end(), position.owner_id) !=
+             route_lanelets.end();
+    });
+}
+
+auto HdMapUtils::getDistanceToIndexedStopLine(
+  const StopLineIndex & index, const lanelet::Ids & route_lanelets,
+  const traffic_simulator_msgs::msg::LaneletPose & from, double maximum_distance,
+  const std::function<bool(const StopLineIndex::Position &)> & predicate) const
+  -> std::optional<double>
+{
+  auto lanelet_id = std::find(route_lanelets.begin(), route_lanelets.end(), from.lanelet_id);
+  if (lanelet_id == route_lanelets.end()) {
+    THROW_SEMANTIC_ERROR(
+      "lanelet id ", from.lanelet_id, " of the pose to measure the distance to a stop line from ",
+      "is not on the route.");
+  }
+  /// @note Distance from the given pose to the start of the lanelet pointed by lanelet_id.
+  double distance_to_lanelet = -from.s;
+  for (; lanelet_id != route_lanelets.end() and distance_to_lanelet <= maximum_distance;
+       ++lanelet_id) {
+    for (const auto & position : index.find(*lanelet_id)) {
+      if (const auto distance = distance_to_lanelet + position.s;
+          0 <= distance and distance <= maximum_distance and predicate(position)) {
+        return distance;
+      }
+    }
+    distance_to_lanelet = distance_to_lanelet + getCenterPointsSpline(*lanelet_id)->getLength();
+  }
+  return std::nullopt;
+}
+
 auto HdMapUtils::getDistanceToStopLine(
   const lanelet::Ids & route_lanelets,
   const std::vector<geometry_msgs::msg::Point> & waypoints) const -> std::optional<double>
@@ -0,0 +1,173 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <thread>
+#include <traffic_simulator/hdmap_utils/lanelet_distance_table.hpp>
+#include <utility>
+#include <vector>
+
+namespace hdmap_utils
+{
+LaneletDistanceTable::LaneletDistanceTable(
+  const std::unordered_map<lanelet::Id, lanelet::Ids> & following_lanelet_ids,
+  const std::unordered_map<lanelet::Id, double> & lanelet_lengths, std::size_t hop_limit,
+  std::size_t max_entries)
+{
+  /// @note Sort the lanelet ids so that the table does not depend on the order of unordered_map.
+  lanelet::Ids lanelet_ids;
+  lanelet_ids.reserve(lanelet_lengths.size());
+  for (const auto & [lanelet_id, length] : lanelet_lengths) {
+    lanelet_ids.push_back(lanelet_id);
+  }
+  std::sort(lanelet_ids.begin(), lanelet_ids.end());
+  for (const auto lanelet_id : lanelet_ids) {
+    indices_.emplace(lanelet_id, static_cast<Index>(indices_.size()));
+  }
+
+  const auto size = lanelet_ids.size();
+  std::vector<double> lengths(size);
+  std::vector<std::vector<Index>> following(size);
+  for (Index i = 0; i < size; ++i) {
+    lengths[i] = lanelet_lengths.at(lanelet_ids[i]);
+    if (const auto ids = following_lanelet_ids.find(lanelet_ids[i]);
+        ids != following_lanelet_ids.end()) {
+      for (const auto id : ids->second) {
+        if (const auto index = indices_.find(id); index != indices_.end()) {
+          following[i].push_back(index->second);
+        }
+      }
+    }
+  }
+  if (size == 0 or hop_limit == 0) {
+    offsets_.assign(size + 1, 0);
+    return;
+  }
+  const auto max_row_entries = std::max<std::size_t>(1, max_entries / size);
+
+  std::vector<std::vector<std::pair<Index, double>>> rows(size);
+  std::atomic<std::size_t> next_source = 0;
+  const auto search = [&]() {
+    constexpr auto infinity = std::numeric_limits<double>::infinity();
+    std::vector<double> labels(size, infinity);
+    std::vector<std::size_t> hops(size, 0);
+    std::vector<bool> settled(size, false);
+    std::vector<Index> touched;
+    using QueueElement = std::pair<double, Index>;
+    for (auto source = next_source++; source < size; source = next_source++) {
+      std::priority_queue<QueueElement, std::vector<QueueElement>, std::greater<QueueElement>>
+        queue;
+      auto & row = rows[source];
+      labels[source] = 0;
+      touched.push_back(source);
+      queue.emplace(0, source);
+      /**
+       * @note Lower bound of every route leaving the hop bounded search.
+       * Lanelets settled at or below it are exact, the search stops beyond it.
+       */
+      double bound = infinity;
+      while (not queue.empty()) {
+        const auto [distance, index] = queue.top();
+        queue.pop();
+        if (settled[index] or distance > labels[index]) {
+          continue;
+        }
+        if (distance > bound) {
+          break;
+        }
+        settled[index] = true;
+        if (index != source) {
+          row.emplace_back(index, distance);
+          if (row.size() >= max_row_entries) {
+            break;
+          }
+        }
+        const auto through = index == source ? 0.0 : distance + lengths[index];
+        if (hops[index] >= hop_limit) {
+          bound = std::min(bound, through);
+          continue;
+        }
+        for (const auto next : following[index]) {
+          if (next != source and not settled[next] and through < labels[next]) {
+            if (labels[next] == infinity) {
+              touched.push_back(next);
+            }
+            labels[next] = through;
+            hops[next] = hops[index] + 1;
+            queue.emplace(through, next);
+          }
+        }
+      }
+      std::sort(row.begin(), row.end());
+      for (const auto index : touched) {
+        labels[index] = infinity;
+        hops[index] = 0;
+        settled[index] = false;
+      }
+      touched.clear();
+    }
+  };
+  std::vector<std::thread> workers;
+  for (unsigned int i = 1; i < std::max(1u, std::thread::hardware_concurrency()); ++i) {
+    workers.emplace_back(search);
+  }
+  search();
+  for (auto & worker : workers) {
+    worker.join();
+  }
+
+  offsets_.reserve(size + 1);
+  offsets_.push_back(0);
+  for (const auto & row : rows) {
+    offsets_.push_back(offsets_.back() + row.size());
+  }
+  targets_.reserve(offsets_.back());
+  distances_.reserve(offsets_.back());
+  for (const auto & row : rows) {
+    for (const auto & [target, distance] : row) {
+      targets_.push_back(target);
+      distances_.push_back(distance);
+    }
+  }
+}
+
+auto LaneletDistanceTable::getDistanceBetween(lanelet::Id from, lanelet::Id to) const
+  -> std::optional<double>
+{
+  const auto from_index = indices_.find(from);
+  const auto to_index = indices_.find(to);
+  if (from_index == indices_.end() or to_index == indices_.end()) {
+    return std::nullopt;
+  }
+  const auto begin = targets_.begin() + offsets_[from_index->second];
+  const auto end = targets_.begin() + offsets_[from_index->second + 1];
+  if (const auto target = std::lower_bound(begin, end, to_index->second);
+      target != end and *target == to_index->second) {
+    return distances_[target - targets_.begin()];
+  }
+  return std::nullopt;
+}
+
+auto LaneletDistanceTable::memoryUsage() const -> std::size_t
+{
+  /// @note Each node of unordered_map holds the value and a pointer to the next node.
+  return indices_.size() * (sizeof(std::pair<const lanelet::Id, Index>) + sizeof(void *)) +
+         indices_.bucket_count() * sizeof(void *) + offsets_.capacity() * sizeof(std::size_t) +
+         targets_.capacity() * sizeof(Index) + distances_.capacity() * sizeof(double);
+}
+}  // namespace hdmap_utils
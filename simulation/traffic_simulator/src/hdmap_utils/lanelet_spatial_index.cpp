@@ -0,0 +1,165 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <traffic_simulator/hdmap_utils/lanelet_spatial_index.hpp>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hdmap_utils
+{
+LaneletSpatialIndex::LaneletSpatialIndex(const lanelet::LaneletMap & lanelet_map)
+{
+  namespace bg = boost::geometry;
+  std::vector<std::pair<Box, std::size_t>> polygon_boxes;
+  std::vector<std::pair<Box, std::size_t>> segment_boxes;
+  for (const auto & lanelet : lanelet_map.laneletLayer) {
+    Polygon polygon;
+    for (const auto & point : lanelet.polygon2d()) {
+      polygon.outer().push_back(bg::make<Point>(point.x(), point.y()));
+    }
+    if (polygon.outer().empty()) {
+      continue;
+    }
+    polygon.outer().push_back(polygon.outer().front());
+    polygon_boxes.emplace_back(bg::return_envelope<Box>(polygon), polygons_.size());
+    polygons_.emplace_back(lanelet.id(), polygon);
+
+    const auto centerline = lanelet.centerline2d();
+    const auto first_segment = segments_.size();
+    double s = 0;
+    for (std::size_t i = 1; i < centerline.size(); ++i) {
+      const auto start = bg::make<Point>(centerline[i - 1].x(), centerline[i - 1].y());
+      const auto end = bg::make<Point>(centerline[i].x(), centerline[i].y());
+      Box box;
+      bg::envelope(bg::model::segment<Point>(start, end), box);
+      segment_boxes.emplace_back(box, segments_.size());
+      segments_.push_back({lanelet.id(), start, end, s, i == 1, i + 1 == centerline.size()});
+      s = s + bg::distance(start, end);
+    }
+    segment_ranges_.emplace(lanelet.id(), std::make_pair(first_segment, segments_.size()));
+  }
+  /// @note Use the packing algorithm of the range constructor, the index is never modified later.
+  polygon_rtree_ = decltype(polygon_rtree_)(polygon_boxes.begin(), polygon_boxes.end());
+  segment_rtree_ = decltype(segment_rtree_)(segment_boxes.begin(), segment_boxes.end());
+}
+
+auto LaneletSpatialIndex::getNearbyLanelets(
+  const Polygon & polygon, double distance_threshold) const
+  -> std::vector<std::pair<lanelet::Id, double>>
+{
+  namespace bg = boost::geometry;
+  auto search_box = bg::return_envelope<Box>(polygon);
+  search_box.min_corner().x(search_box.min_corner().x() - distance_threshold);
+  search_box.min_corner().y(search_box.min_corner().y() - distance_threshold);
+  search_box.max_corner().x(search_box.max_corner().x() + distance_threshold);
+  search_box.max_corner().y(search_box.max_corner().y() + distance_threshold);
+
+  std::vector<std::pair<lanelet::Id, double>> ret;
+  for (auto itr = polygon_rtree_.qbegin(bg::index::intersects(search_box));
+       itr != polygon_rtree_.qend(); ++itr) {
+    const auto & [lanelet_id, lanelet_polygon] = polygons_[itr->second];
+    if (const auto distance = bg::distance(polygon, lanelet_polygon);
+        distance <= distance_threshold) {
+      ret.emplace_back(lanelet_id, distance);
+    }
+  }
+  std::sort(ret.begin(), ret.end(), [](const auto & lhs, const auto & rhs) {
+    return lhs.second < rhs.second;
+  });
+  return ret;
+}
+
+auto LaneletSpatialIndex::getNearbyLaneletMatches(
+  const geometry_msgs::msg::Point & point, double distance_threshold) const
+  -> std::vector<LaneletMatch>
+{
+  namespace bg = boost::geometry;
+  const Box search_box(
+    Point(point.x - distance_threshold, point.y - distance_threshold),
+    Point(point.x + distance_threshold, point.y + distance_threshold));
+
+  std::unordered_map<lanelet::Id, LaneletMatch> closest_matches;
+  for (auto itr = segment_rtree_.qbegin(bg::index::intersects(search_box));
+       itr != segment_rtree_.qend(); ++itr) {
+    const auto match = project(point, segments_[itr->second]);
+    if (std::fabs(match.offset) > distance_threshold) {
+      continue;
+    }
+    if (const auto found = closest_matches.find(match.lanelet_id);
+        found == closest_matches.end()) {
+      closest_matches.emplace(match.lanelet_id, match);
+    } else if (std::fabs(match.offset) < std::fabs(found->second.offset)) {
+      found->second = match;
+    }
+  }
+
+  std::vector<LaneletMatch> ret;
+  ret.reserve(closest_matches.size());
+  for (const auto & [lanelet_id, match] : closest_matches) {
+    ret.push_back(match);
+  }
+  /// @note Tie-break by lanelet id, the order of unordered_map must not leak into the result.
+  std::sort(ret.begin(), ret.end(), [](const auto & lhs, const auto & rhs) {
+    return std::make_pair(std::fabs(lhs.offset), lhs.lanelet_id) <
+           std::make_pair(std::fabs(rhs.offset), rhs.lanelet_id);
+  });
+  return ret;
+}
+
+auto LaneletSpatialIndex::getLaneletMatch(
+  const geometry_msgs::msg::Point & point, lanelet::Id lanelet_id) const
+  -> std::optional<LaneletMatch>
+{
+  const auto range = segment_ranges_.find(lanelet_id);
+  if (range == segment_ranges_.end() or range->second.first == range->second.second) {
+    return std::nullopt;
+  }
+  std::optional<LaneletMatch> ret;
+  for (auto i = range->second.first; i < range->second.second; ++i) {
+    if (const auto match = project(point, segments_[i]);
+        not ret or std::fabs(match.offset) < std::fabs(ret->offset)) {
+      ret = match;
+    }
+  }
+  return ret;
+}
+
+auto LaneletSpatialIndex::project(
+  const geometry_msgs::msg::Point & point, const Segment & segment) const -> LaneletMatch
+{
+  const double dx = segment.end.x() - segment.start.x();
+  const double dy = segment.end.y() - segment.start.y();
+  const double length = std::hypot(dx, dy);
+  const double px = point.x - segment.start.x();
+  const double py = point.y - segment.start.y();
+  const double t = length <= std::numeric_limits<double>::epsilon()
+                     ? 0.0
+                     : (px * dx + py * dy) / (length * length);
+  const double clamped_t = std::clamp(t, 0.0, 1.0);
+  const double distance = std::hypot(px - clamped_t * dx, py - clamped_t * dy);
+  const double cross = dx * py - dy * px;
+  LaneletMatch match;
+  match.lanelet_id = segment.lanelet_id;
+  match.s = segment.s + clamped_t * length;
+  match.offset = cross < 0 ? -distance : distance;
+  match.yaw = std::atan2(dy, dx);
+  match.inside = not(segment.first and t < 0) and not(segment.last and t > 1);
+  return match;
+}
+}  // namespace hdmap_utils
@@ -0,0 +1,293 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <lanelet2_core/utility/Utilities.h>
+#include <lanelet2_io/io_handlers/Serialize.h>
+
+#include <algorithm>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <traffic_simulator/hdmap_utils/map_cache.hpp>
+#include <vector>
+
+namespace hdmap_utils
+{
+namespace
+{
+constexpr char magic[8] = {'S', 'S', 'V', 'M', 'A', 'P', 'C', '\0'};
+
+struct Header
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t reserved;
+  std::uint64_t key;
+  std::uint64_t lanelet_count;
+  std::uint64_t adjacency_count;
+  std::uint64_t shoulder_count;
+  std::uint64_t archive_size;
+};
+
+/// @note Next lanelet ids are followed by the previous lanelet ids in the adjacency array.
+struct LaneletRecord
+{
+  std::int64_t lanelet_id;
+  double length;
+  std::uint64_t adjacency_offset;
+  std::uint32_t next_count;
+  std::uint32_t previous_count;
+};
+
+/// @note 64 bit FNV-1a, only used to detect that the map or the origin changed.
+auto hash(std::uint64_t seed, const void * data, std::size_t size) -> std::uint64_t
+{
+  const auto * bytes = static_cast<const unsigned char *>(data);
+  for (std::size_t i = 0; i < size; ++i) {
+    seed = (seed ^ bytes[i]) * 1099511628211ULL;
+  }
+  return seed;
+}
+
+auto makeKey(
+  const boost::filesystem::path & lanelet2_map_path, const geographic_msgs::msg::GeoPoint & origin)
+  -> std::uint64_t
+{
+  namespace bip = boost::interprocess;
+  const bip::file_mapping file(lanelet2_map_path.c_str(), bip::read_only);
+  const bip::mapped_region region(file, bip::read_only);
+  auto key = hash(14695981039346656037ULL, region.get_address(), region.get_size());
+  for (const auto value : {origin.latitude, origin.longitude, origin.altitude}) {
+    key = hash(key, &value, sizeof(value));
+  }
+  return hash(key, &MapCache::version, sizeof(MapCache::version));
+}
+
+template <typename T>
+auto write(std::ostream & stream, const std::vector<T> & values) -> void
+{
+  stream.write(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(T));
+}
+}  // namespace
+
+MapCache::MapCache(
+  const boost::filesystem::path & lanelet2_map_path, const geographic_msgs::msg::GeoPoint & origin,
+  const boost::filesystem::path & cache_directory)
+{
+  if (cache_directory.empty()) {
+    return;
+  }
+  std::uint64_t source = 0;
+  try {
+    key_ = makeKey(lanelet2_map_path, origin);
+    const auto source_path = boost::filesystem::canonical(lanelet2_map_path).string();
+    source = hash(14695981039346656037ULL, source_path.data(), source_path.size());
+  } catch (const std::exception &) {
+    /// @note Leave the cache disabled, loading the map itself reports the error.
+    return;
+  }
+  /// @note Most maps are named lanelet2_map.osm, the hash of the path tells their caches apart.
+  std::stringstream file_name;
+  file_name << lanelet2_map_path.stem().string() << std::hex << std::setfill('0') << "-"
+            << std::setw(16) << source << "-" << std::setw(16) << key_ << ".bin";
+  path_ = cache_directory / file_name.str();
+}
+
+auto MapCache::defaultDirectory() -> boost::filesystem::path
+{
+  return boost::filesystem::temp_directory_path() / "traffic_simulator" / "map_cache";
+}
+
+auto MapCache::sharedMemoryDirectory() -> boost::filesystem::path
+{
+  if (const boost::filesystem::path shm = "/dev/shm"; boost::filesystem::is_directory(shm)) {
+    return shm / "traffic_simulator" / "map_cache";
+  }
+  return defaultDirectory();
+}
+
+auto MapCache::load() const -> std::optional<MapCacheData>
+{
+  namespace bip = boost::interprocess;
+  if (path_.empty() or not boost::filesystem::exists(path_)) {
+    return std::nullopt;
+  }
+  try {
+    const bip::file_mapping file(path_.c_str(), bip::read_only);
+    const bip::mapped_region region(file, bip::read_only);
+    const auto * begin = static_cast<const char *>(region.get_address());
+    const auto size = region.get_size();
+
+    Header header;
+    if (size < sizeof(Header)) {
+      return std::nullopt;
+    }
+    std::memcpy(&header, begin, sizeof(Header));
+    if (
+      std::memcmp(header.magic, magic, sizeof(magic)) != 0 or header.version != version or
+      header.key != key_ or header.lanelet_count > size or header.adjacency_count > size or
+      header.shoulder_count > size or header.archive_size > size or
+      sizeof(Header) + header.lanelet_count * sizeof(LaneletRecord) +
+          (header.adjacency_count + header.shoulder_count) * sizeof(std::int64_t) +
+          header.archive_size !=
+        size) {
+      return std::nullopt;
+    }
+    const auto * records = begin + sizeof(Header);
+    const auto * adjacency = records + header.lanelet_count * sizeof(LaneletRecord);
+    const auto * shoulders = adjacency + header.adjacency_count * sizeof(std::int64_t);
+    const auto * archive = shoulders + header.shoulder_count * sizeof(std::int64_t);
+
+    const auto read_ids = [&](const char * ids, std::uint64_t offset, std::uint64_t count) {
+      lanelet::Ids ret(count);
+      std::memcpy(ret.data(), ids + offset * sizeof(std::int64_t), count * sizeof(std::int64_t));
+      return ret;
+    };
+
+    MapCacheData data;
+    data.lanelet_lengths.reserve(header.lanelet_count);
+    for (std::uint64_t i = 0; i < header.lanelet_count; ++i) {
+      LaneletRecord record;
+      std::memcpy(&record, records + i * sizeof(LaneletRecord), sizeof(LaneletRecord));
+      if (
+        record.adjacency_offset + record.next_count + record.previous_count >
+        header.adjacency_count) {
+        return std::nullopt;
+      }
+      data.lanelet_lengths.emplace(record.lanelet_id, record.length);
+      data.next_lanelet_ids.emplace(
+        record.lanelet_id, read_ids(adjacency, record.adjacency_offset, record.next_count));
+      data.previous_lanelet_ids.emplace(
+        record.lanelet_id, read_ids(
+                             adjacency, record.adjacency_offset + record.next_count,
+                             record.previous_count));
+    }
+    data.shoulder_lanelet_ids = read_ids(shoulders, 0, header.shoulder_count);
+
+    /// @note Deserialize the lanelet map directly from the mapped memory, without copying it.
+    boost::iostreams::stream<boost::iostreams::array_source> stream(archive, header.archive_size);
+    boost::archive::binary_iarchive input_archive(stream);
+    data.lanelet_map = std::make_shared<lanelet::LaneletMap>();
+    input_archive >> *data.lanelet_map;
+    lanelet::Id id_counter;
+    input_archive >> id_counter;
+    lanelet::utils::registerId(id_counter);
+    return data;
+  } catch (const std::exception &) {
+    return std::nullopt;
+  }
+}
+
+auto MapCache::save(const MapCacheData & data) const -> void
+{
+  if (path_.empty()) {
+    return;
+  }
+  try {
+    std::stringstream archive;
+    {
+      boost::archive::binary_oarchive output_archive(archive);
+      output_archive << *data.lanelet_map;
+      auto id_counter = lanelet::utils::getId();
+      output_archive << id_counter;
+    }
+    const auto archive_string = archive.str();
+
+    /// @note Sort the lanelets so that the same map always produces the same file.
+    lanelet::Ids lanelet_ids;
+    lanelet_ids.reserve(data.lanelet_lengths.size());
+    for (const auto & [lanelet_id, length] : data.lanelet_lengths) {
+      lanelet_ids.push_back(lanelet_id);
+    }
+    std::sort(lanelet_ids.begin(), lanelet_ids.end());
+
+    const auto find_ids = [](const auto & table, lanelet::Id lanelet_id) -> lanelet::Ids {
+      if (const auto ids = table.find(lanelet_id); ids != table.end()) {
+        return ids->second;
+      }
+      return {};
+    };
+
+    std::vector<LaneletRecord> records;
+    std::vector<std::int64_t> adjacency;
+    records.reserve(lanelet_ids.size());
+    for (const auto lanelet_id : lanelet_ids) {
+      const auto next_ids = find_ids(data.next_lanelet_ids, lanelet_id);
+      const auto previous_ids = find_ids(data.previous_lanelet_ids, lanelet_id);
+      records.push_back(
+        {lanelet_id, data.lanelet_lengths.at(lanelet_id), adjacency.size(),
+         static_cast<std::uint32_t>(next_ids.size()),
+         static_cast<std::uint32_t>(previous_ids.size())});
+      adjacency.insert(adjacency.end(), next_ids.begin(), next_ids.end());
+      adjacency.insert(adjacency.end(), previous_ids.begin(), previous_ids.end());
+    }
+    const std::vector<std::int64_t> shoulders(
+      data.shoulder_lanelet_ids.begin(), data.shoulder_lanelet_ids.end());
+
+    Header header;
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.reserved = 0;
+    header.key = key_;
+    header.lanelet_count = records.size();
+    header.adjacency_count = adjacency.size();
+    header.shoulder_count = shoulders.size();
+    header.archive_size = archive_string.size();
+
+    /// @note Write a temporary file and rename it, concurrent readers never see a partial file.
+    boost::filesystem::create_directories(path_.parent_path());
+    const auto temporary_path = boost::filesystem::unique_path(path_.string() + ".%%%%-%%%%");
+    {
+      std::ofstream file(temporary_path.string(), std::ios::binary);
+      file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+      write(file, records);
+      write(file, adjacency);
+      write(file, shoulders);
+      file.write(archive_string.data(), archive_string.size());
+      if (not file) {
+        file.close();
+        boost::filesystem::remove(temporary_path);
+        return;
+      }
+    }
+    boost::filesystem::rename(temporary_path, path_);
+    /// @note Remove the other caches of the same map file, written for an older version of the
+    /// map or another origin, which would otherwise stay in memory on tmpfs. The caches of map
+    /// files at other paths are kept. A process which mapped a removed cache keeps reading it.
+    const auto file_name = path_.filename().string();
+    const auto prefix = file_name.substr(0, file_name.rfind('-') + 1);
+    for (const auto & each : boost::make_iterator_range(
+           boost::filesystem::directory_iterator(path_.parent_path()), {})) {
+      const auto other = each.path().filename().string();
+      if (
+        other != file_name and other.size() == file_name.size() and
+        other.compare(0, prefix.size(), prefix) == 0 and each.path().extension() == ".bin") {
+        boost::filesystem::remove(each.path());
+      }
+    }
+  } catch (const std::exception &) {
+    /// @note The cache directory may be read-only, the map is loaded cold next time.
+  }
+}
+}  // namespace hdmap_utils
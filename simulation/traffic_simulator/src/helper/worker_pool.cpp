@@ -0,0 +1,109 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <traffic_simulator/helper/worker_pool.hpp>
+
+namespace traffic_simulator
+{
+namespace helper
+{
+WorkerPool::WorkerPool(std::size_t thread_count)
+: chunks_(std::max<std::size_t>(thread_count, 1))
+{
+  for (std::size_t i = 1; i < chunks_.size(); ++i) {
+    workers_.emplace_back([this, i]() { work(i); });
+  }
+}
+
+WorkerPool::~WorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_requested_ = true;
+  }
+  started_.notify_all();
+  for (auto & worker : workers_) {
+    worker.join();
+  }
+}
+
+auto WorkerPool::parallelFor(std::size_t size, const std::function<void(std::size_t)> & function)
+  -> void
+{
+  /// @note Run on the calling thread only, if there is nothing to split.
+  const auto chunk_count = size <= 1 ? 1 : chunks_.size();
+  for (std::size_t i = 0; i < chunk_count; ++i) {
+    chunks_[i].begin = size * i / chunk_count;
+    chunks_[i].end = size * (i + 1) / chunk_count;
+    chunks_[i].thrown = nullptr;
+  }
+  if (chunk_count == 1) {
+    function_ = &function;
+    run(chunks_.front());
+  } else {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      function_ = &function;
+      running_ = workers_.size();
+      ++generation_;
+    }
+    started_.notify_all();
+    run(chunks_.front());
+    std::unique_lock<std::mutex> lock(mutex_);
+    finished_.wait(lock, [this]() { return running_ == 0; });
+  }
+  function_ = nullptr;
+  /// @note Chunks are ordered by iteration, so the first thrown exception has the smallest index.
+  for (std::size_t i = 0; i < chunk_count; ++i) {
+    if (chunks_[i].thrown) {
+      std::rethrow_exception(chunks_[i].thrown);
+    }
+  }
+}
+
+auto WorkerPool::run(Chunk & chunk) const -> void
+{
+  for (auto i = chunk.begin; i < chunk.end; ++i) {
+    try {
+      (*function_)(i);
+    } catch (...) {
+      chunk.thrown = std::current_exception();
+      return;
+    }
+  }
+}
+
+auto WorkerPool::work(std::size_t chunk_index) -> void
+{
+  std::uint64_t generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      started_.wait(lock, [&]() { return stop_requested_ or generation_ != generation; });
+      if (stop_requested_) {
+        return;
+      }
+      generation = generation_;
+    }
+    run(chunks_[chunk_index]);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      --running_;
+    }
+    finished_.notify_one();
+  }
+}
+}  // namespace helper
+}  // namespace traffic_simulator
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <iterator>
 #include <memory>
 #include <string>
@@ -27,18 +28,54 @@ TrafficLightManager::TrafficLightManager(const std::shared_ptr<hdmap_utils::HdMa
 {
 }
 
-auto TrafficLightManager::hasAnyLightChanged() -> bool
+auto TrafficLightManager::ChangeTracker::changed(
+  const lanelet::Id id, const TrafficLight & traffic_light) const -> bool
 {
-  return true;
-  // return std::any_of(
-  //   std::begin(getTrafficLights()), std::end(getTrafficLights()), [](auto && id_and_traffic_light) {
-  //     return id_and_traffic_light.second.colorChanged() or
-  //            id_and_traffic_light.second.arrowChanged();
-  //   });
+  if (const auto iter = taken_.find(id); iter == std::end(taken_)) {
+    return true;
+  } else if (const auto & taken = iter->second; taken.generation == traffic_light.generation()) {
+    return false;
+  } else {
+    return taken.confidence != traffic_light.confidence or
+           not std::equal(
+             std::begin(taken.bulbs), std::end(taken.bulbs), std::begin(traffic_light.bulbs),
+             std::end(traffic_light.bulbs),
+             [](const auto & hash, const auto & bulb) { return hash == bulb.hash(); });
+  }
+}
+
+auto TrafficLightManager::ChangeTracker::take(
+  const lanelet::Id id, const TrafficLight & traffic_light) -> bool
+{
+  if (changed(id, traffic_light)) {
+    auto & taken = taken_[id];
+    taken.generation = traffic_light.generation();
+    taken.bulbs.clear();
+    for (const auto & bulb : traffic_light.bulbs) {
+      taken.bulbs.push_back(bulb.hash());
+    }
+    taken.confidence = traffic_light.confidence;
+    return true;
+  } else {
+    /// @note Unchanged, but the generation moved, so that it is not compared again next time.
+    taken_.at(id).generation = traffic_light.generation();
+    return false;
+  }
+}
+
+auto TrafficLightManager::hasAnyLightChanged(const ChangeTracker & tracker) -> bool
+{
+  std::lock_guard<std::mutex> lock(traffic_lights_mutex_);
+  return std::any_of(
+    std::begin(traffic_lights_), std::end(traffic_lights_),
+    [&](const auto & id_and_traffic_light) {
+      return tracker.changed(id_and_traffic_light.first, id_and_traffic_light.second);
+    });
 }
 
 auto TrafficLightManager::getTrafficLight(const lanelet::Id traffic_light_id) -> TrafficLight &
 {
+  std::lock_guard<std::mutex> lock(traffic_lights_mutex_);
   if (auto iter = traffic_lights_.find(traffic_light_id); iter != std::end(traffic_lights_)) {
     return iter->second;
   } else {
@@ -87,4 +124,20 @@ auto TrafficLightManager::generateUpdateTrafficLightsRequest()
   return update_traffic_lights_request;
 }
 
+auto TrafficLightManager::generateUpdateTrafficLightsRequest(
+  ChangeTracker & tracker, const bool only_changed)
+  -> simulation_api_schema::UpdateTrafficLightsRequest
+{
+  std::lock_guard<std::mutex> lock(traffic_lights_mutex_);
+  simulation_api_schema::UpdateTrafficLightsRequest update_traffic_lights_request;
+  update_traffic_lights_request.set_only_changed(only_changed);
+  for (auto && [lanelet_id, traffic_light] : traffic_lights_) {
+    if (tracker.take(lanelet_id, traffic_light) or not only_changed) {
+      *update_traffic_lights_request.add_states() =
+        static_cast<simulation_api_schema::TrafficSignal>(traffic_light);
+    }
+  }
+  return update_traffic_lights_request;
+}
+
 }  // namespace traffic_simulator
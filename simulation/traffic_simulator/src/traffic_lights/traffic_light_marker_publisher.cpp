@@ -44,11 +44,17 @@ auto TrafficLightMarkerPublisher::drawMarkers() const -> void
 
 auto TrafficLightMarkerPublisher::publish() -> void
 {
-  if (traffic_light_manager_->hasAnyLightChanged()) {
-    deleteAllMarkers();
+  /// @note Every light is taken, so that the tracker is up to date for the next frame.
+  bool changed = false;
+  for (const auto & [id, traffic_light] : traffic_light_manager_->getTrafficLights()) {
+    changed = drawn_.take(id, traffic_light) or changed;
   }
 
-  drawMarkers();
+  /// @note The message is transient local, so the last one sent must hold every marker.
+  if (changed) {
+    deleteAllMarkers();
+    drawMarkers();
+  }
 }
 
 }  // namespace traffic_simulator
@@ -0,0 +1,160 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <rclcpp/rclcpp.hpp>
+#include <simulation_interface/zmq_multi_server.hpp>
+#include <string>
+#include <traffic_simulator/api/api.hpp>
+#include <traffic_simulator/helper/helper.hpp>
+#include <vector>
+
+#include "../catalogs.hpp"
+#include "../map_directory.hpp"
+
+constexpr int port = 5566;
+
+/// @note Names of the handlers called by the server, in the order they were called.
+std::vector<std::string> handled;
+
+std::unique_ptr<MapDirectory> map_directory;
+
+template <typename Response>
+auto succeed(const std::string & name) -> Response
+{
+  handled.push_back(name);
+  Response response;
+  response.mutable_result()->set_success(true);
+  return response;
+}
+
+/**
+ * @brief Simulator answering the entity status with the status it was sent, as a simulator which
+ * does not move the NPCs does. Shut down with rclcpp after the last test, since MultiServer polls
+ * until rclcpp::ok() is false.
+ */
+class Server : public testing::Environment
+{
+public:
+  auto SetUp() -> void override
+  {
+    map_directory = std::make_unique<MapDirectory>("test_update_frame");
+
+    namespace schema = simulation_api_schema;
+    server_ = std::make_unique<zeromq::MultiServer>(
+      simulation_interface::protocol, simulation_interface::HostName::ANY, port,
+      [](const auto &) { return succeed<schema::InitializeResponse>("initialize"); },
+      [](const auto &) { return succeed<schema::UpdateFrameResponse>("update_frame"); },
+      [](const auto &) { return succeed<schema::SpawnVehicleEntityResponse>("spawn"); },
+      [](const auto &) { return succeed<schema::SpawnPedestrianEntityResponse>("spawn"); },
+      [](const auto &) { return succeed<schema::SpawnMiscObjectEntityResponse>("spawn"); },
+      [](const auto &) { return succeed<schema::DespawnEntityResponse>("despawn"); },
+      [](const schema::UpdateEntityStatusRequest & request) {
+        auto response = succeed<schema::UpdateEntityStatusResponse>("update_entity_status");
+        for (const auto & status : request.status()) {
+          auto updated_status = response.add_status();
+          updated_status->set_name(status.name());
+          *updated_status->mutable_action_status() = status.action_status();
+          *updated_status->mutable_pose() = status.pose();
+        }
+        return response;
+      },
+      [](const auto &) { return succeed<schema::AttachLidarSensorResponse>("attach"); },
+      [](const auto &) { return succeed<schema::AttachDetectionSensorResponse>("attach"); },
+      [](const auto &) { return succeed<schema::AttachOccupancyGridSensorResponse>("attach"); },
+      [](const auto &) {
+        return succeed<schema::UpdateTrafficLightsResponse>("update_traffic_lights");
+      },
+      [](const auto &) { return succeed<schema::FollowPolylineTrajectoryResponse>("follow"); },
+      [](const auto &) {
+        return succeed<schema::AttachPseudoTrafficLightDetectorResponse>("attach");
+      });
+  }
+
+  auto TearDown() -> void override
+  {
+    rclcpp::shutdown();
+    server_.reset();
+    map_directory.reset();
+  }
+
+private:
+  std::unique_ptr<zeromq::MultiServer> server_;
+};
+
+auto makeNode(const std::string & name) -> std::shared_ptr<rclcpp::Node>
+{
+  return std::make_shared<rclcpp::Node>(
+    name, rclcpp::NodeOptions().parameter_overrides({{"port", port}}));
+}
+
+auto makeLaneletPose(const traffic_simulator::API & api, double s)
+{
+  return api.canonicalize(traffic_simulator::helper::constructLaneletPose(34513, s));
+}
+
+/**
+ * @brief The status the simulator answers for an NPC was sent before the NPC was updated, so
+ * applying it one frame late would move the NPC back to where it was in the previous frame.
+ */
+TEST(PipelinedFrame, NpcKeepsMoving)
+{
+  traffic_simulator::Configuration configuration(map_directory->path());
+  configuration.pipelined_update_frame = true;
+  traffic_simulator::API api(makeNode("pipelined_frame"), configuration, 1.0, 20.0);
+
+  ASSERT_TRUE(api.spawn("npc", makeLaneletPose(api, 0.0), getMiscObjectParameters()));
+  api.startNpcLogic();
+  for (const auto s : {1.0, 2.0}) {
+    /// @note Moved by the scenario, since a misc object does not move by itself.
+    api.setEntityStatus("npc", makeLaneletPose(api, s));
+    ASSERT_TRUE(api.updateFrame());
+    const auto expected = api.toMapPose(makeLaneletPose(api, s)).position;
+    EXPECT_NEAR(api.getMapPose("npc").position.x, expected.x, 1e-3);
+    EXPECT_NEAR(api.getMapPose("npc").position.y, expected.y, 1e-3);
+  }
+  api.closeZMQConnection();
+}
+
+/**
+ * @brief The time of a frame waits for the entity status of the next frame, but is sent before
+ * any other request and when the connection is closed.
+ */
+TEST(FrameTransaction, SendsLastFrame)
+{
+  traffic_simulator::Configuration configuration(map_directory->path());
+  configuration.frame_transaction = true;
+  traffic_simulator::API api(makeNode("frame_transaction"), configuration, 1.0, 20.0);
+
+  api.startNpcLogic();
+  handled.clear();
+  ASSERT_TRUE(api.updateFrame());
+  ASSERT_TRUE(api.spawn("npc", makeLaneletPose(api, 0.0), getMiscObjectParameters()));
+  ASSERT_TRUE(api.updateFrame());
+  api.closeZMQConnection();
+  EXPECT_EQ(
+    handled, (std::vector<std::string>{
+               "update_entity_status", "update_frame", "spawn", "update_entity_status",
+               "update_frame"}));
+}
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+  testing::InitGoogleTest(&argc, argv);
+  testing::AddGlobalTestEnvironment(new Server());
+  return RUN_ALL_TESTS();
+}
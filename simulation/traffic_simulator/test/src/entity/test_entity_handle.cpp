@@ -0,0 +1,146 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <rclcpp/rclcpp.hpp>
+#include <scenario_simulator_exception/exception.hpp>
+#include <string>
+#include <traffic_simulator/entity/entity_manager.hpp>
+#include <traffic_simulator/helper/helper.hpp>
+#include <utility>
+#include <vector>
+
+#include "../catalogs.hpp"
+#include "../expect_eq_macros.hpp"
+#include "../map_directory.hpp"
+
+using traffic_simulator::EntityHandle;
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  rclcpp::init(argc, argv);
+  const auto result = RUN_ALL_TESTS();
+  rclcpp::shutdown();
+  return result;
+}
+
+/// @brief EntityManager with misc objects on one lanelet, since they need no behavior plugin.
+class EntityHandleTest : public testing::Test
+{
+protected:
+  auto SetUp() -> void override
+  {
+    entity_manager_ = std::make_unique<traffic_simulator::entity::EntityManager>(
+      node_, traffic_simulator::Configuration(map_directory_.path()));
+  }
+
+  auto spawn(const std::string & name, double s) -> EntityHandle
+  {
+    return entity_manager_->spawnEntity<traffic_simulator::entity::MiscObjectEntity>(
+      name,
+      traffic_simulator::CanonicalizedLaneletPose(
+        traffic_simulator::helper::constructLaneletPose(34513, s),
+        entity_manager_->getHdmapUtils()),
+      getMiscObjectParameters());
+  }
+
+  auto visited() const
+  {
+    std::vector<std::pair<EntityHandle, std::string>> visited;
+    entity_manager_->forEachEntity(
+      [&](const auto handle, const auto & name) { visited.emplace_back(handle, name); });
+    return visited;
+  }
+
+  const MapDirectory map_directory_{"test_entity_handle"};
+
+  const std::shared_ptr<rclcpp::Node> node_ = std::make_shared<rclcpp::Node>("test_entity_handle");
+
+  std::unique_ptr<traffic_simulator::entity::EntityManager> entity_manager_;
+};
+
+TEST_F(EntityHandleTest, RoundTrip)
+{
+  const std::vector<std::string> names = {"a", "b", "c"};
+  for (std::size_t i = 0; i < names.size(); ++i) {
+    const auto handle = spawn(names[i], 1.0 + 5.0 * i);
+    EXPECT_EQ(handle, EntityHandle(i));
+    EXPECT_EQ(entity_manager_->getEntityHandle(names[i]), handle);
+    EXPECT_EQ(entity_manager_->getEntityName(handle), names[i]);
+  }
+}
+
+TEST_F(EntityHandleTest, InvalidHandle)
+{
+  spawn("a", 1.0);
+  EXPECT_THROW(entity_manager_->getEntityName(EntityHandle(1)), common::SemanticError);
+  EXPECT_THROW(entity_manager_->getEntityStatus(EntityHandle(1)), common::SemanticError);
+  EXPECT_THROW(entity_manager_->getEntityHandle("b"), common::SemanticError);
+}
+
+/**
+ * @note The handle of a despawned entity stays valid, since its name is never reused, but the
+ * entity is no longer visited.
+ */
+TEST_F(EntityHandleTest, DespawnedHandle)
+{
+  const auto a = spawn("a", 1.0);
+  const auto b = spawn("b", 6.0);
+  const auto c = spawn("c", 11.0);
+  ASSERT_TRUE(entity_manager_->despawnEntity("b"));
+  EXPECT_EQ(entity_manager_->getEntityHandle("b"), b);
+  EXPECT_EQ(entity_manager_->getEntityName(b), "b");
+  EXPECT_EQ(
+    visited(), (std::vector<std::pair<EntityHandle, std::string>>{{a, "a"}, {c, "c"}}));
+  EXPECT_EQ(entity_manager_->getEntityNames(), (std::vector<std::string>{"a", "c"}));
+  EXPECT_THROW(spawn("b", 6.0), common::SemanticError);
+}
+
+TEST_F(EntityHandleTest, ForEachEntity)
+{
+  std::vector<std::pair<EntityHandle, std::string>> expected;
+  for (std::size_t i = 0; i < 10; ++i) {
+    const auto name = "entity" + std::to_string(i);
+    expected.emplace_back(spawn(name, 1.0 + 2.0 * i), name);
+  }
+  EXPECT_EQ(visited(), expected);
+}
+
+TEST_F(EntityHandleTest, SameAsNameOverloads)
+{
+  const auto a = spawn("a", 1.0);
+  const auto b = spawn("b", 11.0);
+
+  EXPECT_POSE_EQ(entity_manager_->getMapPose(a), entity_manager_->getMapPose("a"));
+  EXPECT_LANELET_POSE_EQ(
+    static_cast<traffic_simulator::EntityStatus>(entity_manager_->getEntityStatus(a)).lanelet_pose,
+    static_cast<traffic_simulator::EntityStatus>(entity_manager_->getEntityStatus("a"))
+      .lanelet_pose);
+  EXPECT_POSE_EQ(
+    entity_manager_->getRelativePose(a, b), entity_manager_->getRelativePose("a", "b"));
+  EXPECT_EQ(
+    entity_manager_->getBoundingBoxDistance(a, b),
+    entity_manager_->getBoundingBoxDistance("a", "b"));
+  EXPECT_EQ(
+    entity_manager_->getLateralDistance(a, b), entity_manager_->getLateralDistance("a", "b"));
+  EXPECT_EQ(
+    entity_manager_->getLongitudinalDistance(a, b),
+    entity_manager_->getLongitudinalDistance("a", "b"));
+  EXPECT_EQ(
+    entity_manager_->getLongitudinalDistance(b, a),
+    entity_manager_->getLongitudinalDistance("b", "a"));
+}
@@ -0,0 +1,132 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <rclcpp/rclcpp.hpp>
+#include <string>
+#include <thread>
+#include <traffic_simulator/entity/entity_status_array_publisher.hpp>
+
+using traffic_simulator::entity::EntityStatusArrayPublisher;
+
+constexpr double step_time = 0.05;
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  rclcpp::init(argc, argv);
+  const auto result = RUN_ALL_TESTS();
+  rclcpp::shutdown();
+  return result;
+}
+
+auto makePublisher(const std::shared_ptr<rclcpp::Node> & node)
+{
+  return node->create_publisher<EntityStatusArrayPublisher::Message>("entity/status", 1);
+}
+
+/// @note Waits for the publisher to match the subscription, which the middleware does
+/// asynchronously.
+template <typename Publisher>
+auto subscribe(const std::shared_ptr<rclcpp::Node> & node, const Publisher & publisher)
+{
+  auto subscription = node->create_subscription<EntityStatusArrayPublisher::Message>(
+    "entity/status", 1, [](const EntityStatusArrayPublisher::Message::SharedPtr) {});
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (publisher->get_subscription_count() == 0 and std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return subscription;
+}
+
+/// @note Fills the message as EntityManager::update does, with a trajectory of 50 waypoints.
+auto fill(EntityStatusArrayPublisher::Message & message, double time) -> void
+{
+  std::size_t i = 0;
+  for (auto & status_with_trajectory : message.data) {
+    status_with_trajectory.name = "npc" + std::to_string(i++);
+    status_with_trajectory.time = time;
+    status_with_trajectory.status.pose.position.x = i + time;
+    status_with_trajectory.waypoint.waypoints.resize(50);
+    status_with_trajectory.goal_pose.clear();
+    status_with_trajectory.goal_pose.emplace_back();
+    status_with_trajectory.obstacle_find = false;
+  }
+}
+
+TEST(EntityStatusArrayPublisher, NoSubscriber)
+{
+  const auto node = std::make_shared<rclcpp::Node>("NoSubscriber");
+  EntityStatusArrayPublisher publisher(makePublisher(node), 0.0);
+  bool filled = false;
+  EXPECT_FALSE(publisher.publish(0.0, 10, [&](auto &) { filled = true; }));
+  EXPECT_FALSE(filled);
+}
+
+TEST(EntityStatusArrayPublisher, PublishRate)
+{
+  const auto node = std::make_shared<rclcpp::Node>("PublishRate");
+  const auto rclcpp_publisher = makePublisher(node);
+  EntityStatusArrayPublisher publisher(rclcpp_publisher, 5.0);
+  const auto subscription = subscribe(node, rclcpp_publisher);
+  int published_count = 0;
+  for (int frame = 0; frame < 20; ++frame) {
+    const auto time = frame * step_time;
+    if (publisher.publish(time, 10, [&](auto & message) { fill(message, time); })) {
+      ++published_count;
+    }
+  }
+  EXPECT_EQ(published_count, 5);
+}
+
+/// @brief Time per frame of building a new status array message and of refilling a kept one.
+TEST(EntityStatusArrayPublisher, DISABLED_FrameTime)
+{
+  const auto node = std::make_shared<rclcpp::Node>("FrameTime");
+  constexpr int frame_count = 20;
+  auto measure = [&](auto && frame) {
+    const auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < frame_count; ++i) {
+      frame(i * step_time);
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin)
+             .count() /
+           frame_count;
+  };
+  for (const std::size_t entity_count : {100, 1000, 5000}) {
+    const auto publisher = makePublisher(node);
+    EntityStatusArrayPublisher reusing_publisher(publisher, 0.0);
+    const auto unsubscribed = measure([&](double time) {
+      reusing_publisher.publish(time, entity_count, [&](auto & message) { fill(message, time); });
+    });
+    const auto subscription = subscribe(node, publisher);
+    const auto new_message = measure([&](double time) {
+      EntityStatusArrayPublisher::Message message;
+      message.data.resize(entity_count);
+      fill(message, time);
+      publisher->publish(message);
+    });
+    const auto reused_message = measure([&](double time) {
+      reusing_publisher.publish(time, entity_count, [&](auto & message) { fill(message, time); });
+    });
+    std::cout << entity_count << " entities: " << new_message
+              << " ms per frame with a new message, " << reused_message
+              << " ms per frame with the message reused, " << unsubscribed
+              << " ms per frame without subscriber" << std::endl;
+  }
+}
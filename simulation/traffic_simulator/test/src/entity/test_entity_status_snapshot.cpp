@@ -0,0 +1,117 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <traffic_simulator/data_type/entity_status_snapshot.hpp>
+#include <unordered_map>
+#include <vector>
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+auto makeStatuses(std::size_t size)
+  -> std::vector<traffic_simulator::EntityStatusSnapshot::value_type>
+{
+  std::vector<traffic_simulator::EntityStatusSnapshot::value_type> statuses;
+  statuses.reserve(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    traffic_simulator::EntityStatus status;
+    status.name = "npc" + std::to_string(i);
+    status.pose.position.x = i;
+    status.lanelet_pose_valid = false;
+    statuses.emplace_back(
+      status.name, traffic_simulator::CanonicalizedEntityStatus(status, nullptr));
+  }
+  return statuses;
+}
+
+TEST(OtherEntityStatusView, ExcludesItself)
+{
+  const auto snapshot =
+    std::make_shared<const traffic_simulator::EntityStatusSnapshot>(1, makeStatuses(3));
+  const traffic_simulator::OtherEntityStatusView other_status(snapshot, "npc1");
+  EXPECT_EQ(other_status.frame(), static_cast<std::uint64_t>(1));
+  EXPECT_EQ(other_status.size(), static_cast<std::size_t>(2));
+  EXPECT_TRUE(other_status.find("npc1") == other_status.end());
+  EXPECT_DOUBLE_EQ(other_status.at("npc2").getMapPose().position.x, 2.0);
+  EXPECT_THROW(other_status.at("npc1"), std::out_of_range);
+  std::vector<std::string> names;
+  for (const auto & [name, status] : other_status) {
+    names.push_back(name);
+  }
+  EXPECT_EQ(names, (std::vector<std::string>{"npc0", "npc2"}));
+  EXPECT_TRUE(traffic_simulator::OtherEntityStatusView().empty());
+}
+
+TEST(OtherEntityStatusView, SameAsCopies)
+{
+  const auto statuses = makeStatuses(200);
+  auto snapshot_statuses = statuses;
+  const auto snapshot = std::make_shared<const traffic_simulator::EntityStatusSnapshot>(
+    1, std::move(snapshot_statuses));
+  for (const auto & [own_name, own_status] : statuses) {
+    const traffic_simulator::OtherEntityStatusView view(snapshot, own_name);
+    ASSERT_EQ(view.size(), statuses.size() - 1);
+    for (const auto & [name, status] : statuses) {
+      if (name != own_name) {
+        ASSERT_DOUBLE_EQ(view.at(name).getMapPose().position.x, status.getMapPose().position.x);
+      }
+    }
+  }
+}
+
+/// @brief Time of sharing one snapshot and of copying the other statuses into every entity.
+TEST(OtherEntityStatusView, DISABLED_Scaling)
+{
+  using Clock = std::chrono::steady_clock;
+  for (const std::size_t entity_count : {50, 200, 1000}) {
+    const auto statuses = makeStatuses(entity_count);
+
+    const auto copy_begin = Clock::now();
+    std::vector<std::unordered_map<std::string, traffic_simulator::CanonicalizedEntityStatus>>
+      copies(entity_count);
+    for (std::size_t i = 0; i < entity_count; ++i) {
+      for (const auto & [name, status] : statuses) {
+        if (name != statuses[i].first) {
+          copies[i].emplace(name, status);
+        }
+      }
+    }
+    const auto copy_end = Clock::now();
+
+    auto snapshot_statuses = statuses;
+    const auto snapshot_begin = Clock::now();
+    const auto snapshot = std::make_shared<const traffic_simulator::EntityStatusSnapshot>(
+      1, std::move(snapshot_statuses));
+    std::vector<traffic_simulator::OtherEntityStatusView> views(entity_count);
+    for (std::size_t i = 0; i < entity_count; ++i) {
+      views[i] = traffic_simulator::OtherEntityStatusView(snapshot, statuses[i].first);
+    }
+    const auto snapshot_end = Clock::now();
+
+    std::cout << entity_count << " entities: copy "
+              << std::chrono::duration<double, std::milli>(copy_end - copy_begin).count()
+              << " ms, snapshot "
+              << std::chrono::duration<double, std::milli>(snapshot_end - snapshot_begin).count()
+              << " ms" << std::endl;
+  }
+}
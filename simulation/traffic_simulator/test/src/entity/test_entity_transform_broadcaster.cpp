@@ -0,0 +1,106 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <rclcpp/rclcpp.hpp>
+#include <string>
+#include <traffic_simulator/entity/entity_transform_broadcaster.hpp>
+#include <utility>
+#include <vector>
+
+using traffic_simulator::EntityHandle;
+using traffic_simulator::entity::EntityTransformBroadcaster;
+
+constexpr double step_time = 0.05;
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  rclcpp::init(argc, argv);
+  const auto result = RUN_ALL_TESTS();
+  rclcpp::shutdown();
+  return result;
+}
+
+TEST(EntityTransformBroadcaster, RateLimit)
+{
+  const auto node = std::make_shared<rclcpp::Node>("RateLimit");
+  tf2_ros::StaticTransformBroadcaster static_broadcaster(node);
+  EntityTransformBroadcaster broadcaster(
+    static_broadcaster, EntityTransformBroadcaster::Policy{10.0});
+  int due_count = 0;
+  for (int frame = 0; frame < 20; ++frame) {
+    if (broadcaster.isDue(EntityHandle(3), false, frame * step_time)) {
+      ++due_count;
+    }
+  }
+  EXPECT_EQ(due_count, 10);
+}
+
+TEST(EntityTransformBroadcaster, EgoOnly)
+{
+  const auto node = std::make_shared<rclcpp::Node>("EgoOnly");
+  tf2_ros::StaticTransformBroadcaster static_broadcaster(node);
+  EntityTransformBroadcaster broadcaster(
+    static_broadcaster, EntityTransformBroadcaster::Policy{0.0, true});
+  EXPECT_TRUE(broadcaster.isDue(EntityHandle(0), true, 0.0));
+  EXPECT_TRUE(broadcaster.isDue(EntityHandle(0), true, step_time));
+  EXPECT_FALSE(broadcaster.isDue(EntityHandle(1), false, 0.0));
+}
+
+/// @brief Time per frame of selecting and sending the entity transforms for each policy.
+TEST(EntityTransformBroadcaster, DISABLED_FrameTime)
+{
+  const auto node = std::make_shared<rclcpp::Node>("FrameTime");
+  tf2_ros::StaticTransformBroadcaster static_broadcaster(node);
+  constexpr int frame_count = 20;
+  const std::vector<std::pair<std::string, EntityTransformBroadcaster::Policy>> policies = {
+    {"every frame", {0.0, false, false}},
+    {"10 Hz", {10.0, false, false}},
+    {"ego only", {0.0, true, false}},
+    {"batched", {0.0, false, true}},
+    {"batched 10 Hz", {10.0, false, true}},
+  };
+  for (const std::size_t entity_count : {10, 100, 500}) {
+    for (const auto & [name, policy] : policies) {
+      EntityTransformBroadcaster broadcaster(static_broadcaster, policy);
+      const auto begin = std::chrono::steady_clock::now();
+      for (int frame = 0; frame < frame_count; ++frame) {
+        std::vector<geometry_msgs::msg::TransformStamped> transforms;
+        for (std::size_t i = 0; i < entity_count; ++i) {
+          if (broadcaster.isDue(EntityHandle(i), i == 0, frame * step_time)) {
+            geometry_msgs::msg::TransformStamped transform;
+            transform.header.stamp = node->now();
+            transform.header.frame_id = "map";
+            transform.child_frame_id = "npc" + std::to_string(i);
+            transform.transform.translation.x = i + frame * step_time;
+            transform.transform.rotation.w = 1.0;
+            transforms.push_back(transform);
+          }
+        }
+        broadcaster.broadcast(std::move(transforms));
+      }
+      std::cout << entity_count << " entities, " << name << ": "
+                << std::chrono::duration<double, std::milli>(
+                     std::chrono::steady_clock::now() - begin)
+                       .count() /
+                     frame_count
+                << " ms per frame" << std::endl;
+    }
+  }
+}
@@ -0,0 +1,121 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <rclcpp/rclcpp.hpp>
+#include <sstream>
+#include <string>
+#include <traffic_simulator/entity/entity_manager.hpp>
+#include <traffic_simulator/helper/helper.hpp>
+#include <vector>
+
+#include "../catalogs.hpp"
+#include "../map_directory.hpp"
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  rclcpp::init(argc, argv);
+  const auto result = RUN_ALL_TESTS();
+  rclcpp::shutdown();
+  return result;
+}
+
+/**
+ * @brief EntityManager with vehicles, pedestrians and misc objects on one lanelet. The vehicles
+ * and pedestrians use the default behavior tree plugin, which pluginlib finds in the installed
+ * behavior_tree_plugin package.
+ */
+class NpcUpdateTest : public testing::Test
+{
+protected:
+  struct Result
+  {
+    std::vector<traffic_simulator_msgs::msg::EntityStatus> statuses;
+
+    /// @note Only the lines of the NPC updates, the other lines contain times.
+    std::vector<std::string> verbose_lines;
+  };
+
+  /// @note Updates the same entities for the same frames, with the given number of threads.
+  auto run(std::size_t thread_count) -> Result
+  {
+    auto configuration = traffic_simulator::Configuration(map_directory_.path());
+    configuration.npc_update_thread_count = thread_count;
+    configuration.verbose = true;
+    traffic_simulator::entity::EntityManager entity_manager(node_, configuration);
+    std::vector<std::string> names;
+    for (int i = 0; i < 32; ++i) {
+      names.push_back("npc" + std::to_string(i));
+      const auto pose = traffic_simulator::CanonicalizedLaneletPose(
+        traffic_simulator::helper::constructLaneletPose(34513, 1.0 + 0.7 * i),
+        entity_manager.getHdmapUtils());
+      switch (i % 3) {
+        case 0:
+          entity_manager.spawnEntity<traffic_simulator::entity::VehicleEntity>(
+            names.back(), pose, getVehicleParameters());
+          entity_manager.requestSpeedChange(names.back(), 10.0, true);
+          break;
+        case 1:
+          entity_manager.spawnEntity<traffic_simulator::entity::PedestrianEntity>(
+            names.back(), pose, getPedestrianParameters());
+          entity_manager.requestSpeedChange(names.back(), 1.0, true);
+          break;
+        default:
+          entity_manager.spawnEntity<traffic_simulator::entity::MiscObjectEntity>(
+            names.back(), pose, getMiscObjectParameters());
+          break;
+      }
+    }
+    entity_manager.startNpcLogic();
+    Result result;
+    testing::internal::CaptureStdout();
+    for (int frame = 0; frame < 10; ++frame) {
+      entity_manager.update(frame * 0.05, 0.05);
+      for (const auto & name : names) {
+        result.statuses.push_back(static_cast<traffic_simulator_msgs::msg::EntityStatus>(
+          entity_manager.getEntityStatus(name)));
+      }
+    }
+    std::istringstream output(testing::internal::GetCapturedStdout());
+    for (std::string line; std::getline(output, line);) {
+      if (line.rfind("update ", 0) == 0) {
+        result.verbose_lines.push_back(line);
+      }
+    }
+    return result;
+  }
+
+  const MapDirectory map_directory_{"test_npc_update"};
+
+  const std::shared_ptr<rclcpp::Node> node_ = std::make_shared<rclcpp::Node>("test_npc_update");
+};
+
+/**
+ * @note The statuses after every frame and the verbose output, in update order, must not depend
+ * on the number of threads updating the NPCs.
+ */
+TEST_F(NpcUpdateTest, SameAsSingleThread)
+{
+  const auto single_thread = run(1);
+  ASSERT_EQ(single_thread.verbose_lines.size(), 32u * 10u);
+  for (const std::size_t thread_count : {2, 4}) {
+    const auto multi_thread = run(thread_count);
+    EXPECT_EQ(multi_thread.statuses, single_thread.statuses) << thread_count << " threads";
+    EXPECT_EQ(multi_thread.verbose_lines, single_thread.verbose_lines)
+      << thread_count << " threads";
+  }
+}
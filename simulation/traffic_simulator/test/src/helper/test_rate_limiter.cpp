@@ -0,0 +1,54 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <traffic_simulator/helper/rate_limiter.hpp>
+
+TEST(RateLimiter, EveryTimeWithoutRate)
+{
+  traffic_simulator::helper::RateLimiter rate_limiter;
+  EXPECT_TRUE(rate_limiter.isDue(0.0));
+  EXPECT_TRUE(rate_limiter.isDue(0.0));
+  EXPECT_TRUE(rate_limiter.isDue(0.05));
+}
+
+TEST(RateLimiter, Rate)
+{
+  traffic_simulator::helper::RateLimiter rate_limiter(10.0);
+  int due_count = 0;
+  for (int frame = 0; frame < 20; ++frame) {
+    if (rate_limiter.isDue(frame * 0.05)) {
+      ++due_count;
+    }
+  }
+  EXPECT_EQ(due_count, 10);
+}
+
+/// @note A period equal to the step time is not missed because of a rounding error.
+TEST(RateLimiter, AccumulatedStepTime)
+{
+  traffic_simulator::helper::RateLimiter rate_limiter(30.0);
+  double time = 0.0;
+  for (int frame = 0; frame < 100; ++frame) {
+    EXPECT_TRUE(rate_limiter.isDue(time));
+    time += 1.0 / 30.0;
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,67 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <traffic_simulator/helper/worker_pool.hpp>
+#include <vector>
+
+TEST(WorkerPool, SameResultForAnyThreadCount)
+{
+  const auto compute = [](std::size_t thread_count, std::size_t size) {
+    traffic_simulator::helper::WorkerPool pool(thread_count);
+    std::vector<double> result(size);
+    for (int frame = 0; frame < 10; ++frame) {
+      pool.parallelFor(size, [&](std::size_t i) {
+        result[i] = std::sin(result[i] + static_cast<double>(i) * 0.1 + frame);
+      });
+    }
+    return result;
+  };
+  for (const std::size_t size : {0, 1, 7, 300}) {
+    const auto serial = compute(1, size);
+    for (const std::size_t thread_count : {0, 2, 3, 8}) {
+      EXPECT_EQ(serial, compute(thread_count, size));
+    }
+  }
+}
+
+TEST(WorkerPool, RethrowFirstException)
+{
+  for (const std::size_t thread_count : {1, 4}) {
+    traffic_simulator::helper::WorkerPool pool(thread_count);
+    try {
+      pool.parallelFor(100, [](std::size_t i) {
+        if (i == 30 or i == 90) {
+          throw std::runtime_error(std::to_string(i));
+        }
+      });
+      ADD_FAILURE() << "parallelFor did not throw";
+    } catch (const std::runtime_error & error) {
+      EXPECT_EQ(std::string(error.what()), "30");
+    }
+    std::size_t count = 0;
+    pool.parallelFor(1, [&](std::size_t) { count++; });
+    EXPECT_EQ(count, static_cast<std::size_t>(1));
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
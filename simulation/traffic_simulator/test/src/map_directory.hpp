@@ -0,0 +1,55 @@
+// Copyright 2015 TIER IV, Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TRAFFIC_SIMULATOR__TEST__MAP_DIRECTORY_HPP_
+#define TRAFFIC_SIMULATOR__TEST__MAP_DIRECTORY_HPP_
+
+#include <ament_index_cpp/get_package_share_directory.hpp>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <string>
+
+/**
+ * @brief Temporary map directory with the lanelet2 map of traffic_simulator, removed on
+ * destruction. Configuration requires a directory with a *.osm and a *.pcd file, the latter is
+ * not read, so it is empty.
+ */
+class MapDirectory
+{
+public:
+  explicit MapDirectory(const std::string & prefix)
+  : path_(
+      boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path(prefix + "_%%%%%%%%"))
+  {
+    boost::filesystem::create_directories(path_);
+    boost::filesystem::copy_file(
+      ament_index_cpp::get_package_share_directory("traffic_simulator") + "/map/lanelet2_map.osm",
+      path_ / "lanelet2_map.osm");
+    std::ofstream((path_ / "pointcloud_map.pcd").string());
+  }
+
+  ~MapDirectory() { boost::filesystem::remove_all(path_); }
+
+  MapDirectory(const MapDirectory &) = delete;
+
+  auto operator=(const MapDirectory &) -> MapDirectory & = delete;
+
+  auto path() const -> const boost::filesystem::path & { return path_; }
+
+private:
+  const boost::filesystem::path path_;
+};
+
+#endif  // TRAFFIC_SIMULATOR__TEST__MAP_DIRECTORY_HPP_
@@ -14,10 +14,22 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <ament_index_cpp/get_package_share_directory.hpp>
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <optional>
 #include <string>
+#include <thread>
 #include <traffic_simulator/hdmap_utils/hdmap_utils.hpp>
 #include <traffic_simulator/helper/helper.hpp>
+#include <traffic_simulator/helper/worker_pool.hpp>
+#include <utility>
+#include <vector>
 
 TEST(HdMapUtils, Construct)
 {
@@ -59,6 +71,123 @@ TEST(HdMapUtils, MatchToLane)
   }
 }
 
+/**
+ * @note Testcase for the centerline spatial index. The s value projected onto the indexed
+ * centerline is measured along the polyline, so it agrees with the s value of the lanelet pose it
+ * was generated from only within the difference between the polyline and the spline.
+ */
+TEST(HdMapUtils, NearbyLaneletMatches)
+{
+  std::string path =
+    ament_index_cpp::get_package_share_directory("traffic_simulator") + "/map/lanelet2_map.osm";
+  geographic_msgs::msg::GeoPoint origin;
+  origin.latitude = 35.61836750154;
+  origin.longitude = 139.78066608243;
+  hdmap_utils::HdMapUtils hdmap_utils(path, origin);
+  for (const double s : {1.0, 5.0, 10.0, 20.0}) {
+    const auto point =
+      hdmap_utils.toMapPose(traffic_simulator::helper::constructLaneletPose(34513, s, 0))
+        .pose.position;
+    const auto matches = hdmap_utils.getNearbyLaneletMatches(point, 1.0, false);
+    const auto match = std::find_if(matches.begin(), matches.end(), [](const auto & candidate) {
+      return candidate.lanelet_id == 34513;
+    });
+    ASSERT_NE(match, matches.end());
+    EXPECT_TRUE(match->inside);
+    EXPECT_NEAR(match->s, s, 0.2);
+    EXPECT_NEAR(match->offset, 0.0, 0.1);
+  }
+}
+
+/**
+ * @note Testcase for the meaning of LaneletMatch::s, the 2D arc length along the centerline
+ * polyline, checked exactly on every point of the centerline.
+ */
+TEST(HdMapUtils, NearbyLaneletMatchesPolylineArcLength)
+{
+  std::string path =
+    ament_index_cpp::get_package_share_directory("traffic_simulator") + "/map/lanelet2_map.osm";
+  geographic_msgs::msg::GeoPoint origin;
+  origin.latitude = 35.61836750154;
+  origin.longitude = 139.78066608243;
+  hdmap_utils::HdMapUtils hdmap_utils(path, origin);
+  const auto centerline = hdmap_utils.getLaneletMap()->laneletLayer.get(34513).centerline2d();
+  ASSERT_GE(centerline.size(), 2u);
+  double s = 0;
+  for (std::size_t i = 0; i < centerline.size(); ++i) {
+    if (i != 0) {
+      s += std::hypot(
+        centerline[i].x() - centerline[i - 1].x(), centerline[i].y() - centerline[i - 1].y());
+    }
+    geometry_msgs::msg::Point point;
+    point.x = centerline[i].x();
+    point.y = centerline[i].y();
+    const auto matches = hdmap_utils.getNearbyLaneletMatches(point, 1.0, false);
+    const auto match = std::find_if(matches.begin(), matches.end(), [](const auto & candidate) {
+      return candidate.lanelet_id == 34513;
+    });
+    ASSERT_NE(match, matches.end());
+    EXPECT_NEAR(match->s, s, 1e-6);
+    EXPECT_NEAR(match->offset, 0.0, 1e-6);
+  }
+  /// @note The spline through the same points is slightly longer than the polyline.
+  EXPECT_NEAR(s, hdmap_utils.getLaneletLength(34513), 0.2);
+}
+
+/// @brief Time per match of matchToLane and of toLaneletPose on every nearby lanelet spline.
+TEST(HdMapUtils, DISABLED_MatchToLaneTime)
+{
+  std::string path =
+    ament_index_cpp::get_package_share_directory("traffic_simulator") + "/map/lanelet2_map.osm";
+  geographic_msgs::msg::GeoPoint origin;
+  origin.latitude = 35.61836750154;
+  origin.longitude = 139.78066608243;
+  hdmap_utils::HdMapUtils hdmap_utils(path, origin);
+  traffic_simulator_msgs::msg::BoundingBox bbox;
+  bbox.dimensions.x = 4.0;
+  bbox.dimensions.y = 2.0;
+  std::vector<geometry_msgs::msg::Pose> poses;
+  for (const auto & lanelet_id : hdmap_utils.getLaneletIds()) {
+    poses.push_back(
+      hdmap_utils
+        .toMapPose(traffic_simulator::helper::constructLaneletPose(
+          lanelet_id, hdmap_utils.getLaneletLength(lanelet_id) * 0.5, 0))
+        .pose);
+  }
+  auto match_on_splines = [&](const auto & pose) {
+    std::optional<lanelet::Id> id;
+    auto offset = std::numeric_limits<double>::max();
+    for (const auto & lanelet_id : hdmap_utils.getNearbyLaneletIds(pose.position, 1.0, false)) {
+      if (const auto lanelet_pose = hdmap_utils.toLaneletPose(pose, lanelet_id);
+          lanelet_pose and std::fabs(lanelet_pose->offset) < offset) {
+        id = lanelet_id;
+        offset = std::fabs(lanelet_pose->offset);
+      }
+    }
+    return id;
+  };
+  auto measure = [&](auto && match) {
+    std::size_t matched = 0;
+    const auto begin = std::chrono::steady_clock::now();
+    for (const auto & pose : poses) {
+      matched += match(pose) ? 1 : 0;
+    }
+    return std::make_pair(
+      std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin)
+          .count() /
+        poses.size(),
+      matched);
+  };
+  /// @note The first pass fills the spline cache for both.
+  measure(match_on_splines);
+  const auto [spline_time, spline_matched] = measure(match_on_splines);
+  const auto [index_time, index_matched] =
+    measure([&](const auto & pose) { return hdmap_utils.matchToLane(pose, bbox, false); });
+  std::cout << poses.size() << " poses: " << spline_time << " us per match on the splines ("
+            << spline_matched << " matched), " << index_time
+            << " us per match with the index (" << index_matched << " matched)" << std::endl;
+}
+
 TEST(HdMapUtils, AlongLaneletPose)
 {
   std::string path =
@@ -313,6 +442,411 @@ TEST(HdMapUtils, CanonicalizeAll)
   EXPECT_EQ(canonicalized_lanelet_poses[0].s, non_canonicalized_lanelet_s);
 }
 
+TEST(HdMapUtils, LaneletLengthCache)
+{
+  hdmap_utils::LaneletLengthCache cache(16);
+  EXPECT_FALSE(cache.getLength(1));
+  cache.appendData(1, 10.0);
+  EXPECT_DOUBLE_EQ(cache.getLength(1).value(), 10.0);
+  EXPECT_EQ(cache.hits(), static_cast<std::uint64_t>(1));
+  EXPECT_EQ(cache.misses(), static_cast<std::uint64_t>(1));
+}
+
+TEST(HdMapUtils, LruCacheEviction)
+{
+  hdmap_utils::LruCache<lanelet::Id, double> cache(8);
+  for (lanelet::Id id = 0; id < 8; ++id) {
+    cache.insert(id, static_cast<double>(id));
+  }
+  /// @note Touch every entry except 3, it becomes the least recently used one.
+  for (lanelet::Id id = 0; id < 8; ++id) {
+    if (id != 3) {
+      EXPECT_TRUE(cache.find(id));
+    }
+  }
+  cache.insert(8, 8.0);
+  EXPECT_LE(cache.size(), cache.capacity());
+  EXPECT_FALSE(cache.find(3));
+  EXPECT_TRUE(cache.find(8));
+  EXPECT_TRUE(cache.find(7));
+}
+
+TEST(HdMapUtils, MapCache)
+{
+  std::string path =
+    ament_index_cpp::get_package_share_directory("traffic_simulator") + "/map/lanelet2_map.osm";
+  geographic_msgs::msg::GeoPoint origin;
+  origin.latitude = 35.61836750154;
+  origin.longitude = 139.78066608243;
+  const auto cache_directory =
+    boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  EXPECT_FALSE(
+    boost::filesystem::exists(hdmap_utils::MapCache(path, origin, cache_directory).path()));
+  const auto cold = std::make_unique<hdmap_utils::HdMapUtils>(path, origin, cache_directory);
+  EXPECT_TRUE(
+    boost::filesystem::exists(hdmap_utils::MapCache(path, origin, cache_directory).path()));
+  const auto warm = std::make_unique<hdmap_utils::HdMapUtils>(path, origin, cache_directory);
+  for (const auto lanelet_id : cold->getLaneletIds()) {
+    EXPECT_DOUBLE_EQ(cold->getLaneletLength(lanelet_id), warm->getLaneletLength(lanelet_id));
+    EXPECT_EQ(cold->getNextLaneletIds(lanelet_id), warm->getNextLaneletIds(lanelet_id));
+    EXPECT_EQ(cold->getPreviousLaneletIds(lanelet_id), warm->getPreviousLaneletIds(lanelet_id));
+    EXPECT_EQ(cold->getCenterPoints(lanelet_id).size(), warm->getCenterPoints(lanelet_id).size());
+  }
+  /// @note Only the cache saved last is kept for a map file.
+  auto other_origin = origin;
+  other_origin.altitude = 1.0;
+  const hdmap_utils::HdMapUtils other(path, other_origin, cache_directory);
+  EXPECT_FALSE(
+    boost::filesystem::exists(hdmap_utils::MapCache(path, origin, cache_directory).path()));
+  EXPECT_TRUE(
+    boost::filesystem::exists(hdmap_utils::MapCache(path, other_origin, cache_directory).path()));
+  /// @note The cache of a map file with the same name at another path does not replace it.
+  const auto other_map_directory =
+    boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  boost::filesystem::create_directories(other_map_directory);
+  const auto other_path = (other_map_directory / "lanelet2_map.osm").string();
+  boost::filesystem::copy_file(path, other_path);
+  const hdmap_utils::HdMapUtils other_map(other_path, other_origin, cache_directory);
+  EXPECT_TRUE(boost::filesystem::exists(
+    hdmap_utils::MapCache(other_path, other_origin, cache_directory).path()));
+  EXPECT_TRUE(
+    boost::filesystem::exists(hdmap_utils::MapCache(path, other_origin, cache_directory).path()));
+  boost::filesystem::remove_all(other_map_directory);
+  boost::filesystem::remove_all(cache_directory);
+}
+
+/// @brief Time to construct HdMapUtils without the cache, then cold and warm from the cache.
+TEST(HdMapUtils, DISABLED_MapCacheTime)
+{
+  std::string path =
+    ament_index_cpp::get_package_share_directory("traffic_simulator") + "/map/lanelet2_map.osm";
+  geographic_msgs::msg::GeoPoint origin;
+  origin.latitude = 35.61836750154;
+  origin.longitude = 139.78066608243;
+  const auto cache_directory =
+    boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  const auto measure = [&](const boost::filesystem::path & directory) {
+    const auto begin = std::chrono::steady_clock::now();
+    hdmap_utils::HdMapUtils hdmap_utils(path, origin, directory);
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin)
+      .count();
+  };
+  const auto uncached = measure("");
+  const auto cold = measure(cache_directory);
+  const auto warm = measure(cache_directory);
+  std::cout << uncached << " ms without the cache, " << cold << " ms cold, " << warm
+            << " ms warm" << std::endl;
+  boost::filesystem::remove_all(cache_directory);
+}
+
+TEST(HdMapUtils, LaneletDistanceTable)
+{
+  std::string path =
+    ament_index_cpp::get_package_share_directory("traffic_simulator") + "/map/lanelet2_map.osm";
+  geographic_msgs::msg::GeoPoint origin;
+  origin.latitude = 35.61836750154;
+  origin.longitude = 139.78066608243;
+  hdmap_utils::HdMapUtils routed(path, origin);
+  hdmap_utils::HdMapUtils tabled(path, origin);
+  const auto & table = tabled.buildLaneletDistanceTable(4, 1 << 20);
+  EXPECT_FALSE(table.empty());
+  EXPECT_GT(table.memoryUsage(), table.size() * sizeof(double));
+  for (const auto from : routed.getLaneletIds()) {
+    /// @note Lanelets up to three transitions ahead, and one which is usually unreachable.
+    lanelet::Ids to_ids = {routed.getLaneletIds().front()};
+    auto next_ids = routed.getNextLaneletIds(from);
+    for (int depth = 0; depth < 3; ++depth) {
+      to_ids.insert(to_ids.end(), next_ids.begin(), next_ids.end());
+      next_ids = routed.getNextLaneletIds(next_ids);
+    }
+    for (const auto to : to_ids) {
+      const auto from_pose = traffic_simulator::helper::constructLaneletPose(from, 0.5, 0);
+      const auto to_pose = traffic_simulator::helper::constructLaneletPose(to, 0.5, 0);
+      const auto expected = routed.getLongitudinalDistance(from_pose, to_pose);
+      const auto actual = tabled.getLongitudinalDistance(from_pose, to_pose);
+      ASSERT_EQ(expected.has_value(), actual.has_value());
+      if (expected) {
+        EXPECT_NEAR(expected.value(), actual.value(), 1e-3);
+      }
+    }
+  }
+}
+
+TEST(HdMapUtils, LaneChangeTrajectory)
+{
+  std::string path =
+    ament_index_cpp::get_package_share_directory("traffic_simulator") + "/map/lanelet2_map.osm";
+  geographic_msgs::msg::GeoPoint origin;
+  origin.latitude = 35.61836750154;
+  origin.longitude = 139.78066608243;
+  hdmap_utils::HdMapUtils hdmap_utils(path, origin);
+  std::size_t count = 0;
+  for (const auto from : hdmap_utils.getLaneletIds()) {
+    for (const auto direction :
+         {traffic_simulator::lane_change::Direction::LEFT,
+          traffic_simulator::lane_change::Direction::RIGHT}) {
+      const auto to = hdmap_utils.getLaneChangeableLaneletId(from, direction);
+      if (not to or count >= 20) {
+        continue;
+      }
+      ++count;
+      const traffic_simulator::lane_change::Parameter parameter(
+        traffic_simulator::lane_change::AbsoluteTarget(to.value()));
+      const auto from_pose =
+        hdmap_utils.toMapPose(traffic_simulator::helper::constructLaneletPose(from, 1.0)).pose;
+      const auto searched =
+        hdmap_utils.getLaneChangeTrajectory(from_pose, parameter, 10.0, 20.0, 1.0);
+      const auto sampled =
+        hdmap_utils.sampleLaneChangeTrajectory(from_pose, parameter, 10.0, 20.0, 1.0);
+      ASSERT_EQ(searched.has_value(), sampled.has_value());
+      if (searched) {
+        EXPECT_NEAR(
+          std::fabs(searched->first.getLength() - 20.0),
+          std::fabs(sampled->first.getLength() - 20.0), 1.0);
+      }
+      /// @note Both poses share a cache entry, but each curve starts at its own exact pose.
+      for (const auto s : {1.0, 1.03}) {
+        const auto lanelet_pose = traffic_simulator::helper::constructLaneletPose(from, s);
+        const auto cached =
+          hdmap_utils.getLaneChangeTrajectory(lanelet_pose, parameter, 10.0, 20.0, 1.0);
+        ASSERT_EQ(searched.has_value(), cached.has_value());
+        if (cached) {
+          const auto start = hdmap_utils.toMapPose(lanelet_pose).pose.position;
+          EXPECT_NEAR(cached->first.getPoint(0).x, start.x, 1e-3);
+          EXPECT_NEAR(cached->first.getPoint(0).y, start.y, 1e-3);
+          EXPECT_NEAR(cached->first.getPoint(0).z, start.z, 1e-3);
+          EXPECT_LT(cached->first.getMaximum2DCurvature(), 10.0);
+        }
+      }
+    }
+  }
+  EXPECT_GT(count, static_cast<std::size_t>(0));
+}
+
+/// @brief Time of the bisection search, of the sampling it replaces and of the cached lookup.
+TEST(HdMapUtils, DISABLED_LaneChangeTrajectoryTime)
+{
+  std::string path =
+    ament_index_cpp::get_package_share_directory("traffic_simulator") + "/map/lanelet2_map.osm";
+  geographic_msgs::msg::GeoPoint origin;
+  origin.latitude = 35.61836750154;
+  origin.longitude = 139.78066608243;
+  hdmap_utils::HdMapUtils hdmap_utils(path, origin);
+  std::chrono::duration<double> search_duration(0), sample_duration(0), cached_duration(0);
+  std::size_t count = 0;
+  for (const auto from : hdmap_utils.getLaneletIds()) {
+    for (const auto direction :
+         {traffic_simulator::lane_change::Direction::LEFT,
+          traffic_simulator::lane_change::Direction::RIGHT}) {
+      const auto to = hdmap_utils.getLaneChangeableLaneletId(from, direction);
+      if (not to) {
+        continue;
+      }
+      ++count;
+      const traffic_simulator::lane_change::Parameter parameter(
+        traffic_simulator::lane_change::AbsoluteTarget(to.value()));
+      const auto lanelet_pose = traffic_simulator::helper::constructLaneletPose(from, 1.0);
+      const auto from_pose = hdmap_utils.toMapPose(lanelet_pose).pose;
+      const auto search_begin = std::chrono::steady_clock::now();
+      hdmap_utils.getLaneChangeTrajectory(from_pose, parameter, 10.0, 20.0, 1.0);
+      const auto sample_begin = std::chrono::steady_clock::now();
+      hdmap_utils.sampleLaneChangeTrajectory(from_pose, parameter, 10.0, 20.0, 1.0);
+      search_duration += sample_begin - search_begin;
+      sample_duration += std::chrono::steady_clock::now() - sample_begin;
+      /// @note The first call fills the cache.
+      hdmap_utils.getLaneChangeTrajectory(lanelet_pose, parameter, 10.0, 20.0, 1.0);
+      const auto cached_begin = std::chrono::steady_clock::now();
+      hdmap_utils.getLaneChangeTrajectory(lanelet_pose, parameter, 10.0, 20.0, 1.0);
+      cached_duration += std::chrono::steady_clock::now() - cached_begin;
+    }
+  }
+  std::cout << count << " lane changes: bisection " << search_duration.count()
+            << " [s], sampling " << sample_duration.count() << " [s], cached "
+            << cached_duration.count() << " [s]" << std::endl;
+}
+
+TEST(HdMapUtils, ConflictingLaneIds)
+{
+  std::string path =
+    ament_index_cpp::get_package_share_directory("traffic_simulator") + "/map/lanelet2_map.osm";
+  geographic_msgs::msg::GeoPoint origin;
+  origin.latitude = 35.61836750154;
+  origin.longitude = 139.78066608243;
+  hdmap_utils::HdMapUtils hdmap_utils(path, origin);
+  /// @note Routing graphs built here, for the conflicts as computed before the tables existed.
+  const auto lanelet_map = hdmap_utils.getLaneletMap();
+  const auto vehicle_traffic_rules = lanelet::traffic_rules::TrafficRulesFactory::create(
+    lanelet::Locations::Germany, lanelet::Participants::Vehicle);
+  const auto pedestrian_traffic_rules = lanelet::traffic_rules::TrafficRulesFactory::create(
+    lanelet::Locations::Germany, lanelet::Participants::Pedestrian);
+  const lanelet::routing::RoutingGraphConstPtr vehicle_routing_graph =
+    lanelet::routing::RoutingGraph::build(*lanelet_map, *vehicle_traffic_rules);
+  const lanelet::routing::RoutingGraphConstPtr pedestrian_routing_graph =
+    lanelet::routing::RoutingGraph::build(*lanelet_map, *pedestrian_traffic_rules);
+  const lanelet::routing::RoutingGraphContainer container(
+    std::vector<lanelet::routing::RoutingGraphConstPtr>{
+      vehicle_routing_graph, pedestrian_routing_graph});
+  auto ids = [](const auto & lanelets) {
+    lanelet::Ids ids;
+    for (const auto & lanelet : lanelets) {
+      ids.push_back(lanelet.id());
+    }
+    return ids;
+  };
+  std::size_t conflicting_lane_count = 0;
+  std::size_t conflicting_crosswalk_count = 0;
+  for (const auto lanelet_id : hdmap_utils.getLaneletIds()) {
+    const auto lane_ids = hdmap_utils.getConflictingLaneIds(lanelet_id);
+    const auto crosswalk_ids = hdmap_utils.getConflictingCrosswalkIds(lanelet_id);
+    const auto lanelet = lanelet_map->laneletLayer.get(lanelet_id);
+    EXPECT_EQ(
+      lanelet::Ids(lane_ids.begin(), lane_ids.end()),
+      ids(lanelet::utils::getConflictingLanelets(vehicle_routing_graph, lanelet)));
+    EXPECT_EQ(
+      lanelet::Ids(crosswalk_ids.begin(), crosswalk_ids.end()),
+      ids(container.conflictingInGraph(lanelet, 1, 4)));
+    EXPECT_EQ(
+      lanelet::Ids(lane_ids.begin(), lane_ids.end()),
+      hdmap_utils.getConflictingLaneIds(lanelet::Ids{lanelet_id}));
+    EXPECT_EQ(
+      lanelet::Ids(crosswalk_ids.begin(), crosswalk_ids.end()),
+      hdmap_utils.getConflictingCrosswalkIds(lanelet::Ids{lanelet_id}));
+    conflicting_lane_count += lane_ids.size();
+    conflicting_crosswalk_count += crosswalk_ids.size();
+  }
+  EXPECT_GT(conflicting_lane_count, static_cast<std::size_t>(0));
+  EXPECT_GT(conflicting_crosswalk_count, static_cast<std::size_t>(0));
+  EXPECT_THROW(hdmap_utils.getConflictingLaneIds(lanelet::Id(-1)), common::SemanticError);
+}
+
+TEST(HdMapUtils, StopLineIndex)
+{
+  std::string path =
+    ament_index_cpp::get_package_share_directory("traffic_simulator") + "/map/lanelet2_map.osm";
+  geographic_msgs::msg::GeoPoint origin;
+  origin.latitude = 35.61836750154;
+  origin.longitude = 139.78066608243;
+  hdmap_utils::HdMapUtils hdmap_utils(path, origin);
+  /// @note A stop line crossing the end of the spline may be found by only one of the methods.
+  const auto expect_near = [](
+                             const auto & expected, const auto & actual, double length,
+                             std::size_t & found_count) {
+    if (expected and actual) {
+      EXPECT_NEAR(expected.value(), actual.value(), 1.0);
+      found_count++;
+    } else if (expected) {
+      EXPECT_NEAR(expected.value(), length, 1.0);
+    } else if (actual) {
+      EXPECT_NEAR(actual.value(), length, 1.0);
+    }
+  };
+  std::size_t stop_line_count = 0;
+  std::size_t traffic_light_stop_line_count = 0;
+  for (const auto lanelet_id : hdmap_utils.getLaneletIds()) {
+    const auto route = hdmap_utils.getFollowingLanelets(lanelet_id, 150);
+    const auto spline = math::geometry::CatmullRomSpline(hdmap_utils.getCenterPoints(route));
+    const auto from = traffic_simulator::helper::constructLaneletPose(lanelet_id, 0);
+    expect_near(
+      hdmap_utils.getDistanceToStopLine(route, spline),
+      hdmap_utils.getDistanceToStopLine(route, from, spline.getLength()), spline.getLength(),
+      stop_line_count);
+    expect_near(
+      hdmap_utils.getDistanceToTrafficLightStopLine(route, spline),
+      hdmap_utils.getDistanceToTrafficLightStopLine(route, from, spline.getLength()),
+      spline.getLength(), traffic_light_stop_line_count);
+  }
+  EXPECT_GT(stop_line_count, static_cast<std::size_t>(0));
+  EXPECT_GT(traffic_light_stop_line_count, static_cast<std::size_t>(0));
+  /// @note The index is searched from the lanelet of the pose, which must be on the route.
+  const auto route = hdmap_utils.getFollowingLanelets(34513, 150);
+  const auto lanelet_ids = hdmap_utils.getLaneletIds();
+  const auto off_route =
+    std::find_if(lanelet_ids.begin(), lanelet_ids.end(), [&](const auto id) {
+      return std::find(route.begin(), route.end(), id) == route.end();
+    });
+  ASSERT_NE(off_route, lanelet_ids.end());
+  const auto from = traffic_simulator::helper::constructLaneletPose(*off_route, 0);
+  EXPECT_THROW(hdmap_utils.getDistanceToStopLine(route, from, 100.0), common::SemanticError);
+  EXPECT_THROW(
+    hdmap_utils.getDistanceToTrafficLightStopLine(route, from, 100.0), common::SemanticError);
+}
+
+TEST(HdMapUtils, Shared)
+{
+  std::string path =
+    ament_index_cpp::get_package_share_directory("traffic_simulator") + "/map/lanelet2_map.osm";
+  geographic_msgs::msg::GeoPoint origin;
+  origin.latitude = 35.61836750154;
+  origin.longitude = 139.78066608243;
+  const auto hdmap_utils = hdmap_utils::HdMapUtils::shared(path, origin);
+  EXPECT_EQ(hdmap_utils, hdmap_utils::HdMapUtils::shared(path, origin));
+  EXPECT_TRUE(boost::filesystem::exists(hdmap_utils::MapCache(
+                                          path, origin,
+                                          hdmap_utils::MapCache::sharedMemoryDirectory())
+                                          .path()));
+  origin.altitude = 1.0;
+  EXPECT_NE(hdmap_utils, hdmap_utils::HdMapUtils::shared(path, origin));
+
+  /// @note Callers on two threads at once, as the traffic simulator and the sensor simulator in
+  /// one process, get one instance and one lanelet distance table.
+  origin.altitude = 2.0;
+  std::shared_ptr<hdmap_utils::HdMapUtils> other;
+  const hdmap_utils::LaneletDistanceTable * other_table = nullptr;
+  std::thread thread([&]() {
+    other = hdmap_utils::HdMapUtils::shared(path, origin);
+    other_table = &other->buildLaneletDistanceTable(4, 1 << 20);
+  });
+  const auto shared = hdmap_utils::HdMapUtils::shared(path, origin);
+  const auto table = &shared->buildLaneletDistanceTable(2, 1 << 10);
+  thread.join();
+  EXPECT_EQ(shared, other);
+  EXPECT_EQ(table, other_table);
+}
+
+/**
+ * @note NPCs updated in parallel share one HdMapUtils, whose caches are filled concurrently.
+ * The answers must be bit-identical to the ones of a serial update.
+ */
+TEST(HdMapUtils, ParallelQueries)
+{
+  std::string path =
+    ament_index_cpp::get_package_share_directory("traffic_simulator") + "/map/lanelet2_map.osm";
+  geographic_msgs::msg::GeoPoint origin;
+  origin.latitude = 35.61836750154;
+  origin.longitude = 139.78066608243;
+  struct Result
+  {
+    lanelet::Ids following_lanelets;
+    geometry_msgs::msg::Point position;
+    std::optional<double> longitudinal_distance;
+  };
+  const auto query = [&](std::size_t thread_count) {
+    hdmap_utils::HdMapUtils hdmap_utils(path, origin);
+    const auto lanelet_ids = hdmap_utils.getLaneletIds();
+    std::vector<Result> results(lanelet_ids.size());
+    traffic_simulator::helper::WorkerPool pool(thread_count);
+    pool.parallelFor(lanelet_ids.size(), [&](std::size_t i) {
+      const auto from = traffic_simulator::helper::constructLaneletPose(lanelet_ids[i], 1.0);
+      results[i].following_lanelets = hdmap_utils.getFollowingLanelets(lanelet_ids[i], 200);
+      results[i].position = hdmap_utils.toMapPose(from).pose.position;
+      results[i].longitudinal_distance = hdmap_utils.getLongitudinalDistance(
+        from, traffic_simulator::helper::constructLaneletPose(
+                results[i].following_lanelets.back(), 0.0));
+    });
+    return results;
+  };
+  const auto serial = query(1);
+  const auto parallel = query(4);
+  ASSERT_EQ(serial.size(), parallel.size());
+  for (std::size_t i = 0; i < serial.size(); ++i) {
+    EXPECT_EQ(serial[i].following_lanelets, parallel[i].following_lanelets);
+    EXPECT_EQ(serial[i].position.x, parallel[i].position.x);
+    EXPECT_EQ(serial[i].position.y, parallel[i].position.y);
+    EXPECT_EQ(serial[i].position.z, parallel[i].position.z);
+    EXPECT_EQ(serial[i].longitudinal_distance, parallel[i].longitudinal_distance);
+  }
+}
+
 int main(int argc, char ** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -90,6 +90,47 @@ TEST(TrafficLightManager, setArrow)
   }
 }
 
+TEST(TrafficLightManager, sendOnlyChanged)
+{
+  const auto node = std::make_shared<rclcpp::Node>("sendOnlyChanged");
+  std::string path =
+    ament_index_cpp::get_package_share_directory("traffic_simulator") + "/map/lanelet2_map.osm";
+  geographic_msgs::msg::GeoPoint origin;
+  origin.latitude = 35.61836750154;
+  origin.longitude = 139.78066608243;
+  const auto hdmap_utils_ptr = std::make_shared<hdmap_utils::HdMapUtils>(path, origin);
+  traffic_simulator::TrafficLightManager manager(hdmap_utils_ptr);
+  traffic_simulator::TrafficLightManager::ChangeTracker sent;
+  manager.getTrafficLight(34836).set("green solidOn circle");
+  manager.getTrafficLight(34802).set("red solidOn circle");
+
+  EXPECT_TRUE(manager.hasAnyLightChanged(sent));
+  EXPECT_EQ(manager.generateUpdateTrafficLightsRequest(sent, true).states_size(), 2);
+
+  /// @note Unchanged frames, the second one setting the same state again.
+  EXPECT_FALSE(manager.hasAnyLightChanged(sent));
+  EXPECT_EQ(manager.generateUpdateTrafficLightsRequest(sent, true).states_size(), 0);
+  manager.getTrafficLight(34836).clear();
+  manager.getTrafficLight(34836).set("green solidOn circle");
+  manager.getTrafficLight(34802).setConfidence(1.0);
+  EXPECT_FALSE(manager.hasAnyLightChanged(sent));
+
+  manager.getTrafficLight(34836).clear();
+  manager.getTrafficLight(34836).set("yellow solidOn circle");
+  EXPECT_TRUE(manager.hasAnyLightChanged(sent));
+  const auto request = manager.generateUpdateTrafficLightsRequest(sent, true);
+  ASSERT_EQ(request.states_size(), 1);
+  EXPECT_EQ(request.states(0).id(), 34836);
+  EXPECT_TRUE(request.only_changed());
+  EXPECT_FALSE(manager.hasAnyLightChanged(sent));
+
+  manager.getTrafficLight(34802).setConfidence(0.5);
+  EXPECT_TRUE(manager.hasAnyLightChanged(sent));
+  /// @note Sends all of them when any changed, if not only_changed.
+  EXPECT_EQ(manager.generateUpdateTrafficLightsRequest(sent, false).states_size(), 2);
+  EXPECT_FALSE(manager.hasAnyLightChanged(sent));
+}
+
 int main(int argc, char ** argv)
 {
   testing::InitGoogleTest(&argc, argv);
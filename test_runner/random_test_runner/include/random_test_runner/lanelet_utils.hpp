@@ -23,6 +23,7 @@
 #include <boost/filesystem.hpp>
 #include <optional>
 
+#include "geographic_msgs/msg/geo_point.hpp"
 #include "geometry_msgs/msg/pose_stamped.hpp"
 #include "random_test_runner/data_types.hpp"
 
@@ -41,7 +42,9 @@ struct LaneletPart
 class LaneletUtils
 {
 public:
-  LaneletUtils(const boost::filesystem::path & filename);
+  /// @note origin must be the one the traffic simulator uses, so that both share the map.
+  LaneletUtils(
+    const boost::filesystem::path & filename, const geographic_msgs::msg::GeoPoint & origin);
 
   LaneletUtils() = delete;
   LaneletUtils(const LaneletUtils &) = delete;
@@ -65,9 +68,9 @@ public:
   bool isInLanelet(int64_t lanelet_id, double s);
 
 private:
-  lanelet::LaneletMapPtr lanelet_map_ptr_;
-  lanelet::routing::RoutingGraphConstPtr vehicle_routing_graph_ptr_;
   std::shared_ptr<hdmap_utils::HdMapUtils> hdmap_utils_ptr_;
+  lanelet::LaneletMapConstPtr lanelet_map_ptr_;
+  lanelet::routing::RoutingGraphConstPtr vehicle_routing_graph_ptr_;
 };
 
 #endif  // RANDOM_TEST_RUNNER__LANELET_UTILS_HPP
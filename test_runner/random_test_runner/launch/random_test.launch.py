@@ -243,7 +243,7 @@ class RandomTestRunnerLaunch(object):
                     namespace="simulation",
                     output="log",
                     arguments=[("__log_level:=warn")],
-                    parameters=[{"port": 5555}],
+                    parameters=[{"port": 5555, "share_map": True}],
                 ),
             )
 
@@ -26,6 +26,7 @@
 #include <rclcpp/logger.hpp>
 #include <string>
 #include <traffic_simulator/api/configuration.hpp>
+#include <traffic_simulator/entity/entity_manager.hpp>
 #include <traffic_simulator_msgs/msg/behavior_parameter.hpp>
 #include <vector>
 
@@ -65,7 +66,9 @@ RandomTestRunner::RandomTestRunner(const rclcpp::NodeOptions & option)
 
   traffic_simulator::Configuration configuration(map_path);
   configuration.simulator_host = test_control_parameters.simulator_host;
-  auto lanelet_utils = std::make_shared<LaneletUtils>(configuration.lanelet2_map_path());
+  configuration.share_map = true;
+  auto lanelet_utils = std::make_shared<LaneletUtils>(
+    configuration.lanelet2_map_path(), traffic_simulator::entity::EntityManager::getOrigin(*this));
 
   TestSuiteParameters validated_params = validateParameters(test_suite_params, lanelet_utils);
 